@@ -6,6 +6,8 @@ from esphome.components import uart, mqtt
 from esphome.const import (
     CONF_ID,
 )
+from esphome.core import EsphomeError
+import importlib.util
 import json
 import os
 import re
@@ -33,6 +35,10 @@ CONF_DEVICE_ID = "device_id"
 CONF_MODE = "mode"
 CONF_POLLING_INTERVAL = "polling_interval"
 CONF_POLLING_ONLY_PUBLISH_ON_CHANGE = "polling_onlypublish_onchange"
+CONF_POLLING_CHANGE_DETECTION = "polling_change_detection"
+CONF_FAST_BOOT = "fast_boot"
+CONF_BUS_TASK = "bus_task"
+CONF_APPLIANCE_TYPES = "appliance_types"
 
 # Bridge mode options (polling vs subscriptions)
 MODE_POLL = "poll"
@@ -54,6 +60,14 @@ GEA_MODE_AUTO_VALUE = 0
 GEA_MODE_GEA3_VALUE = 1
 GEA_MODE_GEA2_VALUE = 2
 
+# Change detection options for polling with only-publish-on-change
+CHANGE_DETECTION_FULL = "full"
+CHANGE_DETECTION_DIGEST = "digest"
+
+# Change detection enum values (must match erd_value_cache_mode_t in C++)
+CHANGE_DETECTION_FULL_VALUE = 0
+CHANGE_DETECTION_DIGEST_VALUE = 1
+
 geappliances_bridge_ns = cg.esphome_ns.namespace("geappliances_bridge")
 GeappliancesBridge = geappliances_bridge_ns.class_(
     "GeappliancesBridge", cg.Component
@@ -91,10 +105,10 @@ def sanitize_appliance_name(name):
     return result
 
 
-def load_appliance_types():
-    """Load appliance type mappings from the API documentation library.
+def load_erd_definitions():
+    """Load the ERD definitions JSON from the API documentation library.
     
-    Tries multiple locations to find the appliance type definitions JSON:
+    Tries multiple locations to find the ERD definitions JSON:
     1. Local submodule directory (for development with checked out repo)
     2. ESPHome library cache in user's home directory (~/.esphome/external_files/libraries/)
     3. ESPHome library cache in /config directory (Home Assistant add-on)
@@ -103,7 +117,7 @@ def load_appliance_types():
     6. GitHub as fallback (when no local copy is available)
     
     Returns:
-        Dictionary mapping appliance type IDs (int) to names (str)
+        The parsed JSON, or None if it could not be loaded
     """
     # ESPHome downloads libraries to .esphome/external_files/libraries
     # We need to check multiple possible locations
@@ -167,7 +181,7 @@ def load_appliance_types():
             try:
                 with open(json_path, 'r') as f:
                     data = json.load(f)
-                _LOGGER.info("Loaded appliance types from %s: %s", location_name, json_path)
+                _LOGGER.info("Loaded ERD definitions from %s: %s", location_name, json_path)
                 break
             except Exception as e:
                 _LOGGER.warning("Failed to load from %s (%s): %s", location_name, json_path, str(e))
@@ -180,35 +194,45 @@ def load_appliance_types():
         try:
             with urllib.request.urlopen(url, timeout=10) as response:
                 data = json.loads(response.read().decode('utf-8'))
-            _LOGGER.info("Successfully fetched appliance types from GitHub (fallback)")
+            _LOGGER.info("Successfully fetched ERD definitions from GitHub (fallback)")
         except urllib.error.HTTPError as e:
             _LOGGER.error(
                 "HTTP error fetching appliance API documentation (status %d): %s. Using fallback mapping.", 
                 e.code, str(e)
             )
-            return {
-                0: "Unknown",
-                255: "Unknown"
-            }
+            return None
         except urllib.error.URLError as e:
             _LOGGER.error(
                 "Network error fetching appliance API documentation: %s. Using fallback mapping.", 
                 str(e.reason)
             )
-            return {
-                0: "Unknown",
-                255: "Unknown"
-            }
+            return None
         except Exception as e:
             _LOGGER.error(
                 "Unexpected error fetching appliance API documentation: %s. Using fallback mapping.", 
                 str(e)
             )
-            return {
-                0: "Unknown",
-                255: "Unknown"
-            }
+            return None
+    
+    return data
+
+
+def load_appliance_types(data):
+    """Load appliance type mappings from the ERD definitions.
     
+    Args:
+        data: The parsed ERD definitions JSON, or None if it could not be loaded
+    
+    Returns:
+        Dictionary mapping appliance type IDs (int) to names (str)
+    """
+    if data is None:
+        _LOGGER.warning("Using fallback appliance type mapping")
+        return {
+            0: "Unknown",
+            255: "Unknown"
+        }
+
     # Parse the data
     try:
         # Find the ERD with id "0x0008" (Appliance Type)
@@ -238,6 +262,72 @@ def load_appliance_types():
     }
 
 
+def load_erd_list_generator():
+    """Load scripts/generate_erd_lists.py from the same checkout as the component.
+    
+    Returns:
+        The generator module, or None if the script cannot be found
+    """
+    component_dir = os.path.dirname(__file__)
+    script_path = os.path.normpath(os.path.join(component_dir, "..", "..", "scripts", "generate_erd_lists.py"))
+
+    if not os.path.exists(script_path):
+        return None
+
+    spec = importlib.util.spec_from_file_location("generate_erd_lists", script_path)
+    generator = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(generator)
+    return generator
+
+
+ERD_LIST_GENERATOR = load_erd_list_generator()
+
+# Appliance types the ERD list generator knows which lists to keep for
+MAX_APPLIANCE_TYPE = len(ERD_LIST_GENERATOR.APPLIANCE_TYPE_CATEGORIES) - 1 if ERD_LIST_GENERATOR else 255
+
+# generate_erd_lists.py writes this into the header comment of trimmed ERD lists
+TRIMMED_ERD_LISTS_MARKER = "Only the lists for appliance types"
+
+
+def generate_erd_lists(data, appliance_types):
+    """Regenerate erd_lists.h with the ERD lists the given appliance types poll.
+    
+    The header is regenerated on every build, with every list when no appliance types
+    are given, so lists trimmed by an earlier build never outlive the configuration
+    that asked for them. It is only rewritten when its contents change. If the script
+    or the ERD definitions are unavailable, an existing header with every list is
+    kept; a trimmed or missing header stops the build.
+    
+    Args:
+        data: The parsed ERD definitions JSON, or None if it could not be loaded
+        appliance_types: Appliance type IDs (values of ERD 0x0008) to keep lists for,
+            or None for every list
+    """
+    header_path = os.path.join(os.path.dirname(__file__), "erd_lists.h")
+
+    existing = None
+    if os.path.exists(header_path):
+        with open(header_path, "r") as f:
+            existing = f.read()
+
+    if data is None or ERD_LIST_GENERATOR is None:
+        if existing is None or TRIMMED_ERD_LISTS_MARKER in existing:
+            raise EsphomeError(
+                "Cannot generate erd_lists.h: the ERD definitions or scripts/generate_erd_lists.py are unavailable"
+            )
+        if appliance_types:
+            _LOGGER.warning("Cannot generate ERD lists for appliance types %s; keeping the full ERD lists", appliance_types)
+        return
+
+    header = ERD_LIST_GENERATOR.generate_erd_lists(data, appliance_types, log=_LOGGER.debug)
+
+    if header != existing:
+        with open(header_path, "w") as f:
+            f.write(header)
+    if appliance_types:
+        _LOGGER.info("Generated ERD lists for appliance types %s", appliance_types)
+
+
 def generate_appliance_type_function(appliance_types):
     """Generate C++ code for the appliance type to string function."""
     # Generate switch cases with consistent indentation
@@ -276,6 +366,18 @@ CONFIG_SCHEMA = cv.Schema(
         ),
         cv.Optional(CONF_POLLING_INTERVAL, default=10000): cv.positive_int,
         cv.Optional(CONF_POLLING_ONLY_PUBLISH_ON_CHANGE, default=False): cv.boolean,
+        cv.Optional(CONF_POLLING_CHANGE_DETECTION, default=CHANGE_DETECTION_FULL): cv.enum(
+            {
+                CHANGE_DETECTION_FULL: CHANGE_DETECTION_FULL_VALUE,
+                CHANGE_DETECTION_DIGEST: CHANGE_DETECTION_DIGEST_VALUE,
+            },
+            upper=False
+        ),
+        cv.Optional(CONF_FAST_BOOT, default=True): cv.boolean,
+        cv.Optional(CONF_BUS_TASK, default=False): cv.All(cv.boolean, cv.only_on_esp32),
+        cv.Optional(CONF_APPLIANCE_TYPES): cv.All(
+            cv.ensure_list(cv.int_range(min=0, max=MAX_APPLIANCE_TYPE)), cv.Length(min=1)
+        ),
         cv.Optional(CONF_GEA3_ADDRESS, default=0xC0): cv.int_range(min=0, max=255),
         cv.Optional(CONF_GEA2_ADDRESS, default=0xA0): cv.int_range(min=0, max=255),
         cv.Optional(CONF_GEA_MODE, default=GEA_MODE_AUTO): cv.enum(
@@ -319,6 +421,9 @@ async def to_code(config):
     cg.add(var.set_mode(config[CONF_MODE]))
     cg.add(var.set_polling_interval(config[CONF_POLLING_INTERVAL]))
     cg.add(var.set_polling_only_publish_on_change(config[CONF_POLLING_ONLY_PUBLISH_ON_CHANGE]))
+    cg.add(var.set_polling_change_detection(config[CONF_POLLING_CHANGE_DETECTION]))
+    cg.add(var.set_fast_boot(config[CONF_FAST_BOOT]))
+    cg.add(var.set_bus_task(config[CONF_BUS_TASK]))
 
     # Set GEA protocol configuration
     cg.add(var.set_gea3_address(config[CONF_GEA3_ADDRESS]))
@@ -326,8 +431,13 @@ async def to_code(config):
     cg.add(var.set_gea_mode(config[CONF_GEA_MODE]))
     
     # Load appliance types from JSON and generate C++ mapping function
-    appliance_types = load_appliance_types()
+    erd_definitions = load_erd_definitions()
+    appliance_types = load_appliance_types(erd_definitions)
     function_code = generate_appliance_type_function(appliance_types)
     
     # Add the generated function to the global namespace
     cg.add_global(cg.RawStatement(function_code))
+
+    # Only compile the ERD lists of the appliances this device will be connected to, or every
+    # list when they are not configured
+    generate_erd_lists(erd_definitions, config.get(CONF_APPLIANCE_TYPES))
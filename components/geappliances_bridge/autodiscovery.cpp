@@ -0,0 +1,437 @@
+/*!
+ * @file
+ * @brief Finds the boards on the GEA3 and GEA2 buses and reads the host's identity.
+ */
+
+extern "C" {
+#include "autodiscovery.h"
+}
+
+#include <algorithm>
+#include <cstring>
+
+enum {
+  state_idle,
+  state_waiting_for_bus_settle,
+  state_broadcasting,
+  state_reading_identity,
+  state_identity_failed,
+  state_complete
+};
+
+enum {
+  erd_model_number = 0x0001,
+  erd_serial_number = 0x0002,
+  erd_appliance_type = 0x0008,
+  // Every board answers a broadcast read of its appliance type
+  erd_discovery = erd_appliance_type,
+  broadcast_address = 0xFF
+};
+
+// Bit i of the identity read masks refers to identity_erds[i]
+static const tiny_erd_t identity_erds[] = { erd_appliance_type, erd_model_number, erd_serial_number };
+enum {
+  identity_read_count = sizeof(identity_erds) / sizeof(identity_erds[0]),
+  identity_reads_all = (1 << identity_read_count) - 1
+};
+
+static void start_broadcasts(autodiscovery_t* self);
+
+static void progress(autodiscovery_t* self, autodiscovery_progress_t progress)
+{
+  self->callbacks->progress(self->context, progress);
+}
+
+static void stop_timers(autodiscovery_t* self)
+{
+  tiny_timer_stop(self->timer_group, &self->timer);
+  tiny_timer_stop(self->timer_group, &self->window_timer);
+}
+
+static bool record_gea3_board(autodiscovery_t* self, uint8_t address)
+{
+  for(uint8_t i = 0; i < self->gea3_board_count; i++) {
+    if(self->gea3_boards[i] == address) {
+      return false;
+    }
+  }
+
+  if(self->gea3_board_count >= autodiscovery_max_gea3_boards) {
+    return false;
+  }
+
+  self->gea3_boards[self->gea3_board_count++] = address;
+  return true;
+}
+
+static void queue_identity_reads(autodiscovery_t* self);
+
+static void schedule_identity_retry(autodiscovery_t* self)
+{
+  // Reads that failed together share one retry
+  if(tiny_timer_is_running(self->timer_group, &self->timer)) {
+    return;
+  }
+
+  if(self->identity_retry_count >= autodiscovery_identity_max_retries) {
+    // The host may have moved or changed protocol, so start over from discovery
+    self->state = state_identity_failed;
+    tiny_timer_start(
+      self->timer_group, &self->timer, autodiscovery_identity_recovery_delay, self, +[](void* context) {
+        start_broadcasts(reinterpret_cast<autodiscovery_t*>(context));
+      });
+    progress(self, autodiscovery_progress_identity_read_failed);
+    return;
+  }
+
+  tiny_timer_ticks_t delay = std::min<tiny_timer_ticks_t>(
+    autodiscovery_identity_retry_base_delay << self->identity_retry_count,
+    autodiscovery_identity_retry_max_delay);
+  self->identity_retry_count++;
+
+  tiny_timer_start(
+    self->timer_group, &self->timer, delay, self, +[](void* context) {
+      queue_identity_reads(reinterpret_cast<autodiscovery_t*>(context));
+    });
+  progress(self, autodiscovery_progress_identity_read_retrying);
+}
+
+// All identity reads are queued at once so the ERD client sends them back to back
+static void queue_identity_reads(autodiscovery_t* self)
+{
+  for(uint8_t i = 0; i < identity_read_count; i++) {
+    uint8_t bit = 1 << i;
+    if(!(self->identity_reads_to_queue & bit)) {
+      continue;
+    }
+
+    if(!self->callbacks->read(self->context, self->host_protocol, self->host_address, identity_erds[i])) {
+      // The GEA3 client says when it has room again; GEA2 falls back to the retry timer
+      if(self->host_protocol == autodiscovery_protocol_gea2) {
+        schedule_identity_retry(self);
+      }
+      return;
+    }
+
+    self->identity_reads_to_queue &= ~bit;
+  }
+}
+
+static void identity_read_finished(autodiscovery_t* self, tiny_erd_t erd, bool success, const void* data, uint8_t data_size)
+{
+  uint8_t bit = 0;
+  for(uint8_t i = 0; i < identity_read_count; i++) {
+    if(identity_erds[i] == erd) {
+      bit = 1 << i;
+    }
+  }
+  if((bit == 0) || (self->identity_reads_received & bit)) {
+    return;
+  }
+
+  if(!success) {
+    self->identity_reads_to_queue |= bit;
+    schedule_identity_retry(self);
+    return;
+  }
+
+  // Progress resets the backoff
+  self->identity_retry_count = 0;
+  self->identity_reads_received |= bit;
+
+  self->callbacks->identity_erd_read(self->context, erd, data, data_size);
+
+  if(self->identity_reads_received == identity_reads_all) {
+    tiny_timer_stop(self->timer_group, &self->timer);
+    self->state = state_complete;
+    progress(self, autodiscovery_progress_identity_read);
+  }
+}
+
+static void start_identity_reads(autodiscovery_t* self)
+{
+  self->state = state_reading_identity;
+  self->identity_reads_to_queue = identity_reads_all;
+  self->identity_reads_received = 0;
+  self->identity_retry_count = 0;
+  queue_identity_reads(self);
+}
+
+// When both buses answer, the choice is fixed regardless of which response arrived first:
+// preferred GEA3 address, then preferred GEA2 address, then first GEA3 responder, then first
+// GEA2 responder. GEA3 wins ties because the MQTT bridges run on the GEA3 client.
+static bool select_host(autodiscovery_t* self)
+{
+  if(self->gea3_preferred_found) {
+    self->host_protocol = autodiscovery_protocol_gea3;
+    self->host_address = self->configuration.gea3_preferred_address;
+  }
+  else if(self->gea2_preferred_found) {
+    self->host_protocol = autodiscovery_protocol_gea2;
+    self->host_address = self->configuration.gea2_preferred_address;
+  }
+  else if(self->gea3_first_address_set) {
+    self->host_protocol = autodiscovery_protocol_gea3;
+    self->host_address = self->gea3_first_address;
+  }
+  else if(self->gea2_first_address_set) {
+    self->host_protocol = autodiscovery_protocol_gea2;
+    self->host_address = self->gea2_first_address;
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+static void close_window(void* context)
+{
+  auto self = reinterpret_cast<autodiscovery_t*>(context);
+  stop_timers(self);
+
+  if(!select_host(self)) {
+    progress(self, autodiscovery_progress_no_boards_found);
+    start_broadcasts(self);
+    return;
+  }
+
+  self->state = state_complete;
+  progress(self, autodiscovery_progress_host_selected);
+
+  if(self->read_identity) {
+    start_identity_reads(self);
+  }
+}
+
+// A broadcast that cannot be queued yet is tried again shortly
+static void send_broadcasts(autodiscovery_t* self)
+{
+  if(self->configuration.gea3 && !self->gea3_broadcast_sent) {
+    self->gea3_broadcast_sent = self->callbacks->read(self->context, autodiscovery_protocol_gea3, broadcast_address, erd_discovery);
+  }
+  if(self->configuration.gea2 && !self->gea2_broadcast_sent) {
+    self->gea2_broadcast_sent = self->callbacks->read(self->context, autodiscovery_protocol_gea2, broadcast_address, erd_discovery);
+  }
+
+  if((self->gea3_broadcast_sent != self->configuration.gea3) || (self->gea2_broadcast_sent != self->configuration.gea2)) {
+    tiny_timer_start(
+      self->timer_group, &self->timer, autodiscovery_broadcast_retry_delay, self, +[](void* context) {
+        send_broadcasts(reinterpret_cast<autodiscovery_t*>(context));
+      });
+  }
+}
+
+// The buses are independent, so both broadcasts share one collection window
+static void start_broadcasts(autodiscovery_t* self)
+{
+  stop_timers(self);
+  self->state = state_broadcasting;
+  self->gea3_board_count = 0;
+  self->gea3_first_address_set = false;
+  self->gea2_first_address_set = false;
+  self->gea3_preferred_found = false;
+  self->gea2_preferred_found = false;
+  self->board_discovered = false;
+  self->gea3_broadcast_sent = false;
+  self->gea2_broadcast_sent = false;
+
+  self->window_started_at = tiny_time_source_ticks(self->timer_group->time_source);
+  tiny_timer_start(self->timer_group, &self->window_timer, autodiscovery_broadcast_window, self, close_window);
+  send_broadcasts(self);
+}
+
+static void board_answered(autodiscovery_t* self, autodiscovery_protocol_t protocol, uint8_t address)
+{
+  // Boards answer a broadcast within a few round trips of each other, so the quiet period
+  // scales with how long the first board took to answer
+  tiny_timer_ticks_t elapsed = std::min<tiny_timer_ticks_t>(
+    (tiny_time_source_ticks_t)(tiny_time_source_ticks(self->timer_group->time_source) - self->window_started_at),
+    autodiscovery_broadcast_window);
+
+  if(!self->board_discovered) {
+    self->quiet_period = std::min<tiny_timer_ticks_t>(
+      std::max<tiny_timer_ticks_t>(elapsed * autodiscovery_quiet_period_factor, autodiscovery_min_quiet_period),
+      autodiscovery_max_quiet_period);
+    self->board_discovered = true;
+  }
+
+  if(protocol == autodiscovery_protocol_gea3) {
+    record_gea3_board(self, address);
+    if(address == self->configuration.gea3_preferred_address) {
+      self->gea3_preferred_found = true;
+    }
+    else if(!self->gea3_first_address_set) {
+      self->gea3_first_address = address;
+      self->gea3_first_address_set = true;
+    }
+  }
+  else {
+    if(address == self->configuration.gea2_preferred_address) {
+      self->gea2_preferred_found = true;
+    }
+    else if(!self->gea2_first_address_set) {
+      self->gea2_first_address = address;
+      self->gea2_first_address_set = true;
+    }
+  }
+
+  // Nothing else is worth waiting for once the board that wins selection has answered. The
+  // preferred GEA2 board only wins if no GEA3 board could outrank it. Otherwise the window
+  // closes after the quiet period, but never later than its upper bound.
+  bool selection_final = self->gea3_preferred_found || (self->gea2_preferred_found && !self->configuration.gea3);
+  tiny_timer_ticks_t remaining = std::min<tiny_timer_ticks_t>(self->quiet_period, autodiscovery_broadcast_window - elapsed);
+  tiny_timer_start(self->timer_group, &self->window_timer, selection_final ? 0 : remaining, self, close_window);
+}
+
+static void wait_for_bus_settle(autodiscovery_t* self)
+{
+  stop_timers(self);
+  self->state = state_waiting_for_bus_settle;
+
+  tiny_timer_start(
+    self->timer_group, &self->window_timer, autodiscovery_startup_delay, self, +[](void* context) {
+      auto self = reinterpret_cast<autodiscovery_t*>(context);
+      progress(self, autodiscovery_progress_startup_delay_expired);
+      start_broadcasts(self);
+    });
+
+  tiny_timer_start_periodic(
+    self->timer_group, &self->timer, autodiscovery_bus_settle_sample_period, self, +[](void* context) {
+      auto self = reinterpret_cast<autodiscovery_t*>(context);
+      if(self->callbacks->buses_settled(self->context)) {
+        progress(self, autodiscovery_progress_buses_settled);
+        start_broadcasts(self);
+      }
+    });
+}
+
+void autodiscovery_init(
+  autodiscovery_t* self,
+  tiny_timer_group_t* timer_group,
+  const autodiscovery_configuration_t* configuration,
+  const autodiscovery_callbacks_t* callbacks,
+  void* context)
+{
+  memset(self, 0, sizeof(*self));
+  self->configuration = *configuration;
+  self->timer_group = timer_group;
+  self->callbacks = callbacks;
+  self->context = context;
+  self->state = state_idle;
+}
+
+void autodiscovery_start(
+  autodiscovery_t* self,
+  bool read_identity)
+{
+  self->read_identity = read_identity;
+  wait_for_bus_settle(self);
+}
+
+void autodiscovery_restore(
+  autodiscovery_t* self,
+  autodiscovery_protocol_t protocol,
+  uint8_t host_address,
+  const uint8_t* secondary_addresses,
+  uint8_t secondary_address_count)
+{
+  stop_timers(self);
+  self->state = state_complete;
+  self->host_protocol = protocol;
+  self->host_address = host_address;
+
+  self->gea3_board_count = 0;
+  if(protocol == autodiscovery_protocol_gea3) {
+    record_gea3_board(self, host_address);
+    for(uint8_t i = 0; i < secondary_address_count; i++) {
+      record_gea3_board(self, secondary_addresses[i]);
+    }
+  }
+}
+
+void autodiscovery_notify_ready(
+  autodiscovery_t* self)
+{
+  if((self->state == state_broadcasting) && self->configuration.gea3 && !self->gea3_broadcast_sent) {
+    tiny_timer_stop(self->timer_group, &self->timer);
+    send_broadcasts(self);
+  }
+  else if((self->state == state_reading_identity) && (self->host_protocol == autodiscovery_protocol_gea3) &&
+    (self->identity_reads_to_queue != 0) && !tiny_timer_is_running(self->timer_group, &self->timer)) {
+    queue_identity_reads(self);
+  }
+}
+
+bool autodiscovery_read_finished(
+  autodiscovery_t* self,
+  autodiscovery_protocol_t protocol,
+  uint8_t address,
+  tiny_erd_t erd,
+  bool success,
+  const void* data,
+  uint8_t data_size)
+{
+  if(self->state == state_broadcasting) {
+    if(erd != erd_discovery) {
+      return false;
+    }
+
+    if(success) {
+      board_answered(self, protocol, address);
+      self->callbacks->board_discovered(self->context, protocol, address, reinterpret_cast<const uint8_t*>(data)[0]);
+    }
+    return true;
+  }
+
+  if(!autodiscovery_host_selected(self)) {
+    return false;
+  }
+
+  // The window closes as soon as the preferred board answers; other boards that answer the
+  // same broadcast afterwards are still found
+  if(success && (erd == erd_discovery) && (protocol == autodiscovery_protocol_gea3) &&
+    (self->host_protocol == autodiscovery_protocol_gea3) && (address != self->host_address)) {
+    if(record_gea3_board(self, address)) {
+      self->callbacks->board_discovered(self->context, protocol, address, reinterpret_cast<const uint8_t*>(data)[0]);
+    }
+    return true;
+  }
+
+  if((self->state != state_reading_identity) || (protocol != self->host_protocol) || (address != self->host_address)) {
+    return false;
+  }
+
+  identity_read_finished(self, erd, success, data, data_size);
+  return true;
+}
+
+bool autodiscovery_host_selected(
+  autodiscovery_t* self)
+{
+  return (self->state == state_reading_identity) || (self->state == state_identity_failed) || (self->state == state_complete);
+}
+
+autodiscovery_protocol_t autodiscovery_host_protocol(
+  autodiscovery_t* self)
+{
+  return self->host_protocol;
+}
+
+uint8_t autodiscovery_host_address(
+  autodiscovery_t* self)
+{
+  return self->host_address;
+}
+
+uint8_t autodiscovery_gea3_board_count(
+  autodiscovery_t* self)
+{
+  return self->gea3_board_count;
+}
+
+uint8_t autodiscovery_gea3_board(
+  autodiscovery_t* self,
+  uint8_t index)
+{
+  return self->gea3_boards[index];
+}
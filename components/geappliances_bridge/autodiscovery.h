@@ -0,0 +1,197 @@
+/*!
+ * @file
+ * @brief Finds the boards on the GEA3 and GEA2 buses and reads the host's identity.
+ *
+ * After power-up the buses are sampled until they settle, or until the startup
+ * delay runs out. Each bus in use is then sent a discovery broadcast and both
+ * share one collection window. The window closes as soon as the board that wins
+ * selection has answered, once the bus has been quiet for a multiple of the first
+ * response's latency, or after a fixed upper bound. If no board answered, the
+ * broadcasts are sent again.
+ *
+ * When asked to, the appliance type, model number and serial number are then read
+ * from the selected host. All three reads are queued at once; reads that fail are
+ * retried with a doubling delay, and once the retries run out the whole sequence
+ * starts over from the broadcasts.
+ *
+ * Everything is timed on the timer group and reads go through callbacks, so the
+ * owner only routes read results back in.
+ */
+
+#ifndef autodiscovery_h
+#define autodiscovery_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mqtt_bridge.h"
+#include "tiny_erd.h"
+#include "tiny_timer.h"
+
+enum {
+  autodiscovery_bus_settle_sample_period = 250,
+  // Upper bound on waiting for the buses to settle
+  autodiscovery_startup_delay = 20000,
+  // Upper bound on each broadcast window
+  autodiscovery_broadcast_window = 10000,
+  // Quiet period after the last response, in multiples of the first response latency
+  autodiscovery_quiet_period_factor = 4,
+  autodiscovery_min_quiet_period = 250,
+  autodiscovery_max_quiet_period = 2000,
+  // A broadcast that cannot be queued yet is tried again after about one pass of the loop
+  autodiscovery_broadcast_retry_delay = 16,
+  // Doubles on every retry without progress
+  autodiscovery_identity_retry_base_delay = 100,
+  autodiscovery_identity_retry_max_delay = 5000,
+  autodiscovery_identity_max_retries = 8,
+  autodiscovery_identity_recovery_delay = 60000,
+  // Every GEA3 board that answers shares the bridge
+  autodiscovery_max_gea3_boards = mqtt_bridge_max_hosts
+};
+
+enum {
+  autodiscovery_protocol_gea3,
+  autodiscovery_protocol_gea2
+};
+typedef uint8_t autodiscovery_protocol_t;
+
+enum {
+  autodiscovery_progress_buses_settled,
+  autodiscovery_progress_startup_delay_expired,
+  autodiscovery_progress_no_boards_found,
+  autodiscovery_progress_host_selected,
+  autodiscovery_progress_identity_read_retrying,
+  autodiscovery_progress_identity_read_failed,
+  autodiscovery_progress_identity_read
+};
+typedef uint8_t autodiscovery_progress_t;
+
+typedef struct {
+  bool gea3;
+  bool gea2;
+  uint8_t gea3_preferred_address;
+  uint8_t gea2_preferred_address;
+} autodiscovery_configuration_t;
+
+typedef struct {
+  // Sample the buses in use. Returns true once all of them have settled.
+  bool (*buses_settled)(void* context);
+  // Queue a read on one of the buses. Returns false if it could not be queued.
+  bool (*read)(void* context, autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd);
+  // A board answered the discovery broadcast, possibly after the host was selected
+  void (*board_discovered)(void* context, autodiscovery_protocol_t protocol, uint8_t address, uint8_t appliance_type);
+  // The host's appliance type, model number or serial number was read
+  void (*identity_erd_read)(void* context, tiny_erd_t erd, const void* data, uint8_t data_size);
+  // Autodiscovery moved on to its next step
+  void (*progress)(void* context, autodiscovery_progress_t progress);
+} autodiscovery_callbacks_t;
+
+typedef struct {
+  autodiscovery_configuration_t configuration;
+  tiny_timer_group_t* timer_group;
+  tiny_timer_t timer;
+  tiny_timer_t window_timer;
+  const autodiscovery_callbacks_t* callbacks;
+  void* context;
+  tiny_timer_ticks_t quiet_period;
+  tiny_time_source_ticks_t window_started_at;
+  uint8_t gea3_boards[autodiscovery_max_gea3_boards];
+  uint8_t gea3_board_count;
+  uint8_t state;
+  autodiscovery_protocol_t host_protocol;
+  uint8_t host_address;
+  uint8_t gea3_first_address;
+  uint8_t gea2_first_address;
+  bool gea3_first_address_set;
+  bool gea2_first_address_set;
+  bool gea3_preferred_found;
+  bool gea2_preferred_found;
+  bool board_discovered;
+  bool gea3_broadcast_sent;
+  bool gea2_broadcast_sent;
+  bool read_identity;
+  uint8_t identity_reads_to_queue;
+  uint8_t identity_reads_received;
+  uint8_t identity_retry_count;
+} autodiscovery_t;
+
+/*!
+ * Initialize without starting.
+ */
+void autodiscovery_init(
+  autodiscovery_t* self,
+  tiny_timer_group_t* timer_group,
+  const autodiscovery_configuration_t* configuration,
+  const autodiscovery_callbacks_t* callbacks,
+  void* context);
+
+/*!
+ * Wait for the buses to settle, then find the host. Its identity is read
+ * afterwards if requested.
+ */
+void autodiscovery_start(
+  autodiscovery_t* self,
+  bool read_identity);
+
+/*!
+ * Take the host and the other GEA3 boards from a previous boot instead of
+ * discovering them.
+ */
+void autodiscovery_restore(
+  autodiscovery_t* self,
+  autodiscovery_protocol_t protocol,
+  uint8_t host_address,
+  const uint8_t* secondary_addresses,
+  uint8_t secondary_address_count);
+
+/*!
+ * The GEA3 client has room again; reads it refused are queued now.
+ */
+void autodiscovery_notify_ready(
+  autodiscovery_t* self);
+
+/*!
+ * Report the outcome of a read on either bus. Returns true if it was a discovery
+ * response or one of the identity reads.
+ */
+bool autodiscovery_read_finished(
+  autodiscovery_t* self,
+  autodiscovery_protocol_t protocol,
+  uint8_t address,
+  tiny_erd_t erd,
+  bool success,
+  const void* data,
+  uint8_t data_size);
+
+/*!
+ * True once a host has been selected or restored, until the broadcasts are sent
+ * again.
+ */
+bool autodiscovery_host_selected(
+  autodiscovery_t* self);
+
+/*!
+ * Protocol of the selected host.
+ */
+autodiscovery_protocol_t autodiscovery_host_protocol(
+  autodiscovery_t* self);
+
+/*!
+ * Address of the selected host.
+ */
+uint8_t autodiscovery_host_address(
+  autodiscovery_t* self);
+
+/*!
+ * Number of GEA3 boards found, including the host if it is on GEA3.
+ */
+uint8_t autodiscovery_gea3_board_count(
+  autodiscovery_t* self);
+
+/*!
+ * Address of one of the GEA3 boards found.
+ */
+uint8_t autodiscovery_gea3_board(
+  autodiscovery_t* self,
+  uint8_t index);
+
+#endif
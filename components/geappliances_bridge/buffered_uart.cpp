@@ -0,0 +1,168 @@
+/*!
+ * @file
+ * @brief Event-driven i_tiny_uart_t on top of a bulk UART driver.
+ */
+
+extern "C" {
+#include "buffered_uart.h"
+#include "tiny_gea_constants.h"
+}
+
+#include <cstddef>
+
+enum {
+  // Destination, length, then source follow the STX
+  frame_source_position = 3
+};
+
+// Returns true when the byte ends a frame
+static bool track_frame(buffered_uart_frame_t* frame, uint8_t byte)
+{
+  if(frame->escape_pending) {
+    frame->escape_pending = false;
+  }
+  else if(byte == tiny_gea_esc) {
+    frame->escape_pending = true;
+    return false;
+  }
+  else if(byte == tiny_gea_stx) {
+    frame->in_frame = true;
+    frame->position = 0;
+    return false;
+  }
+  else if(byte == tiny_gea_etx) {
+    bool ended = frame->in_frame;
+    frame->in_frame = false;
+    return ended;
+  }
+
+  if(frame->in_frame && (++frame->position == frame_source_position)) {
+    frame->source = byte;
+  }
+  return false;
+}
+
+// Bus activity statistics used to decide when the bus has settled after power-up.
+// Frames are counted by their (unescaped) ETX byte.
+static void track_received_bytes(buffered_uart_t* self, const uint8_t* data, uint16_t size)
+{
+  self->received_byte_count += size;
+
+  for(uint16_t i = 0; i < size; i++) {
+    if(track_frame(&self->received_frame, data[i])) {
+      self->received_frame_count++;
+
+      // The request's own reflection does not answer it
+      if(self->received_frame.source != self->sent_frame.source) {
+        tiny_timer_stop(self->timer_group, &self->response_timer);
+      }
+    }
+  }
+}
+
+static void received(void* context, const uint8_t* data, uint16_t size)
+{
+  auto self = static_cast<buffered_uart_t*>(context);
+
+  track_received_bytes(self, data, size);
+
+  // The GEA interfaces consume one byte per receive event
+  for(uint16_t i = 0; i < size; i++) {
+    tiny_uart_on_receive_args_t args = { data[i] };
+    tiny_event_publish(&self->receive_event, &args);
+  }
+}
+
+static void process(void* context);
+
+static void schedule_processing(buffered_uart_t* self)
+{
+  if(!tiny_timer_is_running(self->timer_group, &self->process_timer)) {
+    tiny_timer_start(self->timer_group, &self->process_timer, 0, self, process);
+  }
+}
+
+static void process(void* context)
+{
+  auto self = static_cast<buffered_uart_t*>(context);
+
+  self->processing = true;
+  uart_rx_ring_run(&self->rx_ring, received, self);
+  uart_tx_batch_run(&self->tx_batch, &self->send_complete_event);
+  self->processing = false;
+
+  // Without batching only one byte is completed per pass, and a busy driver leaves bytes behind
+  if(self->tx_batch.byte_pending || uart_tx_batch_has_unwritten_bytes(&self->tx_batch)) {
+    schedule_processing(self);
+  }
+}
+
+// Only whether the response window is still open matters
+static void response_window_expired(void* context)
+{
+  (void)context;
+}
+
+static void send(i_tiny_uart_t* _self, uint8_t byte)
+{
+  auto self = reinterpret_cast<buffered_uart_t*>(_self);
+
+  uart_tx_batch_send(&self->tx_batch, byte);
+  if(track_frame(&self->sent_frame, byte)) {
+    tiny_timer_start(self->timer_group, &self->response_timer, buffered_uart_response_window, self, response_window_expired);
+  }
+
+  if(!self->processing) {
+    schedule_processing(self);
+  }
+}
+
+static i_tiny_event_t* on_send_complete(i_tiny_uart_t* _self)
+{
+  auto self = reinterpret_cast<buffered_uart_t*>(_self);
+  return &self->send_complete_event.interface;
+}
+
+static i_tiny_event_t* on_receive(i_tiny_uart_t* _self)
+{
+  auto self = reinterpret_cast<buffered_uart_t*>(_self);
+  return &self->receive_event.interface;
+}
+
+static const i_tiny_uart_api_t api = { send, on_send_complete, on_receive };
+
+void buffered_uart_init(
+  buffered_uart_t* self,
+  tiny_timer_group_t* timer_group,
+  uart_rx_ring_read_t read,
+  uart_tx_batch_write_t write,
+  void* context,
+  bool batch_transmit)
+{
+  self->interface.api = &api;
+  self->timer_group = timer_group;
+  self->received_byte_count = 0;
+  self->received_frame_count = 0;
+  self->received_frame = {};
+  self->sent_frame = {};
+  self->processing = false;
+
+  tiny_event_init(&self->send_complete_event);
+  tiny_event_init(&self->receive_event);
+  uart_rx_ring_init(&self->rx_ring, read, context);
+  uart_tx_batch_init(&self->tx_batch, write, context, batch_transmit);
+}
+
+void buffered_uart_notify_rx_ready(
+  buffered_uart_t* self)
+{
+  schedule_processing(self);
+}
+
+bool buffered_uart_transaction_in_flight(
+  buffered_uart_t* self)
+{
+  return self->received_frame.in_frame ||
+    self->sent_frame.in_frame ||
+    tiny_timer_is_running(self->timer_group, &self->response_timer);
+}
@@ -0,0 +1,82 @@
+/*!
+ * @file
+ * @brief Event-driven i_tiny_uart_t on top of a bulk UART driver.
+ *
+ * Nothing is polled on a timer. Receive processing is scheduled when the owner
+ * reports that the UART has data ready, and transmit processing is scheduled
+ * when the GEA interface sends a byte. Received bytes go through the receive
+ * ring and sent bytes through the transmit batch.
+ *
+ * The UART also tracks whether a transaction is in flight, that is, a frame is
+ * partially sent or received, or a request was sent and neither its response
+ * nor the end of the response window has arrived yet, so that the owner can
+ * loop quickly only while that is the case. A response is any received frame
+ * from a source other than the request's, which skips the reflection of the
+ * request on a single-wire bus.
+ */
+
+#ifndef buffered_uart_h
+#define buffered_uart_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hal/i_tiny_uart.h"
+#include "tiny_event.h"
+#include "tiny_timer.h"
+#include "uart_rx_ring.h"
+#include "uart_tx_batch.h"
+
+enum {
+  // Matches the ERD client request timeout
+  buffered_uart_response_window = 250
+};
+
+// Position within the frame being sent or received, tracked from the escaped byte stream
+typedef struct {
+  uint8_t position;
+  uint8_t source;
+  bool escape_pending;
+  bool in_frame;
+} buffered_uart_frame_t;
+
+typedef struct {
+  i_tiny_uart_t interface;
+  tiny_timer_group_t* timer_group;
+  tiny_timer_t process_timer;
+  tiny_timer_t response_timer;
+  tiny_event_t send_complete_event;
+  tiny_event_t receive_event;
+  uart_rx_ring_t rx_ring;
+  uart_tx_batch_t tx_batch;
+  uint32_t received_byte_count;
+  uint32_t received_frame_count;
+  buffered_uart_frame_t received_frame;
+  buffered_uart_frame_t sent_frame;
+  bool processing;
+} buffered_uart_t;
+
+/*!
+ * Initialize the UART. read and write move bytes to and from the UART driver
+ * without blocking.
+ */
+void buffered_uart_init(
+  buffered_uart_t* self,
+  tiny_timer_group_t* timer_group,
+  uart_rx_ring_read_t read,
+  uart_tx_batch_write_t write,
+  void* context,
+  bool batch_transmit);
+
+/*!
+ * Schedule receive processing because the UART driver has data ready.
+ */
+void buffered_uart_notify_rx_ready(
+  buffered_uart_t* self);
+
+/*!
+ * Returns true while a request is waiting for its response or a frame is being received.
+ */
+bool buffered_uart_transaction_in_flight(
+  buffered_uart_t* self);
+
+#endif
@@ -0,0 +1,75 @@
+/*!
+ * @file
+ * @brief Decides when a GEA bus has settled after power-up.
+ */
+
+extern "C" {
+#include "bus_activity_monitor.h"
+}
+
+#include <cstring>
+
+void bus_activity_monitor_init(
+  bus_activity_monitor_t* self)
+{
+  memset(self, 0, sizeof(*self));
+}
+
+void bus_activity_monitor_sample(
+  bus_activity_monitor_t* self,
+  uint32_t received_byte_count,
+  uint32_t received_frame_count)
+{
+  // The first sample only establishes the baseline for the cumulative counts
+  if(!self->primed) {
+    self->primed = true;
+  }
+  else {
+    self->bytes[self->next_sample] = received_byte_count - self->last_byte_count;
+    self->frames[self->next_sample] = received_frame_count - self->last_frame_count;
+    self->next_sample = (self->next_sample + 1) % bus_activity_monitor_stable_samples;
+
+    if(self->sample_count < bus_activity_monitor_stable_samples) {
+      self->sample_count++;
+    }
+  }
+
+  self->last_byte_count = received_byte_count;
+  self->last_frame_count = received_frame_count;
+}
+
+bool bus_activity_monitor_is_settled(
+  const bus_activity_monitor_t* self)
+{
+  if(self->sample_count < bus_activity_monitor_stable_samples) {
+    return false;
+  }
+
+  uint32_t total_bytes = 0;
+  uint32_t total_frames = 0;
+
+  for(uint8_t i = 0; i < bus_activity_monitor_stable_samples; i++) {
+    // Bytes without any complete frame are boot noise or a board still starting up
+    if((self->bytes[i] > 0) && (self->frames[i] == 0)) {
+      return false;
+    }
+    total_bytes += self->bytes[i];
+    total_frames += self->frames[i];
+  }
+
+  if(total_bytes == 0) {
+    return true;
+  }
+
+  // Compare each period against the mean, scaled by the sample count to stay in integers
+  for(uint8_t i = 0; i < bus_activity_monitor_stable_samples; i++) {
+    uint32_t scaled = self->frames[i] * bus_activity_monitor_stable_samples;
+    uint32_t difference = (scaled > total_frames) ? (scaled - total_frames) : (total_frames - scaled);
+
+    if(difference * 100 > total_frames * bus_activity_monitor_frame_rate_tolerance_percent) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,55 @@
+/*!
+ * @file
+ * @brief Decides when a GEA bus has settled after power-up.
+ *
+ * Appliance boards chatter while they boot and then either go quiet or settle
+ * into steady periodic traffic. The monitor is fed periodic samples of the
+ * cumulative received byte and frame counts for a bus and reports the bus as
+ * settled once the last few sample periods were either silent or carried a
+ * steady frame rate.
+ */
+
+#ifndef bus_activity_monitor_h
+#define bus_activity_monitor_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum {
+  bus_activity_monitor_stable_samples = 4,
+  // Frame counts per sample may differ from their mean by this percentage and still be steady
+  bus_activity_monitor_frame_rate_tolerance_percent = 25
+};
+
+typedef struct {
+  uint32_t last_byte_count;
+  uint32_t last_frame_count;
+  uint32_t frames[bus_activity_monitor_stable_samples];
+  uint32_t bytes[bus_activity_monitor_stable_samples];
+  uint8_t sample_count;
+  uint8_t next_sample;
+  bool primed;
+} bus_activity_monitor_t;
+
+/*!
+ * Initialize the monitor.
+ */
+void bus_activity_monitor_init(
+  bus_activity_monitor_t* self);
+
+/*!
+ * Record one sample period. The counts are cumulative totals since boot and may wrap.
+ */
+void bus_activity_monitor_sample(
+  bus_activity_monitor_t* self,
+  uint32_t received_byte_count,
+  uint32_t received_frame_count);
+
+/*!
+ * Returns true once the last bus_activity_monitor_stable_samples periods were
+ * all silent, or all carried complete frames at a steady rate.
+ */
+bool bus_activity_monitor_is_settled(
+  const bus_activity_monitor_t* self);
+
+#endif
@@ -0,0 +1,130 @@
+/*!
+ * @file
+ * @brief Restores the identity record at boot and checks it against the appliance.
+ */
+
+extern "C" {
+#include "cached_identity.h"
+}
+
+#include <cstring>
+
+enum {
+  state_idle,
+  state_reading,
+  state_waiting,
+  state_complete
+};
+
+static void read_serial_number(void* context);
+
+static void retry_later(cached_identity_t* self)
+{
+  self->state = state_reading;
+  tiny_timer_start(self->timer_group, &self->timer, cached_identity_retry_delay, self, read_serial_number);
+}
+
+// A read the client cannot queue waits as long as a failed one instead of spinning the loop
+static void request_read(cached_identity_t* self)
+{
+  if(self->callbacks->read_serial_number(self->context, self->address)) {
+    self->state = state_waiting;
+  }
+  else {
+    retry_later(self);
+  }
+}
+
+static void read_serial_number(void* context)
+{
+  request_read(reinterpret_cast<cached_identity_t*>(context));
+}
+
+static void start(cached_identity_t* self, uint8_t address, bool capturing)
+{
+  tiny_timer_stop(self->timer_group, &self->timer);
+  self->address = address;
+  self->capturing = capturing;
+  request_read(self);
+}
+
+void cached_identity_init(
+  cached_identity_t* self,
+  tiny_timer_group_t* timer_group,
+  const cached_identity_callbacks_t* callbacks,
+  void* context)
+{
+  memset(&self->record, 0, sizeof(self->record));
+  self->timer_group = timer_group;
+  self->callbacks = callbacks;
+  self->context = context;
+  self->address = 0;
+  self->state = state_idle;
+  self->capturing = false;
+}
+
+bool cached_identity_restore(
+  cached_identity_t* self)
+{
+  return self->callbacks->load(self->context, &self->record) && identity_cache_record_is_valid(&self->record);
+}
+
+identity_cache_record_t* cached_identity_record(
+  cached_identity_t* self)
+{
+  return &self->record;
+}
+
+void cached_identity_verify(
+  cached_identity_t* self)
+{
+  start(self, self->record.host_address, false);
+}
+
+void cached_identity_capture(
+  cached_identity_t* self,
+  uint8_t address)
+{
+  start(self, address, true);
+}
+
+bool cached_identity_read_finished(
+  cached_identity_t* self,
+  uint8_t address,
+  bool success,
+  const void* serial_number,
+  uint8_t serial_number_size)
+{
+  if((self->state != state_waiting) || (address != self->address)) {
+    return false;
+  }
+
+  // An unresponsive host is not a mismatch; keep the record and try again later
+  if(!success) {
+    retry_later(self);
+    return true;
+  }
+
+  self->state = state_complete;
+
+  if(self->capturing) {
+    self->callbacks->finished(self->context, cached_identity_result_captured, serial_number, serial_number_size);
+  }
+  else if(identity_cache_record_matches_serial_number(&self->record, serial_number, serial_number_size)) {
+    self->callbacks->finished(self->context, cached_identity_result_verified, nullptr, 0);
+  }
+  else {
+    identity_cache_record_invalidate(&self->record);
+    self->callbacks->save(self->context, &self->record);
+    self->callbacks->finished(self->context, cached_identity_result_mismatched, nullptr, 0);
+  }
+
+  return true;
+}
+
+bool cached_identity_save(
+  cached_identity_t* self)
+{
+  identity_cache_record_seal(&self->record);
+  return self->callbacks->save(self->context, &self->record);
+}
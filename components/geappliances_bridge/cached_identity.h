@@ -0,0 +1,109 @@
+/*!
+ * @file
+ * @brief Restores the identity record at boot and checks it against the appliance.
+ *
+ * At boot the record saved by a previous boot is loaded and, if it is valid, the
+ * owner starts the bridge from it right away. The serial number is then read from
+ * the cached host in the background. Reads that fail or cannot be queued are
+ * retried after a delay without discarding the record. A different serial number means the appliance
+ * was replaced: the record is invalidated and saved before the owner is told, so
+ * that the next boot runs full autodiscovery.
+ *
+ * When the identity was not restored, the same background read captures the
+ * serial number so that the owner can save a new record.
+ */
+
+#ifndef cached_identity_h
+#define cached_identity_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "identity_cache.h"
+#include "tiny_timer.h"
+
+enum {
+  cached_identity_retry_delay = 5000
+};
+
+enum {
+  cached_identity_result_verified,
+  cached_identity_result_mismatched,
+  cached_identity_result_captured
+};
+typedef uint8_t cached_identity_result_t;
+
+typedef struct {
+  // Load the record saved by a previous boot. Returns false if there is none.
+  bool (*load)(void* context, identity_cache_record_t* record);
+  // Persist the record. Returns false if it could not be saved.
+  bool (*save)(void* context, const identity_cache_record_t* record);
+  // Queue a read of the host's serial number. Returns false if it could not be queued.
+  bool (*read_serial_number)(void* context, uint8_t address);
+  // The serial number was read. It is only passed along when it was captured.
+  void (*finished)(void* context, cached_identity_result_t result, const void* serial_number, uint8_t serial_number_size);
+} cached_identity_callbacks_t;
+
+typedef struct {
+  identity_cache_record_t record;
+  tiny_timer_group_t* timer_group;
+  tiny_timer_t timer;
+  const cached_identity_callbacks_t* callbacks;
+  void* context;
+  uint8_t address;
+  uint8_t state;
+  bool capturing;
+} cached_identity_t;
+
+/*!
+ * Initialize with no record.
+ */
+void cached_identity_init(
+  cached_identity_t* self,
+  tiny_timer_group_t* timer_group,
+  const cached_identity_callbacks_t* callbacks,
+  void* context);
+
+/*!
+ * Load the saved record. Returns true if it is valid.
+ */
+bool cached_identity_restore(
+  cached_identity_t* self);
+
+/*!
+ * The restored record, or the record to fill in before saving it.
+ */
+identity_cache_record_t* cached_identity_record(
+  cached_identity_t* self);
+
+/*!
+ * Start reading the serial number from the restored record's host to verify it.
+ */
+void cached_identity_verify(
+  cached_identity_t* self);
+
+/*!
+ * Start reading the serial number from a host so that a new record can be saved.
+ */
+void cached_identity_capture(
+  cached_identity_t* self,
+  uint8_t address);
+
+/*!
+ * Report the outcome of a serial number read. Returns true if it was the read
+ * this module is waiting for.
+ */
+bool cached_identity_read_finished(
+  cached_identity_t* self,
+  uint8_t address,
+  bool success,
+  const void* serial_number,
+  uint8_t serial_number_size);
+
+/*!
+ * Seal and persist the record after it has been filled in. Returns false if it
+ * could not be saved.
+ */
+bool cached_identity_save(
+  cached_identity_t* self);
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+ * @file
+ * @brief Set of known ERDs stored as one bit per dense ERD index.
+ */
+
+extern "C" {
+#include "erd_bitset.h"
+}
+
+#include <cstring>
+
+void erd_bitset_clear(
+  erd_bitset_t* self)
+{
+  memset(self->words, 0, sizeof(self->words));
+}
+
+bool erd_bitset_insert(
+  erd_bitset_t* self,
+  uint16_t index)
+{
+  uint32_t mask = UINT32_C(1) << (index % 32);
+  uint32_t* word = &self->words[index / 32];
+
+  if(*word & mask) {
+    return false;
+  }
+
+  *word |= mask;
+  return true;
+}
+
+bool erd_bitset_contains(
+  const erd_bitset_t* self,
+  uint16_t index)
+{
+  return (index < KNOWN_ERD_COUNT) && (self->words[index / 32] & (UINT32_C(1) << (index % 32)));
+}
+
+uint16_t erd_bitset_next(
+  const erd_bitset_t* self,
+  uint16_t from)
+{
+  if(from >= KNOWN_ERD_COUNT) {
+    return KNOWN_ERD_COUNT;
+  }
+
+  uint16_t word_index = from / 32;
+  uint32_t word = self->words[word_index] & (UINT32_MAX << (from % 32));
+
+  while(word == 0) {
+    if(++word_index >= erd_bitset_word_count) {
+      return KNOWN_ERD_COUNT;
+    }
+    word = self->words[word_index];
+  }
+
+  return static_cast<uint16_t>(word_index * 32 + __builtin_ctz(word));
+}
+
+uint16_t erd_bitset_count(
+  const erd_bitset_t* self)
+{
+  uint16_t count = 0;
+
+  for(uint16_t i = 0; i < erd_bitset_word_count; i++) {
+    count += static_cast<uint16_t>(__builtin_popcount(self->words[i]));
+  }
+
+  return count;
+}
@@ -0,0 +1,61 @@
+/*!
+ * @file
+ * @brief Set of known ERDs stored as one bit per dense ERD index.
+ *
+ * Indexes come from erdIndex() in erd_lists.h. Membership tests and inserts are
+ * constant time, and a full set takes KNOWN_ERD_COUNT bits no matter how many
+ * ERDs it holds. Iterating with erd_bitset_next visits ERDs in ascending order.
+ */
+
+#ifndef erd_bitset_h
+#define erd_bitset_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "erd_lists.h"
+
+enum {
+  erd_bitset_word_count = (KNOWN_ERD_COUNT + 31) / 32
+};
+
+typedef struct {
+  uint32_t words[erd_bitset_word_count];
+} erd_bitset_t;
+
+/*!
+ * Remove every ERD from the set.
+ */
+void erd_bitset_clear(
+  erd_bitset_t* self);
+
+/*!
+ * Add an ERD by its dense index, which must be below KNOWN_ERD_COUNT. Returns
+ * true if it was not already in the set.
+ */
+bool erd_bitset_insert(
+  erd_bitset_t* self,
+  uint16_t index);
+
+/*!
+ * Whether the ERD with the given dense index is in the set. UNKNOWN_ERD_INDEX
+ * never is.
+ */
+bool erd_bitset_contains(
+  const erd_bitset_t* self,
+  uint16_t index);
+
+/*!
+ * Smallest index in the set that is at least from, or KNOWN_ERD_COUNT if there
+ * is none.
+ */
+uint16_t erd_bitset_next(
+  const erd_bitset_t* self,
+  uint16_t from);
+
+/*!
+ * Number of ERDs in the set.
+ */
+uint16_t erd_bitset_count(
+  const erd_bitset_t* self);
+
+#endif
@@ -0,0 +1,343 @@
+/*!
+ * @file
+ * @brief Shares one GEA3 ERD client between every user of the bus by priority.
+ */
+
+extern "C" {
+#include "erd_request_arbiter.h"
+}
+
+#include <cstring>
+
+static erd_request_arbiter_t* arbiter_of(i_tiny_gea3_erd_client_t* _self)
+{
+  return reinterpret_cast<erd_request_arbiter_t*>(reinterpret_cast<erd_request_arbiter_client_t*>(_self)->arbiter);
+}
+
+static erd_request_arbiter_request_t* free_request(erd_request_arbiter_t* self)
+{
+  for(uint8_t i = 0; i < erd_request_arbiter_max_outstanding; i++) {
+    if(!self->requests[i].in_use) {
+      return &self->requests[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static erd_request_arbiter_request_t* find_request(erd_request_arbiter_t* self, tiny_gea3_erd_client_request_id_t request_id)
+{
+  for(uint8_t i = 0; i < erd_request_arbiter_max_outstanding; i++) {
+    if(self->requests[i].in_use && (self->requests[i].request_id == request_id)) {
+      return &self->requests[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static bool under_limit(erd_request_arbiter_t* self, erd_request_arbiter_priority_t priority)
+{
+  return self->outstanding[priority] < self->configuration->limits[priority];
+}
+
+static bool refuse(erd_request_arbiter_t* self, erd_request_arbiter_priority_t priority)
+{
+  self->counters[priority].refused++;
+  self->refused[priority] = true;
+  return false;
+}
+
+static void accept(erd_request_arbiter_t* self, erd_request_arbiter_priority_t priority)
+{
+  self->counters[priority].accepted++;
+  self->outstanding[priority]++;
+}
+
+static void track(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_request_t* request,
+  erd_request_arbiter_priority_t priority,
+  tiny_gea3_erd_client_request_id_t request_id)
+{
+  request->request_id = request_id;
+  request->priority = priority;
+  request->in_use = true;
+  request->abandoned = false;
+  accept(self, priority);
+}
+
+static void count_finished(erd_request_arbiter_t* self, erd_request_arbiter_priority_t priority, bool success)
+{
+  if(success) {
+    self->counters[priority].completed++;
+  }
+  else {
+    self->counters[priority].failed++;
+  }
+}
+
+static void finish(erd_request_arbiter_t* self, erd_request_arbiter_priority_t priority, bool success)
+{
+  if(self->outstanding[priority] > 0) {
+    self->outstanding[priority]--;
+  }
+
+  count_finished(self, priority, success);
+}
+
+static void finish_request(erd_request_arbiter_t* self, tiny_gea3_erd_client_request_id_t request_id, bool success)
+{
+  erd_request_arbiter_request_t* request = find_request(self, request_id);
+
+  // Responses that arrive after their request has finished are not charged again
+  if(request) {
+    request->in_use = false;
+
+    // An abandoned request already gave its slot back
+    if(request->abandoned) {
+      self->abandoned[request->priority]--;
+      count_finished(self, request->priority, success);
+    }
+    else {
+      finish(self, request->priority, success);
+    }
+  }
+}
+
+// Every finished request frees space in the ERD client's queue, so any class that
+// refused a request may be able to take it now. Higher priorities are told first.
+static void notify_ready(erd_request_arbiter_t* self)
+{
+  for(uint8_t priority = 0; priority < erd_request_arbiter_priority_count; priority++) {
+    if(self->refused[priority] && under_limit(self, priority)) {
+      self->refused[priority] = false;
+      tiny_event_publish(&self->on_ready[priority], nullptr);
+    }
+  }
+}
+
+// Subscription requests are answered in order, so an answer is for the oldest one
+static void finish_subscription(erd_request_arbiter_t* self, bool success)
+{
+  if(self->stale_subscriptions > 0) {
+    self->stale_subscriptions--;
+  }
+
+  finish(self, erd_request_arbiter_priority_subscription, success);
+}
+
+static void watch_subscriptions(erd_request_arbiter_t* self);
+
+// Requests that were already outstanding at the previous timeout have had a whole timeout
+// to be answered, so the ERD client is not going to answer them
+static void subscription_timeout_expired(void* context)
+{
+  auto self = reinterpret_cast<erd_request_arbiter_t*>(context);
+  auto priority = erd_request_arbiter_priority_subscription;
+
+  while(self->stale_subscriptions > 0) {
+    finish_subscription(self, false);
+  }
+
+  self->stale_subscriptions = self->outstanding[priority];
+  watch_subscriptions(self);
+  notify_ready(self);
+}
+
+static void watch_subscriptions(erd_request_arbiter_t* self)
+{
+  if((self->outstanding[erd_request_arbiter_priority_subscription] > 0) &&
+    !tiny_timer_is_running(self->timer_group, &self->subscription_timer)) {
+    tiny_timer_start(
+      self->timer_group,
+      &self->subscription_timer,
+      self->configuration->subscription_timeout,
+      self,
+      subscription_timeout_expired);
+  }
+}
+
+static bool read(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd)
+{
+  auto self = arbiter_of(_self);
+  auto priority = reinterpret_cast<erd_request_arbiter_client_t*>(_self)->priority;
+  auto request = free_request(self);
+
+  if(!request || !under_limit(self, priority) ||
+    !tiny_gea3_erd_client_read(self->erd_client, request_id, address, erd)) {
+    return refuse(self, priority);
+  }
+
+  track(self, request, priority, *request_id);
+  return true;
+}
+
+static bool write(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t data_size)
+{
+  auto self = arbiter_of(_self);
+  auto priority = erd_request_arbiter_priority_control;
+  auto request = free_request(self);
+
+  if(!request || !under_limit(self, priority) ||
+    !tiny_gea3_erd_client_write(self->erd_client, request_id, address, erd, data, data_size)) {
+    return refuse(self, priority);
+  }
+
+  track(self, request, priority, *request_id);
+  return true;
+}
+
+static bool subscribe(i_tiny_gea3_erd_client_t* _self, uint8_t address)
+{
+  auto self = arbiter_of(_self);
+  auto priority = erd_request_arbiter_priority_subscription;
+
+  if(!under_limit(self, priority) || !tiny_gea3_erd_client_subscribe(self->erd_client, address)) {
+    return refuse(self, priority);
+  }
+
+  accept(self, priority);
+  watch_subscriptions(self);
+  return true;
+}
+
+static bool retain_subscription(i_tiny_gea3_erd_client_t* _self, uint8_t address)
+{
+  auto self = arbiter_of(_self);
+  auto priority = erd_request_arbiter_priority_subscription;
+
+  if(!under_limit(self, priority) || !tiny_gea3_erd_client_retain_subscription(self->erd_client, address)) {
+    return refuse(self, priority);
+  }
+
+  accept(self, priority);
+  watch_subscriptions(self);
+  return true;
+}
+
+static i_tiny_event_t* on_activity(i_tiny_gea3_erd_client_t* _self)
+{
+  return tiny_gea3_erd_client_on_activity(arbiter_of(_self)->erd_client);
+}
+
+static const i_tiny_gea3_erd_client_api_t api = {
+  read,
+  write,
+  subscribe,
+  retain_subscription,
+  on_activity
+};
+
+static void erd_client_activity(void* context, const void* _args)
+{
+  auto self = reinterpret_cast<erd_request_arbiter_t*>(context);
+  auto args = reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(_args);
+
+  switch(args->type) {
+    case tiny_gea3_erd_client_activity_type_read_completed:
+      finish_request(self, args->read_completed.request_id, true);
+      break;
+
+    case tiny_gea3_erd_client_activity_type_read_failed:
+      finish_request(self, args->read_failed.request_id, false);
+      break;
+
+    case tiny_gea3_erd_client_activity_type_write_completed:
+      finish_request(self, args->write_completed.request_id, true);
+      break;
+
+    case tiny_gea3_erd_client_activity_type_write_failed:
+      finish_request(self, args->write_failed.request_id, false);
+      break;
+
+    // Subscription requests have no request ID; the client answers them in order
+    case tiny_gea3_erd_client_activity_type_subscription_added_or_retained:
+      finish_subscription(self, true);
+      break;
+
+    case tiny_gea3_erd_client_activity_type_subscribe_failed:
+      finish_subscription(self, false);
+      break;
+
+    default:
+      return;
+  }
+
+  notify_ready(self);
+}
+
+void erd_request_arbiter_init(
+  erd_request_arbiter_t* self,
+  tiny_timer_group_t* timer_group,
+  i_tiny_gea3_erd_client_t* erd_client,
+  const erd_request_arbiter_configuration_t* configuration)
+{
+  self->timer_group = timer_group;
+  self->erd_client = erd_client;
+  self->configuration = configuration;
+  memset(self->counters, 0, sizeof(self->counters));
+  memset(self->requests, 0, sizeof(self->requests));
+  memset(self->outstanding, 0, sizeof(self->outstanding));
+  memset(self->abandoned, 0, sizeof(self->abandoned));
+  memset(self->refused, 0, sizeof(self->refused));
+  self->stale_subscriptions = 0;
+
+  for(uint8_t priority = 0; priority < erd_request_arbiter_priority_count; priority++) {
+    self->clients[priority].interface.api = &api;
+    self->clients[priority].arbiter = self;
+    self->clients[priority].priority = priority;
+    tiny_event_init(&self->on_ready[priority]);
+  }
+
+  tiny_event_subscription_init(&self->erd_client_activity_subscription, self, erd_client_activity);
+  tiny_event_subscribe(tiny_gea3_erd_client_on_activity(erd_client), &self->erd_client_activity_subscription);
+}
+
+i_tiny_gea3_erd_client_t* erd_request_arbiter_client(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority)
+{
+  return &self->clients[priority].interface;
+}
+
+i_tiny_event_t* erd_request_arbiter_on_ready(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority)
+{
+  return &self->on_ready[priority].interface;
+}
+
+void erd_request_arbiter_abandon(
+  erd_request_arbiter_t* self,
+  tiny_gea3_erd_client_request_id_t request_id)
+{
+  erd_request_arbiter_request_t* request = find_request(self, request_id);
+
+  if(!request || request->abandoned ||
+    (self->abandoned[request->priority] >= self->configuration->limits[request->priority])) {
+    return;
+  }
+
+  request->abandoned = true;
+  self->abandoned[request->priority]++;
+  self->outstanding[request->priority]--;
+  notify_ready(self);
+}
+
+const erd_request_arbiter_counters_t* erd_request_arbiter_counters(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority)
+{
+  return &self->counters[priority];
+}
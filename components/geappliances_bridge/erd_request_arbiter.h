@@ -0,0 +1,133 @@
+/*!
+ * @file
+ * @brief Shares one GEA3 ERD client between every user of the bus by priority.
+ *
+ * Each priority class gets a limit on the requests it may have outstanding in the
+ * ERD client's queue at once, so bulk reads cannot fill the queue ahead of
+ * writes and subscription maintenance. A request over its class limit, or one the
+ * ERD client cannot queue, is refused; the class's ready event is published once
+ * it can take another request so the caller knows when to try again.
+ *
+ * A caller that stops waiting for a request can abandon it. The ERD client still
+ * works through it, but it no longer counts against its class's limit, so a slow
+ * host does not hold the class's slots for the ERD client's whole retry window.
+ * Each class may leave at most its limit of abandoned requests in the queue.
+ *
+ * Subscribe and retain requests have no request ID and are answered in order. The
+ * ERD client does not answer every one of them (a retain may simply be dropped),
+ * so a subscription request still unanswered after one to two subscription
+ * timeouts gives its slot back and is counted as failed.
+ *
+ * Callers use the ERD client interface returned by erd_request_arbiter_client.
+ * Its reads are charged to the priority class it was created for, while writes
+ * always count as control traffic and subscribe/retain requests as subscription
+ * traffic. Activity is published on the underlying ERD client's event.
+ */
+
+#ifndef erd_request_arbiter_h
+#define erd_request_arbiter_h
+
+#include "i_tiny_gea3_erd_client.h"
+#include "tiny_event.h"
+#include "tiny_timer.h"
+
+enum {
+  erd_request_arbiter_priority_control, // Writes requested over MQTT
+  erd_request_arbiter_priority_subscription, // Subscribing and retaining subscriptions
+  erd_request_arbiter_priority_identity, // Autodiscovery and device ID reads
+  erd_request_arbiter_priority_poll, // Polling reads
+  erd_request_arbiter_priority_count
+};
+typedef uint8_t erd_request_arbiter_priority_t;
+
+enum {
+  erd_request_arbiter_max_outstanding = 32
+};
+
+typedef struct {
+  // Requests of each class that may wait in the ERD client's queue at once
+  uint8_t limits[erd_request_arbiter_priority_count];
+
+  // How long the ERD client may take to answer a subscribe or retain request
+  tiny_timer_ticks_t subscription_timeout;
+} erd_request_arbiter_configuration_t;
+
+typedef struct {
+  uint32_t accepted;
+  uint32_t refused;
+  uint32_t completed;
+  uint32_t failed;
+} erd_request_arbiter_counters_t;
+
+typedef struct {
+  i_tiny_gea3_erd_client_t interface;
+  void* arbiter;
+  erd_request_arbiter_priority_t priority;
+} erd_request_arbiter_client_t;
+
+typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  erd_request_arbiter_priority_t priority;
+  bool in_use;
+  bool abandoned;
+} erd_request_arbiter_request_t;
+
+typedef struct {
+  tiny_timer_group_t* timer_group;
+  i_tiny_gea3_erd_client_t* erd_client;
+  const erd_request_arbiter_configuration_t* configuration;
+  tiny_event_subscription_t erd_client_activity_subscription;
+  tiny_timer_t subscription_timer;
+  erd_request_arbiter_client_t clients[erd_request_arbiter_priority_count];
+  tiny_event_t on_ready[erd_request_arbiter_priority_count];
+  erd_request_arbiter_counters_t counters[erd_request_arbiter_priority_count];
+  erd_request_arbiter_request_t requests[erd_request_arbiter_max_outstanding];
+  uint8_t outstanding[erd_request_arbiter_priority_count];
+  uint8_t abandoned[erd_request_arbiter_priority_count];
+  bool refused[erd_request_arbiter_priority_count];
+  // Subscription requests that were already outstanding at the last subscription timeout
+  uint8_t stale_subscriptions;
+} erd_request_arbiter_t;
+
+/*!
+ * Initialize the arbiter in front of an ERD client. Nothing else may send
+ * requests through the ERD client directly.
+ */
+void erd_request_arbiter_init(
+  erd_request_arbiter_t* self,
+  tiny_timer_group_t* timer_group,
+  i_tiny_gea3_erd_client_t* erd_client,
+  const erd_request_arbiter_configuration_t* configuration);
+
+/*!
+ * ERD client interface whose reads are charged to the given priority class.
+ */
+i_tiny_gea3_erd_client_t* erd_request_arbiter_client(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority);
+
+/*!
+ * Published (with no arguments) when a class that refused a request can take
+ * another one.
+ */
+i_tiny_event_t* erd_request_arbiter_on_ready(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority);
+
+/*!
+ * Stop charging a read or write to its class because the caller no longer waits
+ * for it. Ignored once the class has its limit of abandoned requests queued, or
+ * if the request has already finished.
+ */
+void erd_request_arbiter_abandon(
+  erd_request_arbiter_t* self,
+  tiny_gea3_erd_client_request_id_t request_id);
+
+/*!
+ * Request counts for a priority class since initialization.
+ */
+const erd_request_arbiter_counters_t* erd_request_arbiter_counters(
+  erd_request_arbiter_t* self,
+  erd_request_arbiter_priority_t priority);
+
+#endif
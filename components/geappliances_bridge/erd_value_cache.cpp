@@ -0,0 +1,294 @@
+/*!
+ * @file
+ * @brief Flat store of the last published value of each polled ERD.
+ */
+
+extern "C" {
+#include "erd_value_cache.h"
+}
+
+#include <cstring>
+#include "erd_lists.h"
+
+enum {
+  initial_entry_capacity = 32,
+  initial_arena_capacity = 256
+};
+
+// 32-bit FNV-1a
+static uint32_t digest_of(const void* data, uint8_t size)
+{
+  auto bytes = reinterpret_cast<const uint8_t*>(data);
+  uint32_t hash = 2166136261U;
+
+  for(uint8_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+static uint8_t slot_size(erd_value_cache_t* self, uint8_t size)
+{
+  return (self->mode == erd_value_cache_mode_digest) ? sizeof(uint32_t) : size;
+}
+
+static uint16_t grown_capacity(uint16_t capacity, uint32_t needed, uint16_t initial)
+{
+  uint32_t grown = capacity ? capacity : initial;
+
+  while(grown < needed) {
+    grown *= 2;
+  }
+
+  return grown > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(grown);
+}
+
+// Position of the ERD in the sorted index, or where it would be inserted
+static uint16_t lower_bound(erd_value_cache_t* self, uint16_t erd_index)
+{
+  uint16_t low = 0;
+  uint16_t high = self->entry_count;
+
+  while(low < high) {
+    uint16_t middle = (low + high) / 2;
+    if(self->entries[middle].erd_index < erd_index) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  return low;
+}
+
+static erd_value_cache_entry_t* find(erd_value_cache_t* self, uint16_t erd_index)
+{
+  uint16_t position = lower_bound(self, erd_index);
+
+  if((position < self->entry_count) && (self->entries[position].erd_index == erd_index)) {
+    return &self->entries[position];
+  }
+
+  return nullptr;
+}
+
+static bool allocate_value(erd_value_cache_t* self, erd_value_cache_entry_t* entry, uint8_t size)
+{
+  uint32_t needed = static_cast<uint32_t>(self->arena_used) + slot_size(self, size);
+
+  if(needed > UINT16_MAX) {
+    return false;
+  }
+
+  if(needed > self->arena_capacity) {
+    if(self->sealed) {
+      return false;
+    }
+
+    uint16_t capacity = grown_capacity(self->arena_capacity, needed, initial_arena_capacity);
+    uint8_t* arena = new uint8_t[capacity];
+    if(self->arena_used) {
+      memcpy(arena, self->arena, self->arena_used);
+    }
+    delete[] self->arena;
+    self->arena = arena;
+    self->arena_capacity = capacity;
+  }
+
+  entry->offset = self->arena_used;
+  entry->size = size;
+  entry->valid = false;
+  self->arena_used = static_cast<uint16_t>(needed);
+  return true;
+}
+
+static erd_value_cache_entry_t* insert(erd_value_cache_t* self, uint16_t erd_index, uint8_t size)
+{
+  if(self->entry_count == UINT16_MAX) {
+    return nullptr;
+  }
+
+  if(self->entry_count == self->entry_capacity) {
+    if(self->sealed) {
+      return nullptr;
+    }
+
+    uint16_t capacity = grown_capacity(self->entry_capacity, self->entry_count + 1U, initial_entry_capacity);
+    auto entries = new erd_value_cache_entry_t[capacity];
+    if(self->entry_count) {
+      memcpy(entries, self->entries, self->entry_count * sizeof(erd_value_cache_entry_t));
+    }
+    delete[] self->entries;
+    self->entries = entries;
+    self->entry_capacity = capacity;
+  }
+
+  uint16_t position = lower_bound(self, erd_index);
+  erd_value_cache_entry_t* entry = &self->entries[position];
+  memmove(entry + 1, entry, (self->entry_count - position) * sizeof(erd_value_cache_entry_t));
+  entry->erd_index = erd_index;
+
+  if(!allocate_value(self, entry, size)) {
+    memmove(entry, entry + 1, (self->entry_count - position) * sizeof(erd_value_cache_entry_t));
+    return nullptr;
+  }
+
+  self->entry_count++;
+  return entry;
+}
+
+void erd_value_cache_init(
+  erd_value_cache_t* self,
+  erd_value_cache_mode_t mode)
+{
+  memset(self, 0, sizeof(*self));
+  self->mode = mode;
+}
+
+// A sealed cache keeps its index and arena in one block that starts with the index
+static void release(erd_value_cache_t* self)
+{
+  if(self->sealed) {
+    delete[] reinterpret_cast<uint8_t*>(self->entries);
+  }
+  else {
+    delete[] self->entries;
+    delete[] self->arena;
+  }
+}
+
+void erd_value_cache_destroy(
+  erd_value_cache_t* self)
+{
+  release(self);
+  erd_value_cache_init(self, self->mode);
+}
+
+// Entry with room for a value of the given size, or NULL if the ERD cannot be cached
+static erd_value_cache_entry_t* reserved_entry(erd_value_cache_t* self, tiny_erd_t erd, uint8_t size)
+{
+  uint16_t erd_index = erdIndex(erd);
+
+  if(erd_index == UNKNOWN_ERD_INDEX) {
+    return nullptr;
+  }
+
+  erd_value_cache_entry_t* entry = find(self, erd_index);
+  if(!entry) {
+    return insert(self, erd_index, size);
+  }
+
+  if(entry->size != size) {
+    if(self->mode == erd_value_cache_mode_digest) {
+      // A digest fits in its slot whatever the size of the value
+      entry->size = size;
+      entry->valid = false;
+    }
+    else if(!allocate_value(self, entry, size)) {
+      return nullptr;
+    }
+  }
+
+  return entry;
+}
+
+bool erd_value_cache_reserve(
+  erd_value_cache_t* self,
+  tiny_erd_t erd,
+  uint8_t size)
+{
+  return reserved_entry(self, erd, size) != nullptr;
+}
+
+bool erd_value_cache_update(
+  erd_value_cache_t* self,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t size)
+{
+  erd_value_cache_entry_t* entry = reserved_entry(self, erd, size);
+
+  if(!entry) {
+    return true;
+  }
+
+  uint32_t digest;
+  if(self->mode == erd_value_cache_mode_digest) {
+    digest = digest_of(data, size);
+    data = &digest;
+    size = sizeof(digest);
+  }
+  else if(size == 0) {
+    bool changed = !entry->valid;
+    entry->valid = true;
+    return changed;
+  }
+
+  uint8_t* value = &self->arena[entry->offset];
+
+  if(entry->valid && (memcmp(value, data, size) == 0)) {
+    return false;
+  }
+
+  memcpy(value, data, size);
+  entry->valid = true;
+  return true;
+}
+
+void erd_value_cache_invalidate(
+  erd_value_cache_t* self)
+{
+  for(uint16_t i = 0; i < self->entry_count; i++) {
+    self->entries[i].valid = false;
+  }
+}
+
+void erd_value_cache_seal(
+  erd_value_cache_t* self,
+  uint16_t spare_entries,
+  uint16_t spare_bytes)
+{
+  if(self->sealed) {
+    return;
+  }
+
+  uint32_t entry_capacity = static_cast<uint32_t>(self->entry_count) + spare_entries;
+  uint32_t arena_capacity = static_cast<uint32_t>(self->arena_used) + spare_bytes;
+  entry_capacity = entry_capacity > UINT16_MAX ? UINT16_MAX : entry_capacity;
+  arena_capacity = arena_capacity > UINT16_MAX ? UINT16_MAX : arena_capacity;
+
+  size_t entries_size = entry_capacity * sizeof(erd_value_cache_entry_t);
+  uint8_t* block = nullptr;
+
+  if(entries_size + arena_capacity) {
+    block = new uint8_t[entries_size + arena_capacity];
+    if(self->entry_count) {
+      memcpy(block, self->entries, self->entry_count * sizeof(erd_value_cache_entry_t));
+    }
+    if(self->arena_used) {
+      memcpy(block + entries_size, self->arena, self->arena_used);
+    }
+  }
+
+  release(self);
+  self->entries = reinterpret_cast<erd_value_cache_entry_t*>(block);
+  self->arena = block ? block + entries_size : nullptr;
+  self->entry_capacity = static_cast<uint16_t>(entry_capacity);
+  self->arena_capacity = static_cast<uint16_t>(arena_capacity);
+  self->sealed = true;
+}
+
+void erd_value_cache_clear(
+  erd_value_cache_t* self)
+{
+  if(self->sealed) {
+    erd_value_cache_destroy(self);
+    return;
+  }
+
+  self->entry_count = 0;
+  self->arena_used = 0;
+}
@@ -0,0 +1,112 @@
+/*!
+ * @file
+ * @brief Flat store of the last published value of each polled ERD.
+ *
+ * Values are kept back to back in one arena and found through an index of
+ * (dense ERD index, offset, size) entries sorted by ERD. Space for an ERD is
+ * reserved the first time it is seen, so the arena ends up sized from the payload
+ * sizes found during discovery; after that, updates compare and copy in place and
+ * nothing is allocated. A value whose size changes is moved to the end of the
+ * arena and its old bytes stay unused until the cache is cleared.
+ *
+ * In digest mode each slot holds a 32-bit FNV-1a hash of the value instead of a
+ * copy, so every ERD costs 4 bytes however large it is. A size change is always
+ * detected. A change to a value of the same size is missed only if the two values
+ * hash alike, which happens for about one change in 4 billion. The missed value
+ * is published with that ERD's next change.
+ *
+ * Sealing moves the index and the arena into one block sized from what is in use
+ * plus some headroom, and freezes that size. A sealed cache never allocates; once
+ * the headroom is used up, an ERD it has no slot for is not cached and every
+ * update of it counts as a change.
+ */
+
+#ifndef erd_value_cache_h
+#define erd_value_cache_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_erd.h"
+
+enum {
+  erd_value_cache_mode_full_copy,
+  erd_value_cache_mode_digest
+};
+typedef uint8_t erd_value_cache_mode_t;
+
+typedef struct {
+  uint16_t erd_index;
+  uint16_t offset;
+  uint8_t size;
+  bool valid;
+} erd_value_cache_entry_t;
+
+typedef struct {
+  erd_value_cache_entry_t* entries;
+  uint8_t* arena;
+  uint16_t entry_count;
+  uint16_t entry_capacity;
+  uint16_t arena_used;
+  uint16_t arena_capacity;
+  erd_value_cache_mode_t mode;
+  bool sealed;
+} erd_value_cache_t;
+
+/*!
+ * Initialize an empty cache that keeps full copies or digests of the values.
+ * Nothing is allocated until space is reserved.
+ */
+void erd_value_cache_init(
+  erd_value_cache_t* self,
+  erd_value_cache_mode_t mode);
+
+/*!
+ * Free the index and the arena.
+ */
+void erd_value_cache_destroy(
+  erd_value_cache_t* self);
+
+/*!
+ * Make room for an ERD's value without storing one. Returns false for ERDs
+ * without a dense index, which are never cached.
+ */
+bool erd_value_cache_reserve(
+  erd_value_cache_t* self,
+  tiny_erd_t erd,
+  uint8_t size);
+
+/*!
+ * Store an ERD's latest value. Returns true if it differs from the cached value
+ * or nothing was cached for the ERD yet.
+ */
+bool erd_value_cache_update(
+  erd_value_cache_t* self,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t size);
+
+/*!
+ * Forget every value but keep the layout, so the next update of each ERD counts
+ * as a change.
+ */
+void erd_value_cache_invalidate(
+  erd_value_cache_t* self);
+
+/*!
+ * Move everything reserved so far into one block with room for spare_entries
+ * more ERDs and spare_bytes more of values. Nothing is allocated by the cache
+ * after this until it is cleared.
+ */
+void erd_value_cache_seal(
+  erd_value_cache_t* self,
+  uint16_t spare_entries,
+  uint16_t spare_bytes);
+
+/*!
+ * Forget every ERD. The memory is kept for the next discovery unless the cache
+ * was sealed, in which case it is freed and the cache can grow again.
+ */
+void erd_value_cache_clear(
+  erd_value_cache_t* self);
+
+#endif
@@ -0,0 +1,50 @@
+#include "esphome_bus_task.h"
+
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Above the ESPHome loop task so that loop stalls cannot delay the UARTs
+static constexpr UBaseType_t BUS_TASK_PRIORITY = 6;
+static constexpr uint32_t BUS_TASK_STACK_SIZE = 2048;
+// Not pinned, so on dual-core chips the bus task runs on whichever core the loop task is not using
+static constexpr BaseType_t BUS_TASK_CORE = tskNO_AFFINITY;
+
+static void bus_task(void* context)
+{
+  auto self = static_cast<esphome_bus_task_t*>(context);
+
+  while (true) {
+    for (uint8_t i = 0; i < self->adapter_count; i++) {
+      esphome_uart_adapter_pump(self->adapters[i]);
+    }
+    vTaskDelay(1);
+  }
+}
+#endif
+
+extern "C" void esphome_bus_task_add_adapter(
+  esphome_bus_task_t* self,
+  esphome_uart_adapter_t* adapter)
+{
+  if (self->adapter_count < esphome_bus_task_max_adapters) {
+    self->adapters[self->adapter_count++] = adapter;
+  }
+}
+
+extern "C" bool esphome_bus_task_start(
+  esphome_bus_task_t* self)
+{
+#ifdef USE_ESP32
+  TaskHandle_t handle;
+  if (xTaskCreatePinnedToCore(bus_task, "gea_bus", BUS_TASK_STACK_SIZE, self, BUS_TASK_PRIORITY, &handle,
+                              BUS_TASK_CORE) != pdPASS) {
+    return false;
+  }
+  self->handle = handle;
+  return true;
+#else
+  (void)self;
+  return false;
+#endif
+}
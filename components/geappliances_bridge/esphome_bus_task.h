@@ -0,0 +1,34 @@
+#pragma once
+
+#include "esphome_uart_adapter.h"
+
+enum {
+  esphome_bus_task_max_adapters = 2
+};
+
+typedef struct {
+  esphome_uart_adapter_t* adapters[esphome_bus_task_max_adapters];
+  uint8_t adapter_count;
+  void* handle;
+} esphome_bus_task_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Add a UART adapter, initialized with a bus pump, to be serviced by the bus task.
+ */
+void esphome_bus_task_add_adapter(
+  esphome_bus_task_t* self,
+  esphome_uart_adapter_t* adapter);
+
+/*!
+ * Start the bus task. Returns false if the task could not be created.
+ */
+bool esphome_bus_task_start(
+  esphome_bus_task_t* self);
+
+#ifdef __cplusplus
+}
+#endif
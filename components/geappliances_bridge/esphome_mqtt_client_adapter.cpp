@@ -9,38 +9,49 @@ extern "C" {
 }
 
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <cctype>
-#include <deque>
 
 static const char *const TAG = "geappliances_bridge.mqtt";
 
-// Maximum number of pending updates to queue (prevent memory exhaustion)
-static constexpr size_t MAX_PENDING_UPDATES = 100;
+// geappliances/<device_id>/host/0xNN/erd/0xNNNN/write_result
+static constexpr size_t MAX_TOPIC_LENGTH =
+  sizeof("geappliances/") - 1 + ESPHOME_MQTT_CLIENT_ADAPTER_MAX_DEVICE_ID_LENGTH +
+  sizeof("/host/0xNN") - 1 + sizeof("/erd/0xNNNN/write_result") - 1;
 
-static std::string build_topic(esphome_mqtt_client_adapter_t* self, const char* suffix)
+// host is nullptr for the primary host, whose ERDs live in the root namespace. The
+// topic is built in the adapter's reserved string, which is overwritten by the next call.
+static const std::string& build_topic(esphome_mqtt_client_adapter_t* self, esphome_mqtt_client_host_t* host, const char* suffix)
 {
-  return std::string("geappliances/") + *self->device_id + suffix;
+  char topic[MAX_TOPIC_LENGTH + 1];
+  if (host != nullptr) {
+    snprintf(topic, sizeof(topic), "geappliances/%s/host/0x%02x%s", self->device_id, host->address, suffix);
+  } else {
+    snprintf(topic, sizeof(topic), "geappliances/%s%s", self->device_id, suffix);
+  }
+  self->topic->assign(topic);
+  return *self->topic;
 }
 
-static void register_erd(i_mqtt_client_t* _self, tiny_erd_t erd)
+static void register_erd_in_namespace(
+  esphome_mqtt_client_adapter_t* self,
+  esphome_mqtt_client_host_t* host,
+  tiny_event_t* write_request_event,
+  tiny_erd_t erd)
 {
-  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
-  
   char topic_suffix[32];
-  snprintf(topic_suffix, sizeof(topic_suffix), "/erd/0x%04x", erd);
-  
-  std::string value_topic = build_topic(self, (std::string(topic_suffix) + "/value").c_str());
-  std::string write_topic = build_topic(self, (std::string(topic_suffix) + "/write").c_str());
+  snprintf(topic_suffix, sizeof(topic_suffix), "/erd/0x%04x/write", erd);
   
   ESP_LOGD(TAG, "Registered ERD 0x%04X", erd);
   
-  // Subscribe to write topic for this ERD
+  // Subscribe to write topic for this ERD. ESPHome keeps its own copy of the topic and
+  // callback, so registering allocates; that only happens during discovery.
   auto mqtt_client = esphome::mqtt::global_mqtt_client;
   if (mqtt_client != nullptr) {
     mqtt_client->subscribe(
-      write_topic,
-      [self, erd](const std::string &topic, const std::string &payload) {
+      build_topic(self, host, topic_suffix),
+      [write_request_event, erd](const std::string &topic, const std::string &payload) {
         // Parse hex string payload and trigger write request
         ESP_LOGD(TAG, "Write request for ERD 0x%04X: %s", erd, payload.c_str());
         
@@ -50,9 +61,15 @@ static void register_erd(i_mqtt_client_t* _self, tiny_erd_t erd)
           return;
         }
         
+        // Validate data size
+        size_t size = payload.length() / 2;
+        if (size == 0 || size > UINT8_MAX) {
+          ESP_LOGW(TAG, "Invalid data size for ERD 0x%04X: %zu bytes", erd, size);
+          return;
+        }
+        
         // Convert hex string to bytes
-        std::vector<uint8_t> data;
-        data.reserve(payload.length() / 2);
+        uint8_t data[UINT8_MAX];
         for (size_t i = 0; i < payload.length(); i += 2) {
           char byte_str[3] = {payload[i], payload[i+1], '\0'};
           // Validate hex characters
@@ -61,97 +78,127 @@ static void register_erd(i_mqtt_client_t* _self, tiny_erd_t erd)
             ESP_LOGW(TAG, "Invalid hex characters in payload for ERD 0x%04X at position %zu", erd, i);
             return;
           }
-          data.push_back(static_cast<uint8_t>(strtol(byte_str, nullptr, 16)));
-        }
-        
-        // Validate data size
-        if (data.size() == 0 || data.size() > 255) {
-          ESP_LOGW(TAG, "Invalid data size for ERD 0x%04X: %zu bytes", erd, data.size());
-          return;
+          data[i / 2] = static_cast<uint8_t>(strtol(byte_str, nullptr, 16));
         }
         
         // Publish write request event
         mqtt_client_on_write_request_args_t args = {
           .erd = erd,
-          .size = static_cast<uint8_t>(data.size()),
-          .value = data.data()
+          .size = static_cast<uint8_t>(size),
+          .value = data
         };
-        tiny_event_publish(&self->on_write_request_event, &args);
+        tiny_event_publish(write_request_event, &args);
       },
       2  // QoS 2
     );
   }
 }
 
-static void update_erd(i_mqtt_client_t* _self, tiny_erd_t erd, const void* value, uint8_t size)
+static void publish_erd_value(
+  esphome_mqtt_client_adapter_t* self,
+  esphome_mqtt_client_host_t* host,
+  tiny_erd_t erd,
+  const uint8_t* bytes,
+  uint8_t size)
 {
-  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
-  
-  // Validate inputs
-  if (value == nullptr || size == 0) {
-    ESP_LOGW(TAG, "Invalid ERD update: null value or zero size for ERD 0x%04X", erd);
-    return;
-  }
-  
+  static const char hex_digits[] = "0123456789abcdef";
+
   char topic_suffix[32];
   snprintf(topic_suffix, sizeof(topic_suffix), "/erd/0x%04x/value", erd);
-  std::string topic = build_topic(self, topic_suffix);
-  
+
   // Convert binary data to hex string
-  std::string hex_payload;
-  hex_payload.reserve(size * 2);
-  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(value);
+  char hex_payload[2 * UINT8_MAX];
   for (uint8_t i = 0; i < size; i++) {
-    char hex[3];
-    snprintf(hex, sizeof(hex), "%02x", bytes[i]);
-    hex_payload += hex;
+    hex_payload[2 * i] = hex_digits[bytes[i] >> 4];
+    hex_payload[2 * i + 1] = hex_digits[bytes[i] & 0x0F];
+  }
+
+  esphome::mqtt::global_mqtt_client->publish(build_topic(self, host, topic_suffix), hex_payload, 2 * size, 2, true);  // QoS 2, retain
+}
+
+static void update_erd_in_namespace(
+  esphome_mqtt_client_adapter_t* self,
+  esphome_mqtt_client_host_t* host,
+  tiny_erd_t erd,
+  const void* value,
+  uint8_t size)
+{
+  // Validate inputs
+  if (value == nullptr || size == 0) {
+    ESP_LOGW(TAG, "Invalid ERD update: null value or zero size for ERD 0x%04X", erd);
+    return;
   }
   
   // Publish to MQTT or queue if not connected
   auto mqtt_client = esphome::mqtt::global_mqtt_client;
   if (mqtt_client != nullptr && mqtt_client->is_connected()) {
-    mqtt_client->publish(topic, hex_payload, 2, true);  // QoS 2, retain
+    publish_erd_value(self, host, erd, reinterpret_cast<const uint8_t*>(value), size);
+  } else if (self->pending_updates == nullptr) {
+    ESP_LOGW(TAG, "Pending updates queue not initialized, dropping ERD update for 0x%04X", erd);
+  } else if (self->pending_update_count >= ESPHOME_MQTT_CLIENT_ADAPTER_MAX_PENDING_UPDATES ||
+             self->pending_value_bytes + size > ESPHOME_MQTT_CLIENT_ADAPTER_PENDING_VALUE_BYTES) {
+    ESP_LOGW(TAG, "Pending update queue full, dropping ERD update for 0x%04X", erd);
   } else {
     // Queue the update for later when MQTT connects
-    if (self->pending_updates != nullptr && self->pending_updates->size() < MAX_PENDING_UPDATES) {
-      self->pending_updates->push_back({topic, hex_payload});
-      ESP_LOGD(TAG, "MQTT not connected, queued ERD update for 0x%04X (queue size: %zu)", 
-               erd, self->pending_updates->size());
-    } else if (self->pending_updates == nullptr) {
-      ESP_LOGW(TAG, "Pending updates queue not initialized, dropping ERD update for 0x%04X", erd);
-    } else {
-      ESP_LOGW(TAG, "Pending update queue full, dropping ERD update for 0x%04X", erd);
-    }
+    esphome_mqtt_client_pending_update_t* update = &self->pending_updates[self->pending_update_count++];
+    update->host = host;
+    update->value_offset = self->pending_value_bytes;
+    update->erd = erd;
+    update->size = size;
+    memcpy(&self->pending_values[self->pending_value_bytes], value, size);
+    self->pending_value_bytes += size;
+    ESP_LOGD(TAG, "MQTT not connected, queued ERD update for 0x%04X (queue size: %u)", 
+             erd, self->pending_update_count);
   }
 }
 
-static void update_erd_write_result(
-  i_mqtt_client_t* _self,
+static void update_erd_write_result_in_namespace(
+  esphome_mqtt_client_adapter_t* self,
+  esphome_mqtt_client_host_t* host,
   tiny_erd_t erd,
   bool success,
   tiny_gea3_erd_client_write_failure_reason_t failure_reason)
 {
-  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
-  
   char topic_suffix[48];
   snprintf(topic_suffix, sizeof(topic_suffix), "/erd/0x%04x/write_result", erd);
-  std::string topic = build_topic(self, topic_suffix);
   
-  std::string payload = success ? "success" : "failure";
-  if (!success) {
-    char reason[16];
-    snprintf(reason, sizeof(reason), " (reason: %d)", failure_reason);
-    payload += reason;
+  char payload[32];
+  if (success) {
+    snprintf(payload, sizeof(payload), "success");
+  } else {
+    snprintf(payload, sizeof(payload), "failure (reason: %d)", failure_reason);
   }
   
   auto mqtt_client = esphome::mqtt::global_mqtt_client;
   if (mqtt_client != nullptr && mqtt_client->is_connected()) {
-    mqtt_client->publish(topic, payload, 2, false);  // QoS 2, no retain
+    mqtt_client->publish(build_topic(self, host, topic_suffix), payload, strlen(payload), 2, false);  // QoS 2, no retain
   } else {
     ESP_LOGD(TAG, "MQTT not connected, skipping write result for 0x%04X", erd);
   }
   
-  ESP_LOGD(TAG, "Write result for ERD 0x%04X: %s", erd, payload.c_str());
+  ESP_LOGD(TAG, "Write result for ERD 0x%04X: %s", erd, payload);
+}
+
+static void register_erd(i_mqtt_client_t* _self, tiny_erd_t erd)
+{
+  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
+  register_erd_in_namespace(self, nullptr, &self->on_write_request_event, erd);
+}
+
+static void update_erd(i_mqtt_client_t* _self, tiny_erd_t erd, const void* value, uint8_t size)
+{
+  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
+  update_erd_in_namespace(self, nullptr, erd, value, size);
+}
+
+static void update_erd_write_result(
+  i_mqtt_client_t* _self,
+  tiny_erd_t erd,
+  bool success,
+  tiny_gea3_erd_client_write_failure_reason_t failure_reason)
+{
+  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
+  update_erd_write_result_in_namespace(self, nullptr, erd, success, failure_reason);
 }
 
 static i_tiny_event_t* on_write_request(i_mqtt_client_t* _self)
@@ -166,21 +213,114 @@ static i_tiny_event_t* on_mqtt_disconnect(i_mqtt_client_t* _self)
   return &self->on_mqtt_disconnect_event.interface;
 }
 
+static i_mqtt_client_t* for_host(i_mqtt_client_t* _self, uint8_t address);
+
 static const i_mqtt_client_api_t api = {
   register_erd,
   update_erd,
   update_erd_write_result,
   on_write_request,
-  on_mqtt_disconnect
+  on_mqtt_disconnect,
+  for_host
+};
+
+static void host_register_erd(i_mqtt_client_t* _self, tiny_erd_t erd)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(host->adapter);
+  register_erd_in_namespace(self, host, &host->on_write_request_event, erd);
+}
+
+static void host_update_erd(i_mqtt_client_t* _self, tiny_erd_t erd, const void* value, uint8_t size)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  update_erd_in_namespace(reinterpret_cast<esphome_mqtt_client_adapter_t*>(host->adapter), host, erd, value, size);
+}
+
+static void host_update_erd_write_result(
+  i_mqtt_client_t* _self,
+  tiny_erd_t erd,
+  bool success,
+  tiny_gea3_erd_client_write_failure_reason_t failure_reason)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  update_erd_write_result_in_namespace(
+    reinterpret_cast<esphome_mqtt_client_adapter_t*>(host->adapter), host, erd, success, failure_reason);
+}
+
+static i_tiny_event_t* host_on_write_request(i_mqtt_client_t* _self)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  return &host->on_write_request_event.interface;
+}
+
+static i_tiny_event_t* host_on_mqtt_disconnect(i_mqtt_client_t* _self)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  return on_mqtt_disconnect(reinterpret_cast<i_mqtt_client_t*>(host->adapter));
+}
+
+static i_mqtt_client_t* host_for_host(i_mqtt_client_t* _self, uint8_t address)
+{
+  auto host = reinterpret_cast<esphome_mqtt_client_host_t*>(_self);
+  return for_host(reinterpret_cast<i_mqtt_client_t*>(host->adapter), address);
+}
+
+static const i_mqtt_client_api_t host_api = {
+  host_register_erd,
+  host_update_erd,
+  host_update_erd_write_result,
+  host_on_write_request,
+  host_on_mqtt_disconnect,
+  host_for_host
 };
 
+static i_mqtt_client_t* for_host(i_mqtt_client_t* _self, uint8_t address)
+{
+  auto self = reinterpret_cast<esphome_mqtt_client_adapter_t*>(_self);
+
+  for (uint8_t i = 0; i < self->host_count; i++) {
+    if (self->hosts[i].address == address) {
+      return &self->hosts[i].interface;
+    }
+  }
+
+  if (self->host_count >= ESPHOME_MQTT_CLIENT_ADAPTER_MAX_HOSTS) {
+    ESP_LOGW(TAG, "No free host namespace for board 0x%02X", address);
+    return nullptr;
+  }
+
+  esphome_mqtt_client_host_t* host = &self->hosts[self->host_count++];
+  host->interface.api = &host_api;
+  host->adapter = self;
+  host->address = address;
+  tiny_event_init(&host->on_write_request_event);
+
+  ESP_LOGI(TAG, "Publishing board 0x%02X under %s", address, build_topic(self, host, "").c_str());
+  return &host->interface;
+}
+
 extern "C" void esphome_mqtt_client_adapter_init(
   esphome_mqtt_client_adapter_t* self,
   const char* device_id)
 {
   self->interface.api = &api;
-  self->device_id = new std::string(device_id);
-  self->pending_updates = new std::deque<PendingErdUpdate>();
+  if (strlen(device_id) > ESPHOME_MQTT_CLIENT_ADAPTER_MAX_DEVICE_ID_LENGTH) {
+    ESP_LOGW(TAG, "Device ID is longer than %u characters and will be truncated", ESPHOME_MQTT_CLIENT_ADAPTER_MAX_DEVICE_ID_LENGTH);
+  }
+  snprintf(self->device_id, sizeof(self->device_id), "%s", device_id);
+  self->host_count = 0;
+
+  // The topic string and the pending update queue are the adapter's only heap allocations
+  self->topic = new std::string();
+  self->topic->reserve(MAX_TOPIC_LENGTH);
+  uint8_t* pending = new uint8_t[
+    ESPHOME_MQTT_CLIENT_ADAPTER_MAX_PENDING_UPDATES * sizeof(esphome_mqtt_client_pending_update_t) +
+    ESPHOME_MQTT_CLIENT_ADAPTER_PENDING_VALUE_BYTES];
+  self->pending_updates = reinterpret_cast<esphome_mqtt_client_pending_update_t*>(pending);
+  self->pending_values = pending + ESPHOME_MQTT_CLIENT_ADAPTER_MAX_PENDING_UPDATES * sizeof(esphome_mqtt_client_pending_update_t);
+  self->pending_update_count = 0;
+  self->pending_value_bytes = 0;
   
   tiny_event_init(&self->on_write_request_event);
   tiny_event_init(&self->on_mqtt_disconnect_event);
@@ -200,14 +340,16 @@ extern "C" void esphome_mqtt_client_adapter_notify_connected(
   // Flush pending updates when MQTT connects
   auto mqtt_client = esphome::mqtt::global_mqtt_client;
   if (mqtt_client != nullptr && mqtt_client->is_connected() && 
-      self->pending_updates != nullptr && !self->pending_updates->empty()) {
-    ESP_LOGI(TAG, "MQTT connected, flushing %zu pending ERD updates", self->pending_updates->size());
+      self->pending_updates != nullptr && self->pending_update_count > 0) {
+    ESP_LOGI(TAG, "MQTT connected, flushing %u pending ERD updates", self->pending_update_count);
     
-    for (const auto& update : *self->pending_updates) {
-      mqtt_client->publish(update.topic, update.payload, 2, true);  // QoS 2, retain
+    for (uint8_t i = 0; i < self->pending_update_count; i++) {
+      const esphome_mqtt_client_pending_update_t* update = &self->pending_updates[i];
+      publish_erd_value(self, update->host, update->erd, &self->pending_values[update->value_offset], update->size);
     }
     
-    self->pending_updates->clear();
+    self->pending_update_count = 0;
+    self->pending_value_bytes = 0;
     ESP_LOGI(TAG, "Flushed all pending ERD updates");
   }
 }
@@ -215,12 +357,13 @@ extern "C" void esphome_mqtt_client_adapter_notify_connected(
 extern "C" void esphome_mqtt_client_adapter_destroy(
   esphome_mqtt_client_adapter_t* self)
 {
-  if (self->device_id != nullptr) {
-    delete self->device_id;
-    self->device_id = nullptr;
+  if (self->topic != nullptr) {
+    delete self->topic;
+    self->topic = nullptr;
   }
   if (self->pending_updates != nullptr) {
-    delete self->pending_updates;
+    delete[] reinterpret_cast<uint8_t*>(self->pending_updates);
     self->pending_updates = nullptr;
+    self->pending_values = nullptr;
   }
 }
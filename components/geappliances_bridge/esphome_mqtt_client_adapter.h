@@ -1,24 +1,51 @@
 #pragma once
 
 #include <string>
-#include <deque>
 
 extern "C" {
 #include "i_mqtt_client.h"
 #include "tiny_event.h"
 }
 
-struct PendingErdUpdate {
-  std::string topic;
-  std::string payload;
-};
+// Maximum number of secondary host namespaces (geappliances/<device_id>/host/0xNN/...)
+static constexpr uint8_t ESPHOME_MQTT_CLIENT_ADAPTER_MAX_HOSTS = 8;
 
+// Updates queued while MQTT is disconnected, and the bytes of their values
+static constexpr uint8_t ESPHOME_MQTT_CLIENT_ADAPTER_MAX_PENDING_UPDATES = 100;
+static constexpr uint16_t ESPHOME_MQTT_CLIENT_ADAPTER_PENDING_VALUE_BYTES = 2048;
+
+// Longest device ID that fits in the topic buffer
+static constexpr uint8_t ESPHOME_MQTT_CLIENT_ADAPTER_MAX_DEVICE_ID_LENGTH = 96;
+
+typedef struct {
+  i_mqtt_client_t interface;
+  void* adapter;
+  tiny_event_t on_write_request_event;
+  uint8_t address;
+} esphome_mqtt_client_host_t;
+
+// A queued update; its value is stored at value_offset in the pending value bytes
+typedef struct {
+  esphome_mqtt_client_host_t* host;
+  uint16_t value_offset;
+  tiny_erd_t erd;
+  uint8_t size;
+} esphome_mqtt_client_pending_update_t;
+
+// Everything the adapter needs after init is allocated by init, in one block for the
+// queued updates and one reserved string for topics, so publishing does not touch the heap.
 typedef struct {
   i_mqtt_client_t interface;
-  std::string* device_id;
+  char device_id[ESPHOME_MQTT_CLIENT_ADAPTER_MAX_DEVICE_ID_LENGTH + 1];
+  std::string* topic;
   tiny_event_t on_write_request_event;
   tiny_event_t on_mqtt_disconnect_event;
-  std::deque<PendingErdUpdate>* pending_updates;
+  esphome_mqtt_client_pending_update_t* pending_updates;
+  uint8_t* pending_values;
+  uint16_t pending_value_bytes;
+  uint8_t pending_update_count;
+  esphome_mqtt_client_host_t hosts[ESPHOME_MQTT_CLIENT_ADAPTER_MAX_HOSTS];
+  uint8_t host_count;
 } esphome_mqtt_client_adapter_t;
 
 #ifdef __cplusplus
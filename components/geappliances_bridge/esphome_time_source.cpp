@@ -7,11 +7,26 @@ static tiny_time_source_ticks_t esphome_time_source_ticks(i_tiny_time_source_t*
   return esphome::millis();
 }
 
+static wide_time_source_ticks_t esphome_time_source_micros_ticks(i_wide_time_source_t* self)
+{
+  (void)self;
+  return esphome::micros();
+}
+
 static const i_tiny_time_source_api_t api = { esphome_time_source_ticks };
 
+static const i_wide_time_source_api_t micros_api = { esphome_time_source_micros_ticks };
+
 static i_tiny_time_source_t instance = { &api };
 
+static i_wide_time_source_t micros_instance = { &micros_api };
+
 extern "C" i_tiny_time_source_t* esphome_time_source_init(void)
 {
   return &instance;
 }
+
+extern "C" i_wide_time_source_t* esphome_time_source_micros_init(void)
+{
+  return &micros_instance;
+}
@@ -2,6 +2,7 @@
 
 extern "C" {
 #include "i_tiny_time_source.h"
+#include "i_wide_time_source.h"
 }
 
 #ifdef __cplusplus
@@ -14,6 +15,13 @@ extern "C" {
  */
 i_tiny_time_source_t* esphome_time_source_init(void);
 
+/*!
+ * Initialize the ESPHome microsecond time source. Ticks are microseconds and wrap
+ * after about 71 minutes, so only differences between ticks are meaningful.
+ * @return The time source interface.
+ */
+i_wide_time_source_t* esphome_time_source_micros_init(void);
+
 #ifdef __cplusplus
 }
 #endif
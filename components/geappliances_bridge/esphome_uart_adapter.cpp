@@ -1,61 +1,72 @@
 #include "esphome_uart_adapter.h"
 
-extern "C" {
-#include "tiny_utils.h"
-}
-
-static void poll(void* context)
+static uint16_t read_from_driver(void* context, uint8_t* buffer, uint16_t size)
 {
   auto self = static_cast<esphome_uart_adapter_t*>(context);
+  int available = self->uart->available();
 
-  while (self->uart->available()) {
-    uint8_t byte;
-    self->uart->read_byte(&byte);
-    
-    tiny_uart_on_receive_args_t args = { byte };
-    tiny_event_publish(&self->receive_event, &args);
+  if (available <= 0) {
+    return 0;
   }
 
-  if (self->sent) {
-    self->sent = false;
-    tiny_event_publish(&self->send_complete_event, nullptr);
-  }
+  uint16_t count = (static_cast<uint16_t>(available) < size) ? static_cast<uint16_t>(available) : size;
+  return self->uart->read_array(buffer, count) ? count : 0;
 }
 
-static void send(i_tiny_uart_t* _self, uint8_t byte)
+// write_array waits for room in the driver, so it always takes everything
+static uint16_t write_to_driver(void* context, const uint8_t* data, uint16_t size)
 {
-  auto self = reinterpret_cast<esphome_uart_adapter_t*>(_self);
-  self->sent = true;
-  self->uart->write_byte(byte);
+  auto self = static_cast<esphome_uart_adapter_t*>(context);
+  self->uart->write_array(data, size);
+  return size;
 }
 
-static i_tiny_event_t* on_send_complete(i_tiny_uart_t* _self)
+static uint16_t read_bytes(void* context, uint8_t* buffer, uint16_t size)
 {
-  auto self = reinterpret_cast<esphome_uart_adapter_t*>(_self);
-  return &self->send_complete_event.interface;
+  auto self = static_cast<esphome_uart_adapter_t*>(context);
+
+  if (self->bus_pump != nullptr) {
+    return uart_bus_pump_read(self->bus_pump, buffer, size);
+  }
+  return read_from_driver(self, buffer, size);
 }
 
-static i_tiny_event_t* on_receive(i_tiny_uart_t* _self)
+// With a bus task, what does not fit in the transmit ring is kept by the batch for the next pass
+static uint16_t write_bytes(void* context, const uint8_t* data, uint16_t size)
 {
-  auto self = reinterpret_cast<esphome_uart_adapter_t*>(_self);
-  return &self->receive_event.interface;
-}
+  auto self = static_cast<esphome_uart_adapter_t*>(context);
 
-static const i_tiny_uart_api_t api = { send, on_send_complete, on_receive };
+  if (self->bus_pump == nullptr) {
+    return write_to_driver(self, data, size);
+  }
+  return uart_bus_pump_write(self->bus_pump, data, size);
+}
 
 extern "C" void esphome_uart_adapter_init(
   esphome_uart_adapter_t* self,
   tiny_timer_group_t* timer_group,
-  esphome::uart::UARTComponent* uart)
+  esphome::uart::UARTComponent* uart,
+  bool batch_transmit,
+  uart_bus_pump_t* bus_pump)
 {
-  self->interface.api = &api;
-  self->timer_group = timer_group;
   self->uart = uart;
-  self->sent = false;
+  self->bus_pump = bus_pump;
+  buffered_uart_init(&self->buffered_uart, timer_group, read_bytes, write_bytes, self, batch_transmit);
+}
 
-  tiny_event_init(&self->send_complete_event);
-  tiny_event_init(&self->receive_event);
+extern "C" void esphome_uart_adapter_check_rx(
+  esphome_uart_adapter_t* self)
+{
+  // The UART component has no receive callback; this is the only per-loop cost while the bus is idle
+  bool rx_ready = (self->bus_pump != nullptr) ? (uart_bus_pump_received_count(self->bus_pump) > 0)
+                                               : (self->uart->available() > 0);
+  if (rx_ready) {
+    buffered_uart_notify_rx_ready(&self->buffered_uart);
+  }
+}
 
-  // Poll UART periodically (every ~0ms means as fast as possible in the event loop)
-  tiny_timer_start_periodic(timer_group, &self->timer, 0, self, poll);
+extern "C" void esphome_uart_adapter_pump(
+  esphome_uart_adapter_t* self)
+{
+  uart_bus_pump_run(self->bus_pump, read_from_driver, write_to_driver, self);
 }
@@ -3,29 +3,43 @@
 #include "esphome/components/uart/uart.h"
 
 extern "C" {
-#include "hal/i_tiny_uart.h"
-#include "tiny_event.h"
+#include "buffered_uart.h"
 #include "tiny_timer.h"
+#include "uart_bus_pump.h"
 }
 
 typedef struct {
-  i_tiny_uart_t interface;
-  tiny_timer_group_t* timer_group;
+  buffered_uart_t buffered_uart;
   esphome::uart::UARTComponent* uart;
-  tiny_event_t send_complete_event;
-  tiny_event_t receive_event;
-  tiny_timer_t timer;
-  bool sent;
+  uart_bus_pump_t* bus_pump;
 } esphome_uart_adapter_t;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*!
+ * Initialize the adapter. With a bus pump the UART driver is only accessed by the
+ * bus task through esphome_uart_adapter_pump; pass nullptr to access it directly.
+ */
 void esphome_uart_adapter_init(
   esphome_uart_adapter_t* self,
   tiny_timer_group_t* timer_group,
-  esphome::uart::UARTComponent* uart);
+  esphome::uart::UARTComponent* uart,
+  bool batch_transmit,
+  uart_bus_pump_t* bus_pump);
+
+/*!
+ * Schedule receive processing if the UART has data. Call before running the timer group.
+ */
+void esphome_uart_adapter_check_rx(
+  esphome_uart_adapter_t* self);
+
+/*!
+ * Move bytes between the UART driver and the bus pump. Called from the bus task.
+ */
+void esphome_uart_adapter_pump(
+  esphome_uart_adapter_t* self);
 
 #ifdef __cplusplus
 }
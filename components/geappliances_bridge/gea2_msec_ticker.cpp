@@ -0,0 +1,88 @@
+/*!
+ * @file
+ * @brief Publishes the GEA2 msec interrupt only while the GEA2 bus needs it.
+ */
+
+extern "C" {
+#include "gea2_msec_ticker.h"
+}
+
+#include <cstddef>
+
+static void tick(void* context)
+{
+  auto self = static_cast<gea2_msec_ticker_t*>(context);
+  tiny_event_publish(&self->msec_interrupt, NULL);
+}
+
+static void start_ticking(gea2_msec_ticker_t* self)
+{
+  if(!tiny_timer_is_running(self->timer_group, &self->tick_timer)) {
+    tiny_timer_start_periodic(self->timer_group, &self->tick_timer, gea2_msec_ticker_period, self, tick);
+  }
+}
+
+static void stop_ticking_if_idle(gea2_msec_ticker_t* self)
+{
+  if((self->outstanding_requests == 0) && !tiny_timer_is_running(self->timer_group, &self->hold_timer)) {
+    tiny_timer_stop(self->timer_group, &self->tick_timer);
+  }
+}
+
+static void hold_expired(void* context)
+{
+  stop_ticking_if_idle(static_cast<gea2_msec_ticker_t*>(context));
+}
+
+void gea2_msec_ticker_init(
+  gea2_msec_ticker_t* self,
+  tiny_timer_group_t* timer_group)
+{
+  self->timer_group = timer_group;
+  self->outstanding_requests = 0;
+  tiny_event_init(&self->msec_interrupt);
+}
+
+void gea2_msec_ticker_hold(
+  gea2_msec_ticker_t* self,
+  tiny_timer_ticks_t ticks)
+{
+  // Never shorten a longer hold that is already in progress
+  if(tiny_timer_is_running(self->timer_group, &self->hold_timer) &&
+    (tiny_timer_remaining_ticks(self->timer_group, &self->hold_timer) >= ticks)) {
+    return;
+  }
+
+  tiny_timer_start(self->timer_group, &self->hold_timer, ticks, self, hold_expired);
+  start_ticking(self);
+}
+
+void gea2_msec_ticker_request_started(
+  gea2_msec_ticker_t* self)
+{
+  if(self->outstanding_requests < UINT8_MAX) {
+    self->outstanding_requests++;
+  }
+  start_ticking(self);
+}
+
+void gea2_msec_ticker_request_finished(
+  gea2_msec_ticker_t* self)
+{
+  if(self->outstanding_requests > 0) {
+    self->outstanding_requests--;
+  }
+  stop_ticking_if_idle(self);
+}
+
+bool gea2_msec_ticker_is_active(
+  gea2_msec_ticker_t* self)
+{
+  return tiny_timer_is_running(self->timer_group, &self->tick_timer);
+}
+
+i_tiny_event_t* gea2_msec_ticker_on_msec_interrupt(
+  gea2_msec_ticker_t* self)
+{
+  return &self->msec_interrupt.interface;
+}
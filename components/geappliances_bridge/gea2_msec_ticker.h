@@ -0,0 +1,72 @@
+/*!
+ * @file
+ * @brief Publishes the GEA2 msec interrupt only while the GEA2 bus needs it.
+ *
+ * The GEA2 interface runs its inter-byte, reflection and bus idle timeouts from a
+ * millisecond interrupt event and measures elapsed time with its time source. The
+ * event only has to be published while a transaction is in progress, so the
+ * ticker stays active while any ERD client request is outstanding and is held
+ * active for a while whenever the bus is busy. It stops publishing (and stops
+ * scheduling wakeups) once no request is outstanding and the hold has ended.
+ */
+
+#ifndef gea2_msec_ticker_h
+#define gea2_msec_ticker_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_event.h"
+#include "tiny_timer.h"
+
+enum {
+  gea2_msec_ticker_period = 1
+};
+
+typedef struct {
+  tiny_timer_group_t* timer_group;
+  tiny_event_t msec_interrupt;
+  tiny_timer_t tick_timer;
+  tiny_timer_t hold_timer;
+  uint8_t outstanding_requests;
+} gea2_msec_ticker_t;
+
+/*!
+ * Initialize the ticker. It is idle until held.
+ */
+void gea2_msec_ticker_init(
+  gea2_msec_ticker_t* self,
+  tiny_timer_group_t* timer_group);
+
+/*!
+ * Keep publishing for at least the given number of ticks from now.
+ */
+void gea2_msec_ticker_hold(
+  gea2_msec_ticker_t* self,
+  tiny_timer_ticks_t ticks);
+
+/*!
+ * Keep publishing until the matching call to gea2_msec_ticker_request_finished(),
+ * however long the request waits in the ERD client's queue.
+ */
+void gea2_msec_ticker_request_started(
+  gea2_msec_ticker_t* self);
+
+/*!
+ * The ERD client reported a request as completed or failed. Extra calls are ignored.
+ */
+void gea2_msec_ticker_request_finished(
+  gea2_msec_ticker_t* self);
+
+/*!
+ * Returns true while the msec interrupt is being published.
+ */
+bool gea2_msec_ticker_is_active(
+  gea2_msec_ticker_t* self);
+
+/*!
+ * The msec interrupt event to give to the GEA2 interface.
+ */
+i_tiny_event_t* gea2_msec_ticker_on_msec_interrupt(
+  gea2_msec_ticker_t* self);
+
+#endif
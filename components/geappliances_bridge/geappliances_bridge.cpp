@@ -1,50 +1,93 @@
 #include "geappliances_bridge.h"
+#include "esphome/core/application.h"
+#include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 #include "esphome_time_source.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace geappliances_bridge {
 
 static const char *const TAG = "geappliances_bridge";
 
+// The GEA3 ERD client sends a request again when it is not answered within this long. The client
+// takes its configuration once, at init, and applies it to every request class, so this stays fixed
+// rather than following the polling bridge's per-host estimate below.
+static constexpr uint16_t GEA3_REQUEST_TIMEOUT_MS = 250;
+static constexpr uint8_t GEA3_REQUEST_RETRIES = 10;
+
 static const tiny_gea3_erd_client_configuration_t client_configuration = {
-  .request_timeout = 250,
-  .request_retries = 10
+  .request_timeout = GEA3_REQUEST_TIMEOUT_MS,
+  .request_retries = GEA3_REQUEST_RETRIES
+};
+
+// Requests each class may have waiting in the GEA3 ERD client's queue. Polling is held to one
+// read so writes and subscription upkeep never wait behind a backlog of bulk reads.
+// A subscribe or retain request the ERD client has not answered once it could have used up all
+// of its retries no longer holds a subscription slot.
+static const erd_request_arbiter_configuration_t request_arbiter_configuration = {
+  .limits = { 16, mqtt_bridge_max_hosts, 4, 1 },
+  .subscription_timeout = GEA3_REQUEST_TIMEOUT_MS * (GEA3_REQUEST_RETRIES + 1)
 };
 
+// How long the polling bridge waits for each read before moving on. It starts at the initial
+// timeout and then follows each host's measured response time within these limits. It never
+// waits past the ERD client's own timeout, so a read it measures was answered before the client
+// sent it again.
+static const rtt_estimator_configuration_t polling_read_timeout_configuration = {
+  .initial_timeout = 100,
+  .minimum_timeout = 20,
+  .maximum_timeout = GEA3_REQUEST_TIMEOUT_MS
+};
+
+static constexpr uint16_t GEA2_REQUEST_TIMEOUT_MS = 250;
+static constexpr uint8_t GEA2_REQUEST_RETRIES = 3;
+
 static const tiny_gea2_erd_client_configuration_t gea2_client_configuration = {
-  .request_timeout = 250,
-  .request_retries = 3
+  .request_timeout = GEA2_REQUEST_TIMEOUT_MS,
+  .request_retries = GEA2_REQUEST_RETRIES
 };
 
 // ERD identifiers for device ID generation
 static constexpr tiny_erd_t ERD_MODEL_NUMBER = 0x0001;
 static constexpr tiny_erd_t ERD_SERIAL_NUMBER = 0x0002;
 static constexpr tiny_erd_t ERD_APPLIANCE_TYPE = 0x0008;
-// ERD used for discovery broadcasts (appliance type)
-static constexpr tiny_erd_t ERD_DISCOVERY = 0x0008;
 static constexpr uint8_t GEA_BROADCAST_ADDRESS = 0xFF;
 static constexpr uint8_t GEA2_INTERFACE_RETRIES = 3;
+// GEA2 timing stays active while any GEA2 request is queued or in progress, and for
+// inter-byte, reflection and bus idle timeouts after any bus traffic
+static constexpr uint32_t GEA2_BUS_ACTIVITY_HOLD_MS = 50;
 
-static void publish_msec_interrupt(void* context)
-{
-  auto event = static_cast<tiny_event_t*>(context);
-  tiny_event_publish(event, nullptr);
-}
+// The component embeds the GEA3 stack and its buffers, one bridge's storage and the adapters,
+// about 8 KiB with 64-bit pointers and less on the ESP32. Embedding the GEA2 stack or a
+// second bridge again fails the build.
+static constexpr size_t STATIC_RAM_BUDGET_BYTES = 8192;
+static_assert(sizeof(GeappliancesBridge) <= STATIC_RAM_BUDGET_BYTES,
+              "GeappliancesBridge has grown past its static RAM budget");
 
 void GeappliancesBridge::setup() {
   ESP_LOGCONFIG(TAG, "Setting up GE Appliances Bridge...");
+  this->boot_time_start_ = millis();
 
   // Initialize timer group
   tiny_timer_group_init(&this->timer_group_, esphome_time_source_init());
+  this->micros_time_source_ = esphome_time_source_micros_init();
+  loop_pacing_init(&this->loop_pacing_);
+
+  if (this->bus_task_) {
+    this->gea3_bus_pump_ = new uart_bus_pump_t;
+    uart_bus_pump_init(this->gea3_bus_pump_);
+  }
 
-  // Initialize GEA3 UART adapter
-  esphome_uart_adapter_init(&this->uart_adapter_, &this->timer_group_, this->uart_);
+  // Initialize GEA3 UART adapter; whole frames are written at once
+  esphome_uart_adapter_init(&this->uart_adapter_, &this->timer_group_, this->uart_, true, this->gea3_bus_pump_);
 
   // Initialize GEA3 interface
   tiny_gea3_interface_init(
     &this->gea3_interface_,
-    &this->uart_adapter_.interface,
+    &this->uart_adapter_.buffered_uart.interface,
     this->client_address_,
     this->send_queue_buffer_,
     sizeof(this->send_queue_buffer_),
@@ -61,6 +104,21 @@ void GeappliancesBridge::setup() {
     sizeof(this->client_queue_buffer_),
     &client_configuration);
 
+  erd_request_arbiter_init(&this->request_arbiter_, &this->timer_group_, &this->erd_client_.interface,
+                           &request_arbiter_configuration);
+
+  // Discovery broadcasts and identity reads refused while the ERD client was busy are queued again
+  // as soon as there is room
+  tiny_event_subscription_init(
+    &this->autodiscovery_ready_subscription_,
+    this,
+    +[](void* context, const void*) {
+      autodiscovery_notify_ready(&reinterpret_cast<GeappliancesBridge*>(context)->autodiscovery_);
+    });
+  tiny_event_subscribe(
+    erd_request_arbiter_on_ready(&this->request_arbiter_, erd_request_arbiter_priority_identity),
+    &this->autodiscovery_ready_subscription_);
+
   // Subscribe to GEA3 ERD client activity
   tiny_event_subscription_init(
     &this->erd_client_activity_subscription_, 
@@ -77,45 +135,46 @@ void GeappliancesBridge::setup() {
   // Initialize GEA2 components if a second UART is configured
   if (this->gea2_uart_ != nullptr) {
     ESP_LOGI(TAG, "GEA2 UART configured, initializing GEA2 interface");
+    this->gea2_ = new Gea2Bus{};
 
-    // Initialize the msec_interrupt event (published every ~1ms to drive GEA2 timers)
-    tiny_event_init(&this->msec_interrupt_event_);
-    tiny_timer_start_periodic(
-      &this->timer_group_,
-      &this->gea2_msec_timer_,
-      1,
-      &this->msec_interrupt_event_,
-      publish_msec_interrupt);
+    // The msec_interrupt that drives GEA2 timing is only published while the GEA2 bus is in use
+    gea2_msec_ticker_init(&this->gea2_->msec_ticker, &this->timer_group_);
 
-    // Initialize GEA2 UART adapter
-    esphome_uart_adapter_init(&this->gea2_uart_adapter_, &this->timer_group_, this->gea2_uart_);
+    // Initialize GEA2 UART adapter. GEA2 is a single-wire bus where every byte is checked against
+    // its reflection for collisions, so bytes are still sent one at a time.
+    if (this->bus_task_) {
+      this->gea2_bus_pump_ = new uart_bus_pump_t;
+      uart_bus_pump_init(this->gea2_bus_pump_);
+    }
+    esphome_uart_adapter_init(&this->gea2_->uart_adapter, &this->timer_group_, this->gea2_uart_, false,
+                              this->gea2_bus_pump_);
 
     // Initialize GEA2 interface
     tiny_gea2_interface_init(
-      &this->gea2_interface_,
-      &this->gea2_uart_adapter_.interface,
+      &this->gea2_->interface,
+      &this->gea2_->uart_adapter.buffered_uart.interface,
       esphome_time_source_init(),
-      &this->msec_interrupt_event_.interface,
+      gea2_msec_ticker_on_msec_interrupt(&this->gea2_->msec_ticker),
       this->client_address_,
-      this->gea2_send_queue_buffer_,
-      sizeof(this->gea2_send_queue_buffer_),
-      this->gea2_receive_buffer_,
-      sizeof(this->gea2_receive_buffer_),
+      this->gea2_->send_queue_buffer,
+      sizeof(this->gea2_->send_queue_buffer),
+      this->gea2_->receive_buffer,
+      sizeof(this->gea2_->receive_buffer),
       false,
       GEA2_INTERFACE_RETRIES);
 
     // Initialize GEA2 ERD client
     tiny_gea2_erd_client_init(
-      &this->gea2_erd_client_,
+      &this->gea2_->erd_client,
       &this->timer_group_,
-      &this->gea2_interface_.interface,
-      this->gea2_client_queue_buffer_,
-      sizeof(this->gea2_client_queue_buffer_),
+      &this->gea2_->interface.interface,
+      this->gea2_->client_queue_buffer,
+      sizeof(this->gea2_->client_queue_buffer),
       &gea2_client_configuration);
 
     // Subscribe to GEA2 ERD client activity
     tiny_event_subscription_init(
-      &this->gea2_erd_client_activity_subscription_,
+      &this->gea2_->erd_client_activity_subscription,
       this,
       +[](void* context, const void* args) {
         auto self = reinterpret_cast<GeappliancesBridge*>(context);
@@ -123,8 +182,82 @@ void GeappliancesBridge::setup() {
         self->handle_gea2_erd_client_activity_(activity_args);
       });
     tiny_event_subscribe(
-      tiny_gea2_erd_client_on_activity(&this->gea2_erd_client_.interface),
-      &this->gea2_erd_client_activity_subscription_);
+      tiny_gea2_erd_client_on_activity(&this->gea2_->erd_client.interface),
+      &this->gea2_->erd_client_activity_subscription);
+  }
+
+  if (this->bus_task_) {
+    esphome_bus_task_add_adapter(&this->bus_task_state_, &this->uart_adapter_);
+    if (this->gea2_ != nullptr) {
+      esphome_bus_task_add_adapter(&this->bus_task_state_, &this->gea2_->uart_adapter);
+    }
+
+    if (esphome_bus_task_start(&this->bus_task_state_)) {
+      ESP_LOGI(TAG, "UARTs serviced by a dedicated bus task");
+    } else {
+      // Nothing would empty the pumps, so go back to accessing the UARTs from the loop
+      ESP_LOGE(TAG, "Unable to start bus task, accessing UARTs from the loop");
+      this->uart_adapter_.bus_pump = nullptr;
+      if (this->gea2_ != nullptr) {
+        this->gea2_->uart_adapter.bus_pump = nullptr;
+      }
+    }
+  }
+
+  static const cached_identity_callbacks_t identity_callbacks = {
+    +[](void* context, identity_cache_record_t* record) {
+      return reinterpret_cast<GeappliancesBridge*>(context)->identity_pref_.load(record);
+    },
+    +[](void* context, const identity_cache_record_t* record) {
+      return reinterpret_cast<GeappliancesBridge*>(context)->identity_pref_.save(record) && global_preferences->sync();
+    },
+    +[](void* context, uint8_t address) {
+      auto self = reinterpret_cast<GeappliancesBridge*>(context);
+      if (self->use_gea2_for_device_id_) {
+        return self->gea2_read_(&self->gea2_pending_request_id_, address, ERD_SERIAL_NUMBER);
+      }
+      return tiny_gea3_erd_client_read(self->gea3_client_(erd_request_arbiter_priority_identity),
+                                       &self->pending_request_id_, address, ERD_SERIAL_NUMBER);
+    },
+    +[](void* context, cached_identity_result_t result, const void* serial_number, uint8_t serial_number_size) {
+      reinterpret_cast<GeappliancesBridge*>(context)->identity_verification_finished_(result, serial_number,
+                                                                                      serial_number_size);
+    }
+  };
+  this->identity_pref_ = global_preferences->make_preference<identity_cache_record_t>(
+    fnv1_hash("geappliances_bridge_identity"), true);
+  cached_identity_init(&this->identity_, &this->timer_group_, &identity_callbacks, this);
+
+  static const autodiscovery_callbacks_t autodiscovery_callbacks = {
+    +[](void* context) {
+      return reinterpret_cast<GeappliancesBridge*>(context)->buses_settled_();
+    },
+    +[](void* context, autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd) {
+      return reinterpret_cast<GeappliancesBridge*>(context)->autodiscovery_read_(protocol, address, erd);
+    },
+    +[](void* context, autodiscovery_protocol_t protocol, uint8_t address, uint8_t appliance_type) {
+      reinterpret_cast<GeappliancesBridge*>(context)->board_discovered_(protocol, address, appliance_type);
+    },
+    +[](void* context, tiny_erd_t erd, const void* data, uint8_t data_size) {
+      reinterpret_cast<GeappliancesBridge*>(context)->identity_erd_read_(erd, data, data_size);
+    },
+    +[](void* context, autodiscovery_progress_t progress) {
+      reinterpret_cast<GeappliancesBridge*>(context)->autodiscovery_progress_(progress);
+    }
+  };
+  const autodiscovery_configuration_t autodiscovery_configuration = {
+    .gea3 = this->gea3_discovery_enabled_(),
+    .gea2 = this->gea2_discovery_enabled_(),
+    .gea3_preferred_address = this->gea3_address_preference_,
+    .gea2_preferred_address = this->gea2_address_preference_
+  };
+  autodiscovery_init(&this->autodiscovery_, &this->timer_group_, &autodiscovery_configuration,
+                     &autodiscovery_callbacks, this);
+
+  // Start from the identity saved by a previous boot if there is one; it is verified in the background
+  if (this->fast_boot_ && this->restore_identity_()) {
+    ESP_LOGCONFIG(TAG, "GE Appliances Bridge setup complete");
+    return;
   }
 
   // If device_id is configured, set it immediately; otherwise wait for autodiscovery
@@ -138,13 +271,21 @@ void GeappliancesBridge::setup() {
     // device_id_state_ stays IDLE until autodiscovery completes
   }
 
-  // Autodiscovery starts after MQTT connects (handled in on_mqtt_connected_())
-  ESP_LOGI(TAG, "Waiting for MQTT connection before starting autodiscovery...");
+  // Autodiscovery does not need the broker, so it starts as soon as the buses settle while MQTT connects
+  if (this->gea_mode_ == GEA_MODE_GEA2 && this->gea2_uart_ == nullptr) {
+    ESP_LOGE(TAG, "GEA2 mode selected but no gea2_uart_id configured; falling back to GEA3 autodiscovery");
+  }
+  bus_activity_monitor_init(&this->gea3_bus_monitor_);
+  bus_activity_monitor_init(&this->gea2_bus_monitor_);
+  autodiscovery_start(&this->autodiscovery_, this->configured_device_id_.empty());
+  ESP_LOGI(TAG, "Waiting for the bus to settle before starting autodiscovery...");
 
   ESP_LOGCONFIG(TAG, "GE Appliances Bridge setup complete");
 }
 
 void GeappliancesBridge::loop() {
+  uint32_t loop_start = wide_time_source_ticks(this->micros_time_source_);
+
   // Check MQTT connection state
   auto mqtt_client = mqtt::global_mqtt_client;
   if (mqtt_client != nullptr) {
@@ -163,6 +304,12 @@ void GeappliancesBridge::loop() {
     this->mqtt_was_connected_ = is_connected;
   }
 
+  // Received data schedules UART processing on the timer group
+  esphome_uart_adapter_check_rx(&this->uart_adapter_);
+  if (this->gea2_ != nullptr) {
+    esphome_uart_adapter_check_rx(&this->gea2_->uart_adapter);
+  }
+
   // Run timer group (always, non-blocking)
   tiny_timer_group_run(&this->timer_group_);
   
@@ -170,13 +317,11 @@ void GeappliancesBridge::loop() {
   tiny_gea3_interface_run(&this->gea3_interface_);
 
   // Run GEA2 interface (if configured)
-  if (this->gea2_uart_ != nullptr) {
-    tiny_gea2_interface_run(&this->gea2_interface_);
+  if (this->gea2_ != nullptr) {
+    this->hold_gea2_timing_for_bus_activity_();
+    tiny_gea2_interface_run(&this->gea2_->interface);
   }
 
-  // Run autodiscovery state machine
-  this->run_autodiscovery_();
-
   // Initialize MQTT bridge when device ID is ready and MQTT is connected
   if (this->bridge_init_state_ == BRIDGE_INIT_STATE_WAITING_FOR_MQTT && 
       mqtt_client != nullptr && mqtt_client->is_connected()) {
@@ -190,172 +335,335 @@ void GeappliancesBridge::loop() {
     this->check_subscription_activity_();
   }
 
-  // Handle device ID generation state machine
-  // Note: If state reaches DEVICE_ID_STATE_FAILED, device requires reboot to retry
-  if (this->use_gea2_for_device_id_) {
-    // GEA2 path: read all device ID ERDs via GEA2 client
-    tiny_erd_t erd = 0;
-    const char* erd_name = nullptr;
-    if (this->device_id_state_ == DEVICE_ID_STATE_READING_APPLIANCE_TYPE) {
-      erd = ERD_APPLIANCE_TYPE;
-      erd_name = "appliance type";
-    } else if (this->device_id_state_ == DEVICE_ID_STATE_READING_MODEL_NUMBER) {
-      erd = ERD_MODEL_NUMBER;
-      erd_name = "model number";
-    } else if (this->device_id_state_ == DEVICE_ID_STATE_READING_SERIAL_NUMBER) {
-      erd = ERD_SERIAL_NUMBER;
-      erd_name = "serial number";
-    }
-    if (erd_name != nullptr) {
-      if (tiny_gea2_erd_client_read(&this->gea2_erd_client_.interface, &this->gea2_pending_request_id_,
-                                     this->host_address_, erd)) {
-        ESP_LOGD(TAG, "Reading %s ERD 0x%04X via GEA2", erd_name, erd);
-        this->device_id_state_ = DEVICE_ID_STATE_IDLE;
-        this->read_retry_count_ = 0;
-      } else {
-        this->read_retry_count_++;
-        if (this->read_retry_count_ >= MAX_READ_RETRIES) {
-          ESP_LOGE(TAG, "Failed to read %s via GEA2 after %u retries, giving up", erd_name, MAX_READ_RETRIES);
-          this->device_id_state_ = DEVICE_ID_STATE_FAILED;
-        } else if (this->read_retry_count_ % LOG_EVERY_N_RETRIES == 0) {
-          ESP_LOGW(TAG, "Failed to queue %s read via GEA2, retrying... (attempt %u)", erd_name, this->read_retry_count_);
-        }
-      }
-    }
+  // Loop as fast as possible only while waiting on the bus or when a timer is due before the
+  // next regular pass; otherwise yield to ESPHome's regular loop interval
+  bool high_frequency = loop_pacing_needs_high_frequency(
+    tiny_timer_ticks_until_next_ready(&this->timer_group_), this->transaction_in_flight_());
+  if (high_frequency) {
+    this->high_freq_.start();
   } else {
-    // GEA3 path
-    if (this->device_id_state_ == DEVICE_ID_STATE_READING_APPLIANCE_TYPE) {
-      this->try_read_erd_with_retry_(ERD_APPLIANCE_TYPE, "appliance type");
-    } else if (this->device_id_state_ == DEVICE_ID_STATE_READING_MODEL_NUMBER) {
-      this->try_read_erd_with_retry_(ERD_MODEL_NUMBER, "model number");
-    } else if (this->device_id_state_ == DEVICE_ID_STATE_READING_SERIAL_NUMBER) {
-      this->try_read_erd_with_retry_(ERD_SERIAL_NUMBER, "serial number");
-    }
+    this->high_freq_.stop();
+  }
+
+  uint32_t loop_end = wide_time_source_ticks(this->micros_time_source_);
+  if (loop_pacing_record(&this->loop_pacing_, loop_start, loop_end, high_frequency)) {
+    uint16_t duty_cycle = loop_pacing_duty_cycle_permille(&this->loop_pacing_, loop_end);
+    ESP_LOGD(TAG, "Loop duty cycle: %u.%u%% over %u loops (%u at high frequency)",
+             duty_cycle / 10, duty_cycle % 10, this->loop_pacing_.loops, this->loop_pacing_.high_frequency_loops);
+    this->last_duty_cycle_permille_ = duty_cycle;
+    this->log_request_counters_();
+    loop_pacing_start_window(&this->loop_pacing_, loop_end);
+  }
+}
+
+i_tiny_gea3_erd_client_t* GeappliancesBridge::gea3_client_(erd_request_arbiter_priority_t priority) {
+  return erd_request_arbiter_client(&this->request_arbiter_, priority);
+}
+
+void GeappliancesBridge::log_request_counters_() {
+  static const char* const CLASS_NAMES[] = { "control", "subscription", "identity", "poll" };
+
+  for (uint8_t priority = 0; priority < erd_request_arbiter_priority_count; priority++) {
+    auto counters = erd_request_arbiter_counters(&this->request_arbiter_, priority);
+    ESP_LOGD(TAG, "GEA3 %s requests: %u accepted, %u refused, %u completed, %u failed", CLASS_NAMES[priority],
+             counters->accepted, counters->refused, counters->completed, counters->failed);
+  }
+
+  if (this->bridge_.kind == mqtt_bridge_storage_kind_subscription &&
+      this->bridge_.subscription.dropped_publication_count > 0) {
+    ESP_LOGW(TAG, "Dropped %u publications of ERDs beyond the %u undocumented ERDs tracked per host",
+             static_cast<unsigned>(this->bridge_.subscription.dropped_publication_count), mqtt_bridge_max_unknown_erds);
+  }
+}
+
+bool GeappliancesBridge::transaction_in_flight_() {
+  if (buffered_uart_transaction_in_flight(&this->uart_adapter_.buffered_uart)) {
+    return true;
   }
+  return this->gea2_ != nullptr && buffered_uart_transaction_in_flight(&this->gea2_->uart_adapter.buffered_uart);
 }
 
-void GeappliancesBridge::run_autodiscovery_() {
-  switch (this->autodiscovery_state_) {
-    case AUTODISCOVERY_WAITING_FOR_MQTT:
-      // Handled in on_mqtt_connected_()
+bool GeappliancesBridge::gea2_read_(tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd) {
+  if (this->gea2_ == nullptr || !tiny_gea2_erd_client_read(&this->gea2_->erd_client.interface, request_id, address, erd)) {
+    return false;
+  }
+  gea2_msec_ticker_request_started(&this->gea2_->msec_ticker);
+  return true;
+}
+
+void GeappliancesBridge::hold_gea2_timing_for_bus_activity_() {
+  auto buffered_uart = &this->gea2_->uart_adapter.buffered_uart;
+  if (buffered_uart->received_byte_count != this->gea2_->last_received_byte_count ||
+      buffered_uart_transaction_in_flight(buffered_uart)) {
+    this->gea2_->last_received_byte_count = buffered_uart->received_byte_count;
+    gea2_msec_ticker_hold(&this->gea2_->msec_ticker, GEA2_BUS_ACTIVITY_HOLD_MS);
+  }
+}
+
+bool GeappliancesBridge::buses_settled_() {
+  bus_activity_monitor_sample(&this->gea3_bus_monitor_,
+                              this->uart_adapter_.buffered_uart.received_byte_count,
+                              this->uart_adapter_.buffered_uart.received_frame_count);
+  bool settled = bus_activity_monitor_is_settled(&this->gea3_bus_monitor_);
+
+  if (this->gea2_ != nullptr) {
+    bus_activity_monitor_sample(&this->gea2_bus_monitor_,
+                                this->gea2_->uart_adapter.buffered_uart.received_byte_count,
+                                this->gea2_->uart_adapter.buffered_uart.received_frame_count);
+    settled = bus_activity_monitor_is_settled(&this->gea2_bus_monitor_) && settled;
+  }
+
+  return settled;
+}
+
+bool GeappliancesBridge::gea3_discovery_enabled_() const {
+  // GEA2 mode without a GEA2 UART falls back to GEA3
+  return this->gea_mode_ != GEA_MODE_GEA2 || this->gea2_uart_ == nullptr;
+}
+
+bool GeappliancesBridge::gea2_discovery_enabled_() const {
+  return this->gea2_uart_ != nullptr && this->gea_mode_ != GEA_MODE_GEA3;
+}
+
+bool GeappliancesBridge::autodiscovery_read_(autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd) {
+  bool gea2 = protocol == autodiscovery_protocol_gea2;
+  bool queued;
+  if (gea2) {
+    queued = this->gea2_read_(&this->gea2_pending_request_id_, address, erd);
+  } else {
+    queued = tiny_gea3_erd_client_read(this->gea3_client_(erd_request_arbiter_priority_identity),
+                                       &this->pending_request_id_, address, erd);
+  }
+
+  if (!queued) {
+    ESP_LOGD(TAG, "Request queue full while reading ERD 0x%04X", erd);
+  } else if (address == GEA_BROADCAST_ADDRESS) {
+    ESP_LOGI(TAG, "Sent %s broadcast (ERD 0x%04X) to address 0x%02X", gea2 ? "GEA2" : "GEA3", erd, address);
+  } else {
+    ESP_LOGD(TAG, "Reading ERD 0x%04X", erd);
+  }
+  return queued;
+}
+
+void GeappliancesBridge::board_discovered_(autodiscovery_protocol_t protocol, uint8_t address,
+                                           uint8_t appliance_type) {
+  if (!autodiscovery_host_selected(&this->autodiscovery_)) {
+    std::string app_type_name = appliance_type_to_string(appliance_type);
+    ESP_LOGD(TAG, "%s board discovered: address=0x%02X appliance_type=%u (%s)",
+             protocol == autodiscovery_protocol_gea2 ? "GEA2" : "GEA3", address, appliance_type,
+             app_type_name.c_str());
+    return;
+  }
+
+  // Discovery stops listening as soon as the preferred board answers; other GEA3 boards that
+  // answer the same broadcast afterwards still get a subscription
+  ESP_LOGD(TAG, "GEA3 board at 0x%02X answered after discovery completed", address);
+  bool subscription_bridge_running = this->mode_ == BRIDGE_MODE_SUBSCRIBE ||
+                                     (this->mode_ == BRIDGE_MODE_AUTO && this->subscription_mode_active_);
+  if (this->mqtt_bridge_initialized_ && subscription_bridge_running &&
+      mqtt_bridge_add_host(&this->bridge_.subscription, address)) {
+    ESP_LOGI(TAG, "Also subscribing to GEA3 board at 0x%02X", address);
+  }
+}
+
+void GeappliancesBridge::autodiscovery_progress_(autodiscovery_progress_t progress) {
+  switch (progress) {
+    case autodiscovery_progress_buses_settled:
+      ESP_LOGI(TAG, "Bus settled after %u ms, starting GEA2/3 autodiscovery", millis() - this->boot_time_start_);
       break;
 
-    case AUTODISCOVERY_WAITING_20S:
-      // Note: Unsigned subtraction wraps correctly even when millis() overflows after ~49 days
-      if (millis() - this->autodiscovery_timer_start_ >= STARTUP_DELAY_MS) {
-        ESP_LOGI(TAG, "20s delay complete, starting GEA2/3 autodiscovery");
-        if (this->gea_mode_ == GEA_MODE_GEA2) {
-          this->autodiscovery_state_ = AUTODISCOVERY_GEA2_BROADCAST_PENDING;
-        } else {
-          this->autodiscovery_state_ = AUTODISCOVERY_GEA3_BROADCAST_PENDING;
-        }
-      }
+    case autodiscovery_progress_startup_delay_expired:
+      ESP_LOGI(TAG, "Bus still busy after %u s, starting GEA2/3 autodiscovery anyway",
+               autodiscovery_startup_delay / 1000);
       break;
 
-    case AUTODISCOVERY_GEA3_BROADCAST_PENDING: {
-      // Reset GEA3 discovery tracking for this broadcast cycle
-      this->gea3_board_discovered_ = false;
-      this->gea3_preferred_found_ = false;
-      this->gea3_first_address_ = 0x00;
-      this->gea3_first_address_set_ = false;
-      tiny_gea3_erd_client_request_id_t req_id;
-      if (tiny_gea3_erd_client_read(&this->erd_client_.interface, &req_id,
-                                     GEA_BROADCAST_ADDRESS, ERD_DISCOVERY)) {
-        ESP_LOGI(TAG, "Sent GEA3 broadcast (ERD 0x%04X) to address 0x%02X",
-                 ERD_DISCOVERY, GEA_BROADCAST_ADDRESS);
-        this->autodiscovery_timer_start_ = millis();
-        this->autodiscovery_state_ = AUTODISCOVERY_GEA3_BROADCAST_WAITING;
-      }
-      // else: retry next loop iteration
+    case autodiscovery_progress_no_boards_found:
+      ESP_LOGW(TAG, "No boards found, repeating discovery...");
       break;
-    }
 
-    case AUTODISCOVERY_GEA3_BROADCAST_WAITING:
-      if (millis() - this->autodiscovery_timer_start_ >= AUTODISCOVERY_BROADCAST_WINDOW_MS) {
-        if (this->gea3_board_discovered_) {
-          // Use preferred address if found; otherwise use first responder
-          if (!this->gea3_preferred_found_) {
-            this->host_address_ = this->gea3_first_address_;
-          }
-          this->use_gea2_for_device_id_ = false;
-          ESP_LOGI(TAG, "GEA3 board discovered at 0x%02X, autodiscovery complete", this->host_address_);
-          this->autodiscovery_state_ = AUTODISCOVERY_COMPLETE;
-          this->start_device_id_generation_();
-        } else {
-          if (this->gea_mode_ == GEA_MODE_GEA3 ||
-              (this->gea_mode_ == GEA_MODE_AUTO && this->gea2_uart_ == nullptr)) {
-            ESP_LOGW(TAG, "No GEA3 boards found, retrying GEA3...");
-            this->autodiscovery_state_ = AUTODISCOVERY_GEA3_BROADCAST_PENDING;
-          } else {
-            ESP_LOGI(TAG, "No GEA3 boards found, trying GEA2...");
-            this->autodiscovery_state_ = AUTODISCOVERY_GEA2_BROADCAST_PENDING;
-          }
-        }
-      }
+    case autodiscovery_progress_host_selected:
+      this->host_address_ = autodiscovery_host_address(&this->autodiscovery_);
+      this->use_gea2_for_device_id_ = autodiscovery_host_protocol(&this->autodiscovery_) == autodiscovery_protocol_gea2;
+      ESP_LOGI(TAG, "%s board discovered at 0x%02X, autodiscovery complete",
+               this->use_gea2_for_device_id_ ? "GEA2" : "GEA3", this->host_address_);
+      this->start_device_id_generation_();
       break;
 
-    case AUTODISCOVERY_GEA2_BROADCAST_PENDING:
-      if (this->gea2_uart_ == nullptr) {
-        ESP_LOGE(TAG, "GEA2 mode selected but no gea2_uart_id configured; falling back to GEA3 autodiscovery");
-        this->autodiscovery_state_ = AUTODISCOVERY_GEA3_BROADCAST_PENDING;
-      } else {
-        // Reset GEA2 discovery tracking for this broadcast cycle
-        this->gea2_board_discovered_ = false;
-        this->gea2_preferred_found_ = false;
-        this->gea2_first_address_ = 0x00;
-        this->gea2_first_address_set_ = false;
-        tiny_gea2_erd_client_request_id_t req_id;
-        if (tiny_gea2_erd_client_read(&this->gea2_erd_client_.interface, &req_id,
-                                       GEA_BROADCAST_ADDRESS, ERD_DISCOVERY)) {
-          ESP_LOGI(TAG, "Sent GEA2 broadcast (ERD 0x%04X) to address 0x%02X",
-                   ERD_DISCOVERY, GEA_BROADCAST_ADDRESS);
-          this->autodiscovery_timer_start_ = millis();
-          this->autodiscovery_state_ = AUTODISCOVERY_GEA2_BROADCAST_WAITING;
-        }
-        // else: retry next loop iteration
-      }
+    case autodiscovery_progress_identity_read_retrying:
+      ESP_LOGW(TAG, "Failed to read the device identity, will retry");
       break;
 
-    case AUTODISCOVERY_GEA2_BROADCAST_WAITING:
-      if (millis() - this->autodiscovery_timer_start_ >= AUTODISCOVERY_BROADCAST_WINDOW_MS) {
-        if (this->gea2_board_discovered_) {
-          // Use preferred address if found; otherwise use first responder
-          if (!this->gea2_preferred_found_) {
-            this->host_address_ = this->gea2_first_address_;
-          }
-          this->use_gea2_for_device_id_ = true;
-          ESP_LOGI(TAG, "GEA2 board discovered at 0x%02X, autodiscovery complete", this->host_address_);
-          this->autodiscovery_state_ = AUTODISCOVERY_COMPLETE;
-          this->start_device_id_generation_();
-        } else {
-          if (this->gea_mode_ == GEA_MODE_GEA2) {
-            ESP_LOGW(TAG, "No GEA2 boards found, retrying GEA2...");
-            this->autodiscovery_state_ = AUTODISCOVERY_GEA2_BROADCAST_PENDING;
-          } else {
-            ESP_LOGW(TAG, "No boards found after GEA3+GEA2 broadcasts, repeating discovery loop...");
-            this->autodiscovery_state_ = AUTODISCOVERY_GEA3_BROADCAST_PENDING;
-          }
-        }
-      }
+    case autodiscovery_progress_identity_read_failed:
+      ESP_LOGE(TAG, "Failed to read device identity after %u retries, rediscovering in %u seconds",
+               autodiscovery_identity_max_retries, autodiscovery_identity_recovery_delay / 1000);
+      this->device_id_state_ = DEVICE_ID_STATE_FAILED;
       break;
 
-    case AUTODISCOVERY_COMPLETE:
+    case autodiscovery_progress_identity_read:
+      this->device_identity_read_();
       break;
   }
 }
 
 void GeappliancesBridge::start_device_id_generation_() {
-  // Only start device ID generation if it hasn't been set already
-  if (this->device_id_state_ != DEVICE_ID_STATE_IDLE) {
-    return;
-  }
   if (!this->configured_device_id_.empty()) {
-    // Device ID already configured - MQTT bridge init handled by bridge_init_state_
+    // Device ID already configured - MQTT bridge init handled by bridge_init_state_.
+    // The serial number is still read so that the discovered topology can be cached for fast boot.
+    if (this->fast_boot_) {
+      cached_identity_capture(&this->identity_, this->host_address_);
+    }
     return;
   }
+  // Autodiscovery reads the appliance type, model and serial number from the host next
   ESP_LOGI(TAG, "Starting device ID generation from host address 0x%02X via %s",
            this->host_address_, this->use_gea2_for_device_id_ ? "GEA2" : "GEA3");
-  this->device_id_state_ = DEVICE_ID_STATE_READING_APPLIANCE_TYPE;
+  this->device_id_state_ = DEVICE_ID_STATE_READING;
+}
+
+void GeappliancesBridge::identity_erd_read_(tiny_erd_t erd, const void* data, uint8_t data_size) {
+  auto bytes = reinterpret_cast<const uint8_t*>(data);
+  if (erd == ERD_APPLIANCE_TYPE) {
+    // Appliance type is a single byte enum
+    this->appliance_type_ = bytes[0];
+    ESP_LOGI(TAG, "Read appliance type: %u", this->appliance_type_);
+  } else if (erd == ERD_MODEL_NUMBER) {
+    // Model number is a 32-byte string
+    this->model_number_ = this->bytes_to_string_(bytes, data_size);
+    ESP_LOGI(TAG, "Read model number: %s", this->model_number_.c_str());
+  } else {
+    // Serial number is a 32-byte string
+    this->serial_number_ = this->bytes_to_string_(bytes, data_size);
+    memcpy(this->serial_number_raw_, bytes, std::min<size_t>(data_size, sizeof(this->serial_number_raw_)));
+    this->serial_number_raw_size_ = std::min<size_t>(data_size, sizeof(this->serial_number_raw_));
+    ESP_LOGI(TAG, "Read serial number: %s", this->serial_number_.c_str());
+  }
+}
+
+void GeappliancesBridge::device_identity_read_() {
+  // Sanitize strings for MQTT topic use
+  std::string sanitized_model = this->sanitize_for_mqtt_topic_(this->model_number_);
+  std::string sanitized_serial = this->sanitize_for_mqtt_topic_(this->serial_number_);
+
+  // Convert appliance type to string name using generated function
+  std::string appliance_type_name = appliance_type_to_string(this->appliance_type_);
+
+  // Generate device ID with appliance type name
+  this->generated_device_id_ = appliance_type_name + "_" +
+                               sanitized_model + "_" +
+                               sanitized_serial;
+  this->final_device_id_ = this->generated_device_id_;
+
+  ESP_LOGI(TAG, "Generated device ID%s: %s", this->use_gea2_for_device_id_ ? " (via GEA2)" : "",
+           this->final_device_id_.c_str());
+  this->save_identity_(this->serial_number_raw_, this->serial_number_raw_size_);
+
+  this->device_id_state_ = DEVICE_ID_STATE_COMPLETE;
+  // Don't initialize MQTT bridge yet - wait for MQTT connection
+  this->bridge_init_state_ = BRIDGE_INIT_STATE_WAITING_FOR_MQTT;
+}
+
+bool GeappliancesBridge::restore_identity_() {
+  if (!cached_identity_restore(&this->identity_)) {
+    ESP_LOGI(TAG, "No cached identity, running full autodiscovery");
+    return false;
+  }
+
+  auto record = cached_identity_record(&this->identity_);
+  bool cached_gea2 = record->protocol == identity_cache_protocol_gea2;
+  if ((cached_gea2 && (this->gea2_uart_ == nullptr || this->gea_mode_ == GEA_MODE_GEA3)) ||
+      (!cached_gea2 && this->gea_mode_ == GEA_MODE_GEA2)) {
+    ESP_LOGI(TAG, "Cached identity does not match the configured GEA mode, running full autodiscovery");
+    return false;
+  }
+
+  this->host_address_ = record->host_address;
+  this->use_gea2_for_device_id_ = cached_gea2;
+  this->appliance_type_ = record->appliance_type;
+
+  autodiscovery_restore(&this->autodiscovery_,
+                        cached_gea2 ? autodiscovery_protocol_gea2 : autodiscovery_protocol_gea3,
+                        record->host_address, record->secondary_host_addresses, record->secondary_host_count);
+
+  if (!this->configured_device_id_.empty()) {
+    this->final_device_id_ = this->configured_device_id_;
+  } else {
+    this->generated_device_id_ = record->device_id;
+    this->final_device_id_ = this->generated_device_id_;
+  }
+
+  this->device_id_state_ = DEVICE_ID_STATE_COMPLETE;
+  this->bridge_init_state_ = BRIDGE_INIT_STATE_WAITING_FOR_MQTT;
+  this->identity_restored_ = true;
+  cached_identity_verify(&this->identity_);
+
+  ESP_LOGI(TAG, "Restored cached identity %s (%s host 0x%02X), verifying in background",
+           this->final_device_id_.c_str(), cached_gea2 ? "GEA2" : "GEA3", this->host_address_);
+  return true;
+}
+
+void GeappliancesBridge::save_identity_(const void* serial_number, uint8_t serial_number_size) {
+  if (!this->fast_boot_) {
+    return;
+  }
+
+  auto record = cached_identity_record(&this->identity_);
+  identity_cache_record_init(
+    record,
+    this->use_gea2_for_device_id_ ? identity_cache_protocol_gea2 : identity_cache_protocol_gea3,
+    this->host_address_,
+    this->appliance_type_,
+    serial_number,
+    serial_number_size,
+    this->final_device_id_.c_str());
+
+  if (!this->use_gea2_for_device_id_) {
+    for (uint8_t i = 0; i < autodiscovery_gea3_board_count(&this->autodiscovery_); i++) {
+      uint8_t address = autodiscovery_gea3_board(&this->autodiscovery_, i);
+      if (address != this->host_address_) {
+        identity_cache_record_add_secondary_host(record, address);
+      }
+    }
+  }
+
+  if (cached_identity_save(&this->identity_)) {
+    ESP_LOGI(TAG, "Saved identity for fast boot");
+  } else {
+    ESP_LOGW(TAG, "Unable to save identity for fast boot");
+  }
+}
+
+void GeappliancesBridge::identity_verification_finished_(cached_identity_result_t result, const void* serial_number,
+                                                         uint8_t serial_number_size) {
+  switch (result) {
+    case cached_identity_result_captured:
+      this->save_identity_(serial_number, serial_number_size);
+      break;
+
+    case cached_identity_result_verified:
+      ESP_LOGI(TAG, "Cached identity verified");
+      break;
+
+    case cached_identity_result_mismatched:
+      // The MQTT topics, Home Assistant discovery and the bus stacks were all set up for the cached
+      // appliance. The record is already invalidated, so restarting sets them up again from full
+      // autodiscovery. This only happens when the appliance has been replaced.
+      ESP_LOGW(TAG, "Appliance does not match the cached identity, rebooting to run full autodiscovery");
+      App.safe_reboot();
+      break;
+  }
+}
+
+bool GeappliancesBridge::handle_identity_verification_read_(uint8_t address, tiny_erd_t erd, bool success,
+                                                            const void* data, uint8_t data_size) {
+  if (erd != ERD_SERIAL_NUMBER || !cached_identity_read_finished(&this->identity_, address, success, data, data_size)) {
+    return false;
+  }
+
+  if (!success) {
+    // An unresponsive host is not a mismatch; the cached identity is kept and checked again later
+    ESP_LOGW(TAG, "Identity verification read failed, retrying in %u seconds", cached_identity_retry_delay / 1000);
+  }
+  return true;
 }
 
 void GeappliancesBridge::on_mqtt_connected_() {
@@ -371,13 +679,6 @@ void GeappliancesBridge::on_mqtt_connected_() {
   // to clear its ERD registry and resubscribe. This ensures all ERDs are re-registered
   // and subscriptions are fresh after reconnection.
   this->notify_mqtt_disconnected_();
-
-  // Start the 20s autodiscovery delay if not already started
-  if (this->autodiscovery_state_ == AUTODISCOVERY_WAITING_FOR_MQTT) {
-    ESP_LOGI(TAG, "MQTT connected, waiting %u seconds before autodiscovery", STARTUP_DELAY_MS / 1000);
-    this->autodiscovery_timer_start_ = millis();
-    this->autodiscovery_state_ = AUTODISCOVERY_WAITING_20S;
-  }
 }
 
 void GeappliancesBridge::notify_mqtt_disconnected_() {
@@ -403,155 +704,49 @@ void GeappliancesBridge::handle_erd_client_activity_(const tiny_gea3_erd_client_
     }
   }
 
-  // Handle autodiscovery responses (GEA3 broadcast window)
-  if (this->autodiscovery_state_ == AUTODISCOVERY_GEA3_BROADCAST_WAITING) {
-    if (args->type == tiny_gea3_erd_client_activity_type_read_completed &&
-        args->read_completed.erd == ERD_DISCOVERY) {
-      uint8_t app_type = reinterpret_cast<const uint8_t*>(args->read_completed.data)[0];
-      std::string app_type_name = appliance_type_to_string(app_type);
-      ESP_LOGD(TAG, "GEA3 board discovered: address=0x%02X appliance_type=%u (%s)",
-               args->address, app_type, app_type_name.c_str());
-      this->gea3_board_discovered_ = true;
-      if (args->address == this->gea3_address_preference_) {
-        // Preferred address responded - use it for device ID generation
-        this->gea3_preferred_found_ = true;
-        this->host_address_ = args->address;
-        this->use_gea2_for_device_id_ = false;
-      } else if (!this->gea3_first_address_set_) {
-        // Track first non-preferred responder as fallback
-        this->gea3_first_address_ = args->address;
-        this->gea3_first_address_set_ = true;
-      }
+  if (args->type == tiny_gea3_erd_client_activity_type_read_completed) {
+    if (!this->use_gea2_for_device_id_ &&
+        this->handle_identity_verification_read_(args->address, args->read_completed.erd, true,
+                                                 args->read_completed.data, args->read_completed.data_size)) {
+      return;
     }
-    return; // Don't process as device ID during autodiscovery window
-  }
-
-  // Only process read responses for device ID ERDs before MQTT bridge is initialized
-  if (!this->mqtt_bridge_initialized_ && args->address == this->host_address_) {
-    if (args->type == tiny_gea3_erd_client_activity_type_read_completed) {
-      if (args->read_completed.erd == ERD_APPLIANCE_TYPE) {
-        // Appliance type is a single byte enum
-        this->appliance_type_ = reinterpret_cast<const uint8_t*>(args->read_completed.data)[0];
-        ESP_LOGI(TAG, "Read appliance type: %u", this->appliance_type_);
-        this->device_id_state_ = DEVICE_ID_STATE_READING_MODEL_NUMBER;
-      } else if (args->read_completed.erd == ERD_MODEL_NUMBER) {
-        // Model number is a 32-byte string
-        this->model_number_ = this->bytes_to_string_(
-          reinterpret_cast<const uint8_t*>(args->read_completed.data), 
-          args->read_completed.data_size);
-        ESP_LOGI(TAG, "Read model number: %s", this->model_number_.c_str());
-        this->device_id_state_ = DEVICE_ID_STATE_READING_SERIAL_NUMBER;
-      } else if (args->read_completed.erd == ERD_SERIAL_NUMBER) {
-        // Serial number is a 32-byte string
-        this->serial_number_ = this->bytes_to_string_(
-          reinterpret_cast<const uint8_t*>(args->read_completed.data), 
-          args->read_completed.data_size);
-        ESP_LOGI(TAG, "Read serial number: %s", this->serial_number_.c_str());
-        
-        // Sanitize strings for MQTT topic use
-        std::string sanitized_model = this->sanitize_for_mqtt_topic_(this->model_number_);
-        std::string sanitized_serial = this->sanitize_for_mqtt_topic_(this->serial_number_);
-        
-        // Convert appliance type to string name using generated function
-        std::string appliance_type_name = appliance_type_to_string(this->appliance_type_);
-        
-        // Generate device ID with appliance type name
-        this->generated_device_id_ = appliance_type_name + "_" + 
-                                     sanitized_model + "_" + 
-                                     sanitized_serial;
-        this->final_device_id_ = this->generated_device_id_;
-        
-        ESP_LOGI(TAG, "Generated device ID: %s", this->final_device_id_.c_str());
-        
-        this->device_id_state_ = DEVICE_ID_STATE_COMPLETE;
-        // Don't initialize MQTT bridge yet - wait for MQTT connection
-        this->bridge_init_state_ = BRIDGE_INIT_STATE_WAITING_FOR_MQTT;
-      }
-    } else if (args->type == tiny_gea3_erd_client_activity_type_read_failed) {
-      // Log the failure and retry by transitioning back to the appropriate reading state
-      ESP_LOGW(TAG, "Failed to read ERD 0x%04X for device ID generation (reason: %u), will retry", 
-               args->read_failed.erd, args->read_failed.reason);
-      
-      // Transition back to the reading state to retry
-      if (args->read_failed.erd == ERD_APPLIANCE_TYPE) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_APPLIANCE_TYPE;
-      } else if (args->read_failed.erd == ERD_MODEL_NUMBER) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_MODEL_NUMBER;
-      } else if (args->read_failed.erd == ERD_SERIAL_NUMBER) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_SERIAL_NUMBER;
-      }
+    autodiscovery_read_finished(&this->autodiscovery_, autodiscovery_protocol_gea3, args->address,
+                                args->read_completed.erd, true, args->read_completed.data,
+                                args->read_completed.data_size);
+  } else if (args->type == tiny_gea3_erd_client_activity_type_read_failed) {
+    if (!this->use_gea2_for_device_id_ &&
+        this->handle_identity_verification_read_(args->address, args->read_failed.erd, false, nullptr, 0)) {
+      return;
     }
+    autodiscovery_read_finished(&this->autodiscovery_, autodiscovery_protocol_gea3, args->address,
+                                args->read_failed.erd, false, nullptr, 0);
   }
 }
 
 void GeappliancesBridge::handle_gea2_erd_client_activity_(const tiny_gea2_erd_client_on_activity_args_t* args) {
-  // Handle autodiscovery responses (GEA2 broadcast window)
-  if (this->autodiscovery_state_ == AUTODISCOVERY_GEA2_BROADCAST_WAITING) {
-    if (args->type == tiny_gea2_erd_client_activity_type_read_completed &&
-        args->read_completed.erd == ERD_DISCOVERY) {
-      uint8_t app_type = reinterpret_cast<const uint8_t*>(args->read_completed.data)[0];
-      std::string app_type_name = appliance_type_to_string(app_type);
-      ESP_LOGD(TAG, "GEA2 board discovered: address=0x%02X appliance_type=%u (%s)",
-               args->address, app_type, app_type_name.c_str());
-      this->gea2_board_discovered_ = true;
-      if (args->address == this->gea2_address_preference_) {
-        // Preferred address responded - use it for device ID generation
-        this->gea2_preferred_found_ = true;
-        this->host_address_ = args->address;
-        this->use_gea2_for_device_id_ = true;
-      } else if (!this->gea2_first_address_set_) {
-        // Track first non-preferred responder as fallback
-        this->gea2_first_address_ = args->address;
-        this->gea2_first_address_set_ = true;
-      }
+  // Pipelined reads wait in the client's queue, so timing is held until every one of them has finished
+  if (args->type == tiny_gea2_erd_client_activity_type_read_completed ||
+      args->type == tiny_gea2_erd_client_activity_type_read_failed) {
+    gea2_msec_ticker_request_finished(&this->gea2_->msec_ticker);
+    gea2_msec_ticker_hold(&this->gea2_->msec_ticker, GEA2_BUS_ACTIVITY_HOLD_MS);
+  }
+
+  if (args->type == tiny_gea2_erd_client_activity_type_read_completed) {
+    if (this->use_gea2_for_device_id_ &&
+        this->handle_identity_verification_read_(args->address, args->read_completed.erd, true,
+                                                 args->read_completed.data, args->read_completed.data_size)) {
+      return;
     }
-    return; // Don't process as device ID during autodiscovery window
-  }
-
-  // Handle device ID reads via GEA2 (when use_gea2_for_device_id_ is true)
-  if (this->use_gea2_for_device_id_ && !this->mqtt_bridge_initialized_ &&
-      args->address == this->host_address_) {
-    if (args->type == tiny_gea2_erd_client_activity_type_read_completed) {
-      if (args->read_completed.erd == ERD_APPLIANCE_TYPE) {
-        this->appliance_type_ = reinterpret_cast<const uint8_t*>(args->read_completed.data)[0];
-        ESP_LOGI(TAG, "Read appliance type via GEA2: %u", this->appliance_type_);
-        this->device_id_state_ = DEVICE_ID_STATE_READING_MODEL_NUMBER;
-      } else if (args->read_completed.erd == ERD_MODEL_NUMBER) {
-        this->model_number_ = this->bytes_to_string_(
-          reinterpret_cast<const uint8_t*>(args->read_completed.data),
-          args->read_completed.data_size);
-        ESP_LOGI(TAG, "Read model number via GEA2: %s", this->model_number_.c_str());
-        this->device_id_state_ = DEVICE_ID_STATE_READING_SERIAL_NUMBER;
-      } else if (args->read_completed.erd == ERD_SERIAL_NUMBER) {
-        this->serial_number_ = this->bytes_to_string_(
-          reinterpret_cast<const uint8_t*>(args->read_completed.data),
-          args->read_completed.data_size);
-        ESP_LOGI(TAG, "Read serial number via GEA2: %s", this->serial_number_.c_str());
-
-        std::string sanitized_model = this->sanitize_for_mqtt_topic_(this->model_number_);
-        std::string sanitized_serial = this->sanitize_for_mqtt_topic_(this->serial_number_);
-        std::string appliance_type_name = appliance_type_to_string(this->appliance_type_);
-
-        this->generated_device_id_ = appliance_type_name + "_" +
-                                     sanitized_model + "_" +
-                                     sanitized_serial;
-        this->final_device_id_ = this->generated_device_id_;
-        ESP_LOGI(TAG, "Generated device ID (via GEA2): %s", this->final_device_id_.c_str());
-
-        this->device_id_state_ = DEVICE_ID_STATE_COMPLETE;
-        this->bridge_init_state_ = BRIDGE_INIT_STATE_WAITING_FOR_MQTT;
-      }
-    } else if (args->type == tiny_gea2_erd_client_activity_type_read_failed) {
-      ESP_LOGW(TAG, "Failed to read ERD 0x%04X via GEA2 (reason: %u), will retry",
-               args->read_failed.erd, args->read_failed.reason);
-      if (args->read_failed.erd == ERD_APPLIANCE_TYPE) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_APPLIANCE_TYPE;
-      } else if (args->read_failed.erd == ERD_MODEL_NUMBER) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_MODEL_NUMBER;
-      } else if (args->read_failed.erd == ERD_SERIAL_NUMBER) {
-        this->device_id_state_ = DEVICE_ID_STATE_READING_SERIAL_NUMBER;
-      }
+    autodiscovery_read_finished(&this->autodiscovery_, autodiscovery_protocol_gea2, args->address,
+                                args->read_completed.erd, true, args->read_completed.data,
+                                args->read_completed.data_size);
+  } else if (args->type == tiny_gea2_erd_client_activity_type_read_failed) {
+    if (this->use_gea2_for_device_id_ &&
+        this->handle_identity_verification_read_(args->address, args->read_failed.erd, false, nullptr, 0)) {
+      return;
     }
+    autodiscovery_read_finished(&this->autodiscovery_, autodiscovery_protocol_gea2, args->address,
+                                args->read_failed.erd, false, nullptr, 0);
   }
 }
 
@@ -582,29 +777,88 @@ void GeappliancesBridge::initialize_mqtt_bridge_() {
   
   ESP_LOGI(TAG, "Using %s mode with polling interval: %u ms", mode_name, this->polling_interval_ms_);
 
-  // Initialize MQTT client adapter
+  // Initialize MQTT client adapter. The bridge using it is stopped and whatever a previous
+  // initialization allocated is released first.
+  this->stop_bridge_();
+  esphome_mqtt_client_adapter_destroy(&this->mqtt_client_adapter_);
   esphome_mqtt_client_adapter_init(&this->mqtt_client_adapter_, this->final_device_id_.c_str());
 
   // Initialize MQTT bridge based on mode
   if (use_polling) {
-    mqtt_bridge_polling_init(
-      &this->mqtt_bridge_polling_,
-      &this->timer_group_,
-      &this->erd_client_.interface,
-      &this->mqtt_client_adapter_.interface,
-      this->polling_interval_ms_,
-      this->polling_only_publish_on_change_);
+    this->start_polling_bridge_();
   } else {
-    mqtt_bridge_init(
-      &this->mqtt_bridge_,
-      &this->timer_group_,
-      &this->erd_client_.interface,
-      &this->mqtt_client_adapter_.interface,
-      this->host_address_);
+    this->start_subscription_bridge_();
+
+    // Secondary GEA3 boards found during autodiscovery share the same bridge
+    if (!this->use_gea2_for_device_id_) {
+      for (uint8_t i = 0; i < autodiscovery_gea3_board_count(&this->autodiscovery_); i++) {
+        uint8_t address = autodiscovery_gea3_board(&this->autodiscovery_, i);
+        if (address == this->host_address_) {
+          continue;
+        }
+        if (mqtt_bridge_add_host(&this->bridge_.subscription, address)) {
+          ESP_LOGI(TAG, "Also subscribing to GEA3 board at 0x%02X", address);
+        } else {
+          ESP_LOGW(TAG, "Unable to subscribe to GEA3 board at 0x%02X", address);
+        }
+      }
+    }
   }
 
   this->mqtt_bridge_initialized_ = true;
-  ESP_LOGI(TAG, "MQTT bridge initialized successfully");
+  ESP_LOGI(TAG, "MQTT bridge initialized successfully %u ms after boot (%s)",
+           millis() - this->boot_time_start_, this->identity_restored_ ? "cached identity" : "autodiscovery");
+}
+
+void GeappliancesBridge::start_subscription_bridge_() {
+  this->stop_bridge_();
+  mqtt_bridge_init(
+    &this->bridge_.subscription,
+    &this->timer_group_,
+    this->gea3_client_(erd_request_arbiter_priority_subscription),
+    &this->mqtt_client_adapter_.interface,
+    this->host_address_);
+  this->bridge_.kind = mqtt_bridge_storage_kind_subscription;
+}
+
+void GeappliancesBridge::start_polling_bridge_() {
+  this->stop_bridge_();
+  mqtt_bridge_polling_init(
+    &this->bridge_.polling,
+    &this->timer_group_,
+    this->gea3_client_(erd_request_arbiter_priority_poll),
+    &this->mqtt_client_adapter_.interface,
+    this->polling_interval_ms_,
+    this->polling_only_publish_on_change_,
+    this->polling_change_detection_,
+    &polling_read_timeout_configuration);
+  this->bridge_.kind = mqtt_bridge_storage_kind_polling;
+
+  // A read the bridge gave up on no longer holds the single poll slot while the ERD client retries it
+  tiny_event_subscription_init(
+    &this->poll_abandoned_subscription_, this, +[](void* context, const void* _args) {
+      auto self = reinterpret_cast<GeappliancesBridge*>(context);
+      auto args = reinterpret_cast<const mqtt_bridge_polling_on_read_abandoned_args_t*>(_args);
+      erd_request_arbiter_abandon(&self->request_arbiter_, args->request_id);
+    });
+  tiny_event_subscribe(mqtt_bridge_polling_on_read_abandoned(&this->bridge_.polling), &this->poll_abandoned_subscription_);
+}
+
+// The bridges share storage, so the running one is destroyed before the other is started
+void GeappliancesBridge::stop_bridge_() {
+  switch (this->bridge_.kind) {
+    case mqtt_bridge_storage_kind_subscription:
+      mqtt_bridge_destroy(&this->bridge_.subscription);
+      break;
+
+    case mqtt_bridge_storage_kind_polling:
+      mqtt_bridge_polling_destroy(&this->bridge_.polling);
+      break;
+
+    default:
+      break;
+  }
+  this->bridge_.kind = mqtt_bridge_storage_kind_none;
 }
 
 std::string GeappliancesBridge::bytes_to_string_(const uint8_t* data, size_t size) {
@@ -645,27 +899,6 @@ std::string GeappliancesBridge::sanitize_for_mqtt_topic_(const std::string& inpu
   return result;
 }
 
-bool GeappliancesBridge::try_read_erd_with_retry_(tiny_erd_t erd, const char* erd_name) {
-  if (tiny_gea3_erd_client_read(&this->erd_client_.interface, &this->pending_request_id_, 
-                                 this->host_address_, erd)) {
-    ESP_LOGD(TAG, "Reading %s ERD 0x%04X", erd_name, erd);
-    this->device_id_state_ = DEVICE_ID_STATE_IDLE; // Wait for response
-    this->read_retry_count_ = 0;
-    return true;
-  } else {
-    // Failed to queue the read request, will retry on next loop
-    this->read_retry_count_++;
-    if (this->read_retry_count_ >= MAX_READ_RETRIES) {
-      ESP_LOGE(TAG, "Failed to read %s after %u retries, giving up", erd_name, MAX_READ_RETRIES);
-      this->device_id_state_ = DEVICE_ID_STATE_FAILED;
-      return false;
-    } else if (this->read_retry_count_ % LOG_EVERY_N_RETRIES == 0) {
-      ESP_LOGW(TAG, "Failed to queue %s read, retrying... (attempt %u)", erd_name, this->read_retry_count_);
-    }
-    return false;
-  }
-}
-
 void GeappliancesBridge::check_subscription_activity_() {
   // If we already detected activity, no need to check
   if (this->subscription_activity_detected_) {
@@ -681,17 +914,8 @@ void GeappliancesBridge::check_subscription_activity_() {
     ESP_LOGW(TAG, "No subscription activity detected after %u seconds, falling back to polling mode", 
              SUBSCRIPTION_TIMEOUT_MS / 1000);
     
-    // Destroy the subscription bridge
-    mqtt_bridge_destroy(&this->mqtt_bridge_);
-    
-    // Initialize polling bridge
-    mqtt_bridge_polling_init(
-      &this->mqtt_bridge_polling_,
-      &this->timer_group_,
-      &this->erd_client_.interface,
-      &this->mqtt_client_adapter_.interface,
-      this->polling_interval_ms_,
-      this->polling_only_publish_on_change_);
+    // The polling bridge takes over the subscription bridge's storage
+    this->start_polling_bridge_();
     
     // Mark that we're no longer in subscription mode
     this->subscription_mode_active_ = false;
@@ -715,7 +939,7 @@ void GeappliancesBridge::dump_config() {
     ESP_LOGCONFIG(TAG, "    Serial Number: %s", this->serial_number_.c_str());
   }
   if (this->device_id_state_ == DEVICE_ID_STATE_FAILED) {
-    ESP_LOGCONFIG(TAG, "  Device ID Generation: FAILED (see logs for details)");
+    ESP_LOGCONFIG(TAG, "  Device ID Generation: FAILED, will rediscover (see logs for details)");
   }
   ESP_LOGCONFIG(TAG, "  Client Address: 0x%02X", this->client_address_);
   ESP_LOGCONFIG(TAG, "  Host Address: 0x%02X", this->host_address_);
@@ -729,13 +953,15 @@ void GeappliancesBridge::dump_config() {
   // Display GEA protocol mode
   const char* gea_mode_str = "Unknown";
   if (this->gea_mode_ == GEA_MODE_AUTO) {
-    gea_mode_str = "Auto (GEA3 first, then GEA2)";
+    gea_mode_str = "Auto (GEA3 and GEA2 concurrently)";
   } else if (this->gea_mode_ == GEA_MODE_GEA3) {
     gea_mode_str = "GEA3 only";
   } else if (this->gea_mode_ == GEA_MODE_GEA2) {
     gea_mode_str = "GEA2 only";
   }
   ESP_LOGCONFIG(TAG, "  GEA Mode: %s", gea_mode_str);
+  ESP_LOGCONFIG(TAG, "  Fast Boot: %s", !this->fast_boot_ ? "disabled" :
+                this->identity_restored_ ? "enabled (started from cached identity)" : "enabled");
 
   // Display bridge mode
   const char* mode_str = "Unknown";
@@ -1,13 +1,21 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/components/mqtt/mqtt_client.h"
 #include <string>
 
 extern "C" {
-#include "mqtt_bridge.h"
-#include "mqtt_bridge_polling.h"
+#include "autodiscovery.h"
+#include "bus_activity_monitor.h"
+#include "cached_identity.h"
+#include "erd_request_arbiter.h"
+#include "gea2_msec_ticker.h"
+#include "i_wide_time_source.h"
+#include "loop_pacing.h"
+#include "mqtt_bridge_storage.h"
 #include "tiny_gea2_erd_client.h"
 #include "tiny_gea2_interface.h"
 #include "tiny_gea3_erd_client.h"
@@ -15,6 +23,7 @@ extern "C" {
 #include "tiny_timer.h"
 }
 
+#include "esphome_bus_task.h"
 #include "esphome_uart_adapter.h"
 #include "esphome_mqtt_client_adapter.h"
 
@@ -35,7 +44,7 @@ enum BridgeMode {
 // GEA protocol mode for autodiscovery and device ID generation
 // Note: These enum values must match GEA_MODE_*_VALUE constants in __init__.py
 enum GEAMode {
-  GEA_MODE_AUTO = 0,  // Try GEA3 first, then GEA2
+  GEA_MODE_AUTO = 0,  // Broadcast on GEA3 and GEA2 together, prefer GEA3
   GEA_MODE_GEA3 = 1,  // Use GEA3 only
   GEA_MODE_GEA2 = 2   // Use GEA2 only
 };
@@ -55,9 +64,15 @@ class GeappliancesBridge : public Component {
   void set_mode(uint8_t mode) { this->mode_ = static_cast<BridgeMode>(mode); }
   void set_polling_interval(uint32_t polling_interval) { this->polling_interval_ms_ = polling_interval; }
   void set_polling_only_publish_on_change(bool only_publish_on_change) { this->polling_only_publish_on_change_ = only_publish_on_change; }
+  void set_polling_change_detection(uint8_t change_detection) { this->polling_change_detection_ = change_detection; }
   void set_gea3_address(uint8_t address) { this->gea3_address_preference_ = address; }
   void set_gea2_address(uint8_t address) { this->gea2_address_preference_ = address; }
   void set_gea_mode(uint8_t mode) { this->gea_mode_ = static_cast<GEAMode>(mode); }
+  void set_fast_boot(bool fast_boot) { this->fast_boot_ = fast_boot; }
+  void set_bus_task(bool bus_task) { this->bus_task_ = bus_task; }
+
+  // Percentage of time spent in loop() over the last 60 second window
+  float get_loop_duty_cycle() const { return this->last_duty_cycle_permille_ / 10.0f; }
 
  protected:
   void on_mqtt_connected_();
@@ -65,20 +80,36 @@ class GeappliancesBridge : public Component {
   void handle_erd_client_activity_(const tiny_gea3_erd_client_on_activity_args_t* args);
   void handle_gea2_erd_client_activity_(const tiny_gea2_erd_client_on_activity_args_t* args);
   void initialize_mqtt_bridge_();
+  void start_subscription_bridge_();
+  void start_polling_bridge_();
+  void stop_bridge_();
   void check_subscription_activity_();
-  void run_autodiscovery_();
+  bool buses_settled_();
+  bool autodiscovery_read_(autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd);
+  void board_discovered_(autodiscovery_protocol_t protocol, uint8_t address, uint8_t appliance_type);
+  void autodiscovery_progress_(autodiscovery_progress_t progress);
   void start_device_id_generation_();
+  void identity_erd_read_(tiny_erd_t erd, const void* data, uint8_t data_size);
+  void device_identity_read_();
+  bool gea3_discovery_enabled_() const;
+  bool gea2_discovery_enabled_() const;
+  bool restore_identity_();
+  void save_identity_(const void* serial_number, uint8_t serial_number_size);
+  void identity_verification_finished_(cached_identity_result_t result, const void* serial_number, uint8_t serial_number_size);
+  bool handle_identity_verification_read_(uint8_t address, tiny_erd_t erd, bool success, const void* data, uint8_t data_size);
   std::string bytes_to_string_(const uint8_t* data, size_t size);
   std::string sanitize_for_mqtt_topic_(const std::string& input);
-  bool try_read_erd_with_retry_(tiny_erd_t erd, const char* erd_name);
+  bool transaction_in_flight_();
+  i_tiny_gea3_erd_client_t* gea3_client_(erd_request_arbiter_priority_t priority);
+  void log_request_counters_();
+  bool gea2_read_(tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd);
+  void hold_gea2_timing_for_bus_activity_();
 
   enum DeviceIdState {
     DEVICE_ID_STATE_IDLE,
-    DEVICE_ID_STATE_READING_APPLIANCE_TYPE,
-    DEVICE_ID_STATE_READING_MODEL_NUMBER,
-    DEVICE_ID_STATE_READING_SERIAL_NUMBER,
+    DEVICE_ID_STATE_READING,     // Appliance type, model and serial number reads in flight
     DEVICE_ID_STATE_COMPLETE,
-    DEVICE_ID_STATE_FAILED
+    DEVICE_ID_STATE_FAILED       // Out of retries; autodiscovery restarts after autodiscovery_identity_recovery_delay
   };
 
   enum BridgeInitState {
@@ -87,16 +118,6 @@ class GeappliancesBridge : public Component {
     BRIDGE_INIT_STATE_COMPLETE
   };
 
-  enum AutodiscoveryState {
-    AUTODISCOVERY_WAITING_FOR_MQTT,          // Waiting for MQTT connection
-    AUTODISCOVERY_WAITING_20S,               // MQTT connected, waiting 20 seconds
-    AUTODISCOVERY_GEA3_BROADCAST_PENDING,    // About to send GEA3 broadcast
-    AUTODISCOVERY_GEA3_BROADCAST_WAITING,    // Sent GEA3 broadcast, waiting 10s for responses
-    AUTODISCOVERY_GEA2_BROADCAST_PENDING,    // About to send GEA2 broadcast
-    AUTODISCOVERY_GEA2_BROADCAST_WAITING,    // Sent GEA2 broadcast, waiting 10s for responses
-    AUTODISCOVERY_COMPLETE                   // At least one board discovered
-  };
-
   uart::UARTComponent *uart_{nullptr};
   uart::UARTComponent *gea2_uart_{nullptr};
   std::string configured_device_id_;
@@ -111,6 +132,7 @@ class GeappliancesBridge : public Component {
   GEAMode gea_mode_{GEA_MODE_AUTO};
   uint32_t polling_interval_ms_{10000};
   bool polling_only_publish_on_change_{false};
+  erd_value_cache_mode_t polling_change_detection_{erd_value_cache_mode_full_copy};
   uint8_t gea3_address_preference_{0xC0}; // Preferred GEA3 board address for device ID generation
   uint8_t gea2_address_preference_{0xA0}; // Preferred GEA2 board address for device ID generation
   
@@ -123,34 +145,36 @@ class GeappliancesBridge : public Component {
   DeviceIdState device_id_state_{DEVICE_ID_STATE_IDLE};
   BridgeInitState bridge_init_state_{BRIDGE_INIT_STATE_WAITING_FOR_DEVICE_ID};
 
-  // Autodiscovery state machine
-  AutodiscoveryState autodiscovery_state_{AUTODISCOVERY_WAITING_FOR_MQTT};
-  uint32_t autodiscovery_timer_start_{0};
-  bool gea3_board_discovered_{false};
-  bool gea3_preferred_found_{false};
-  uint8_t gea3_first_address_{0x00};       // First GEA3 board that responded (fallback)
-  bool gea3_first_address_set_{false};     // Whether gea3_first_address_ has been recorded
-  bool gea2_board_discovered_{false};
-  bool gea2_preferred_found_{false};
-  uint8_t gea2_first_address_{0x00};       // First GEA2 board that responded (fallback)
-  bool gea2_first_address_set_{false};     // Whether gea2_first_address_ has been recorded
-  static constexpr uint32_t STARTUP_DELAY_MS = 20000;              // 20s after MQTT connects
-  static constexpr uint32_t AUTODISCOVERY_BROADCAST_WINDOW_MS = 10000; // 10s window per broadcast
+  // Bus settling, discovery broadcasts and the device ID reads
+  autodiscovery_t autodiscovery_{};
+  bus_activity_monitor_t gea3_bus_monitor_;
+  bus_activity_monitor_t gea2_bus_monitor_;
+
+  // Fast-boot identity cache
+  bool fast_boot_{true};
+  bool identity_restored_{false};          // Started from the cached identity instead of autodiscovery
+  ESPPreferenceObject identity_pref_;
+  cached_identity_t identity_{};
+  uint32_t boot_time_start_{0};
 
   tiny_gea3_erd_client_request_id_t pending_request_id_;
   tiny_gea2_erd_client_request_id_t gea2_pending_request_id_;
   uint8_t appliance_type_{0};
   std::string model_number_;
   std::string serial_number_;
-  uint32_t read_retry_count_{0};
-  static constexpr uint32_t LOG_EVERY_N_RETRIES = 50; // Log retry attempts periodically
-  static constexpr uint32_t MAX_READ_RETRIES = 1000; // Maximum retries before giving up (about 10 seconds at loop rate)
+  uint8_t serial_number_raw_[32];
+  uint8_t serial_number_raw_size_{0};
 
   tiny_timer_group_t timer_group_;
+  // Microsecond ticks for loop and bus latency measurements
+  i_wide_time_source_t* micros_time_source_{nullptr};
+  HighFrequencyLoopRequester high_freq_;
+  loop_pacing_t loop_pacing_;
+  uint16_t last_duty_cycle_permille_{0};
 
   // GEA3 components
   esphome_uart_adapter_t uart_adapter_;
-  esphome_mqtt_client_adapter_t mqtt_client_adapter_;
+  esphome_mqtt_client_adapter_t mqtt_client_adapter_{};
 
   tiny_gea3_interface_t gea3_interface_;
   uint8_t receive_buffer_[255];
@@ -158,24 +182,38 @@ class GeappliancesBridge : public Component {
 
   tiny_gea3_erd_client_t erd_client_;
   uint8_t client_queue_buffer_[1024];
+  // Every GEA3 request goes through the arbiter instead of the ERD client directly
+  erd_request_arbiter_t request_arbiter_;
+  tiny_event_subscription_t autodiscovery_ready_subscription_;
+  tiny_event_subscription_t poll_abandoned_subscription_;
+
+  // UART driver access from a dedicated task (only used when bus_task_ is true)
+  bool bus_task_{false};
+  esphome_bus_task_t bus_task_state_{};
+  uart_bus_pump_t* gea3_bus_pump_{nullptr};
+  uart_bus_pump_t* gea2_bus_pump_{nullptr};
+
+  // GEA2 components, allocated by setup() only when gea2_uart_ is configured
+  struct Gea2Bus {
+    esphome_uart_adapter_t uart_adapter;
+    gea2_msec_ticker_t msec_ticker;
+    uint32_t last_received_byte_count;
+
+    tiny_gea2_interface_t interface;
+    uint8_t receive_buffer[255];
+    uint8_t send_queue_buffer[1000];
+
+    tiny_gea2_erd_client_t erd_client;
+    uint8_t client_queue_buffer[1024];
+
+    tiny_event_subscription_t erd_client_activity_subscription;
+  };
+  Gea2Bus* gea2_{nullptr};
 
-  // GEA2 components (only used when gea2_uart_ is non-null)
-  esphome_uart_adapter_t gea2_uart_adapter_;
-  tiny_event_t msec_interrupt_event_;
-  tiny_timer_t gea2_msec_timer_;
-
-  tiny_gea2_interface_t gea2_interface_;
-  uint8_t gea2_receive_buffer_[255];
-  uint8_t gea2_send_queue_buffer_[1000];
-
-  tiny_gea2_erd_client_t gea2_erd_client_;
-  uint8_t gea2_client_queue_buffer_[1024];
-
-  mqtt_bridge_t mqtt_bridge_;
-  mqtt_bridge_polling_t mqtt_bridge_polling_;
+  // Only one bridge runs at a time; bridge_.kind says which one
+  mqtt_bridge_storage_t bridge_{};
 
   tiny_event_subscription_t erd_client_activity_subscription_;
-  tiny_event_subscription_t gea2_erd_client_activity_subscription_;
 };
 
 }  // namespace geappliances_bridge
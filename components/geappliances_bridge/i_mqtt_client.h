@@ -32,6 +32,8 @@ typedef struct i_mqtt_client_api_t {
   i_tiny_event_t* (*on_write_request)(i_mqtt_client_t* self);
 
   i_tiny_event_t* (*on_mqtt_disconnect)(i_mqtt_client_t* self);
+
+  i_mqtt_client_t* (*for_host)(i_mqtt_client_t* self, uint8_t host);
 } i_mqtt_client_api_t;
 
 /*!
@@ -74,4 +76,13 @@ static inline i_tiny_event_t* mqtt_client_on_mqtt_disconnect(i_mqtt_client_t* se
   return self->api->on_mqtt_disconnect(self);
 }
 
+/*!
+ * Get a client that publishes ERDs and receives write requests in the namespace of
+ * the given host address. Returns NULL if no more host namespaces are available.
+ */
+static inline i_mqtt_client_t* mqtt_client_for_host(i_mqtt_client_t* self, uint8_t host)
+{
+  return self->api->for_host(self, host);
+}
+
 #endif
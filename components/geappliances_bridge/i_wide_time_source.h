@@ -0,0 +1,35 @@
+/*!
+ * @file
+ * @brief Time source interface with 32-bit ticks
+ *
+ * i_tiny_time_source_t ticks are only 16 bits wide, which a microsecond counter
+ * wraps every 65 ms. Stopwatches and the loop duty cycle measurement use this
+ * interface instead so that microsecond ticks wrap after about 71 minutes.
+ */
+
+#ifndef i_wide_time_source_h
+#define i_wide_time_source_h
+
+#include <stdint.h>
+
+typedef uint32_t wide_time_source_ticks_t;
+
+struct i_wide_time_source_api_t;
+
+typedef struct {
+  const struct i_wide_time_source_api_t* api;
+} i_wide_time_source_t;
+
+typedef struct i_wide_time_source_api_t {
+  wide_time_source_ticks_t (*ticks)(i_wide_time_source_t* self);
+} i_wide_time_source_api_t;
+
+/*!
+ * Current ticks of the time source. Only differences between ticks are meaningful.
+ */
+static inline wide_time_source_ticks_t wide_time_source_ticks(i_wide_time_source_t* self)
+{
+  return self->api->ticks(self);
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*!
+ * @file
+ * @brief Persisted record of the bus topology and device identity found at boot.
+ */
+
+extern "C" {
+#include "identity_cache.h"
+}
+
+#include <cstddef>
+#include <cstring>
+
+enum {
+  // Bump whenever the record layout changes so that stale records are discarded
+  record_version = 1
+};
+
+static const uint32_t fnv_offset_basis = 2166136261u;
+static const uint32_t fnv_prime = 16777619u;
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t* data, size_t size)
+{
+  for(size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= fnv_prime;
+  }
+  return hash;
+}
+
+// Serial numbers are fixed-size, NUL-padded strings
+static uint32_t serial_number_hash(const void* serial_number, uint8_t serial_number_size)
+{
+  auto data = reinterpret_cast<const uint8_t*>(serial_number);
+  uint8_t length = 0;
+
+  while((length < serial_number_size) && (data[length] != 0)) {
+    length++;
+  }
+
+  return fnv1a(fnv_offset_basis, data, length);
+}
+
+static uint32_t checksum(const identity_cache_record_t* self)
+{
+  return fnv1a(fnv_offset_basis, reinterpret_cast<const uint8_t*>(self), offsetof(identity_cache_record_t, checksum));
+}
+
+void identity_cache_record_init(
+  identity_cache_record_t* self,
+  identity_cache_protocol_t protocol,
+  uint8_t host_address,
+  uint8_t appliance_type,
+  const void* serial_number,
+  uint8_t serial_number_size,
+  const char* device_id)
+{
+  memset(self, 0, sizeof(*self));
+  self->protocol = protocol;
+  self->host_address = host_address;
+  self->appliance_type = appliance_type;
+  self->serial_number_hash = serial_number_hash(serial_number, serial_number_size);
+  strncpy(self->device_id, device_id, sizeof(self->device_id));
+}
+
+bool identity_cache_record_add_secondary_host(
+  identity_cache_record_t* self,
+  uint8_t address)
+{
+  if(self->secondary_host_count >= sizeof(self->secondary_host_addresses)) {
+    return false;
+  }
+
+  self->secondary_host_addresses[self->secondary_host_count++] = address;
+  return true;
+}
+
+void identity_cache_record_seal(
+  identity_cache_record_t* self)
+{
+  self->version = record_version;
+  self->checksum = checksum(self);
+}
+
+bool identity_cache_record_is_valid(
+  const identity_cache_record_t* self)
+{
+  return (self->version == record_version) &&
+    (self->checksum == checksum(self)) &&
+    (self->device_id[0] != 0) &&
+    (self->device_id[sizeof(self->device_id) - 1] == 0) &&
+    (self->secondary_host_count <= sizeof(self->secondary_host_addresses)) &&
+    (self->protocol <= identity_cache_protocol_gea2);
+}
+
+void identity_cache_record_invalidate(
+  identity_cache_record_t* self)
+{
+  memset(self, 0, sizeof(*self));
+}
+
+bool identity_cache_record_matches_serial_number(
+  const identity_cache_record_t* self,
+  const void* serial_number,
+  uint8_t serial_number_size)
+{
+  return self->serial_number_hash == serial_number_hash(serial_number, serial_number_size);
+}
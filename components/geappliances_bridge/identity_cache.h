@@ -0,0 +1,88 @@
+/*!
+ * @file
+ * @brief Persisted record of the bus topology and device identity found at boot.
+ *
+ * Autodiscovery and device ID generation take tens of seconds. Once they have
+ * completed, the protocol, host addresses and device ID are saved in a record so
+ * that the next boot can start the bridge immediately and only verify the
+ * identity in the background.
+ */
+
+#ifndef identity_cache_h
+#define identity_cache_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum {
+  identity_cache_max_hosts = 8,
+  identity_cache_device_id_size = 112
+};
+
+enum {
+  identity_cache_protocol_gea3,
+  identity_cache_protocol_gea2
+};
+typedef uint8_t identity_cache_protocol_t;
+
+typedef struct {
+  uint32_t version;
+  uint32_t serial_number_hash;
+  uint8_t protocol;
+  uint8_t host_address;
+  uint8_t appliance_type;
+  uint8_t secondary_host_count;
+  uint8_t secondary_host_addresses[identity_cache_max_hosts - 1];
+  char device_id[identity_cache_device_id_size];
+  uint32_t checksum;
+} identity_cache_record_t;
+
+/*!
+ * Fill in a record for the given identity. The device ID is truncated if it does
+ * not fit; a truncated record is never valid.
+ */
+void identity_cache_record_init(
+  identity_cache_record_t* self,
+  identity_cache_protocol_t protocol,
+  uint8_t host_address,
+  uint8_t appliance_type,
+  const void* serial_number,
+  uint8_t serial_number_size,
+  const char* device_id);
+
+/*!
+ * Remember a secondary host found during autodiscovery. Returns false if the
+ * record is full.
+ */
+bool identity_cache_record_add_secondary_host(
+  identity_cache_record_t* self,
+  uint8_t address);
+
+/*!
+ * Seal the record after it has been filled in so that it can be persisted.
+ */
+void identity_cache_record_seal(
+  identity_cache_record_t* self);
+
+/*!
+ * Returns true if the record was sealed by this firmware and has not been corrupted.
+ */
+bool identity_cache_record_is_valid(
+  const identity_cache_record_t* self);
+
+/*!
+ * Mark the record as invalid so that the next boot runs full autodiscovery.
+ */
+void identity_cache_record_invalidate(
+  identity_cache_record_t* self);
+
+/*!
+ * Returns true if the serial number read back from the host is the one the
+ * record was created for.
+ */
+bool identity_cache_record_matches_serial_number(
+  const identity_cache_record_t* self,
+  const void* serial_number,
+  uint8_t serial_number_size);
+
+#endif
@@ -0,0 +1,119 @@
+/*!
+ * @file
+ * @brief Tracks ERD reads that have been handed to the ERD client by request ID.
+ */
+
+extern "C" {
+#include "in_flight_table.h"
+#include "tiny_gea_constants.h"
+}
+
+#include <cstring>
+
+// Oldest by issue time, preferring reads that have already expired
+static in_flight_request_t* entry_to_replace(in_flight_table_t* self, tiny_time_source_ticks_t now)
+{
+  in_flight_request_t* oldest = &self->requests[0];
+
+  for(uint8_t i = 1; i < in_flight_table_size; i++) {
+    in_flight_request_t* request = &self->requests[i];
+
+    if(request->expired != oldest->expired) {
+      if(request->expired) {
+        oldest = request;
+      }
+    }
+    else if(in_flight_request_age(request, now) > in_flight_request_age(oldest, now)) {
+      oldest = request;
+    }
+  }
+
+  return oldest;
+}
+
+void in_flight_table_init(
+  in_flight_table_t* self)
+{
+  memset(self, 0, sizeof(*self));
+}
+
+in_flight_request_t* in_flight_table_add(
+  in_flight_table_t* self,
+  tiny_gea3_erd_client_request_id_t request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  tiny_time_source_ticks_t issued_at,
+  uint8_t retries)
+{
+  in_flight_request_t* request = nullptr;
+
+  for(uint8_t i = 0; i < in_flight_table_size; i++) {
+    if(!self->requests[i].in_use) {
+      request = &self->requests[i];
+      break;
+    }
+  }
+
+  if(!request) {
+    request = entry_to_replace(self, issued_at);
+  }
+
+  request->issued_at = issued_at;
+  request->erd = erd;
+  request->request_id = request_id;
+  request->address = address;
+  request->retries = retries;
+  request->in_use = true;
+  request->expired = false;
+
+  return request;
+}
+
+in_flight_request_t* in_flight_table_match(
+  in_flight_table_t* self,
+  tiny_gea3_erd_client_request_id_t request_id,
+  uint8_t address,
+  tiny_erd_t erd)
+{
+  for(uint8_t i = 0; i < in_flight_table_size; i++) {
+    in_flight_request_t* request = &self->requests[i];
+
+    if(request->in_use && (request->request_id == request_id) && (request->erd == erd) &&
+      ((request->address == address) || (request->address == tiny_gea_broadcast_address))) {
+      return request;
+    }
+  }
+
+  self->orphaned_count++;
+  return nullptr;
+}
+
+void in_flight_table_expire(
+  in_flight_table_t* self,
+  in_flight_request_t* request)
+{
+  (void)self;
+  request->expired = true;
+}
+
+void in_flight_table_remove(
+  in_flight_table_t* self,
+  in_flight_request_t* request)
+{
+  (void)self;
+  request->in_use = false;
+}
+
+uint8_t in_flight_table_count(
+  in_flight_table_t* self)
+{
+  uint8_t count = 0;
+
+  for(uint8_t i = 0; i < in_flight_table_size; i++) {
+    if(self->requests[i].in_use) {
+      count++;
+    }
+  }
+
+  return count;
+}
@@ -0,0 +1,99 @@
+/*!
+ * @file
+ * @brief Tracks ERD reads that have been handed to the ERD client by request ID.
+ *
+ * A response is only accepted when its request ID, ERD and address match a read
+ * in the table, so a late response can no longer be mistaken for the answer to a
+ * newer read. Reads the caller has given up on stay in the table as expired until
+ * the ERD client finishes them, which lets a late but genuine response still be
+ * recognized as such. Responses that match nothing are counted as orphaned.
+ */
+
+#ifndef in_flight_table_h
+#define in_flight_table_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i_tiny_gea3_erd_client.h"
+#include "i_tiny_time_source.h"
+
+enum {
+  in_flight_table_size = 8
+};
+
+typedef struct {
+  tiny_time_source_ticks_t issued_at;
+  tiny_erd_t erd;
+  tiny_gea3_erd_client_request_id_t request_id;
+  uint8_t address;
+  uint8_t retries;
+  bool in_use;
+  bool expired;
+} in_flight_request_t;
+
+typedef struct {
+  in_flight_request_t requests[in_flight_table_size];
+  uint32_t orphaned_count;
+} in_flight_table_t;
+
+/*!
+ * Initialize an empty table.
+ */
+void in_flight_table_init(
+  in_flight_table_t* self);
+
+/*!
+ * Record a read the ERD client accepted. When the table is full the oldest
+ * expired read is dropped, or the oldest read if none has expired.
+ */
+in_flight_request_t* in_flight_table_add(
+  in_flight_table_t* self,
+  tiny_gea3_erd_client_request_id_t request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  tiny_time_source_ticks_t issued_at,
+  uint8_t retries);
+
+/*!
+ * Find the read a response belongs to. A read sent to the broadcast address
+ * matches a response from any address. Returns NULL and counts the response as
+ * orphaned if nothing matches.
+ */
+in_flight_request_t* in_flight_table_match(
+  in_flight_table_t* self,
+  tiny_gea3_erd_client_request_id_t request_id,
+  uint8_t address,
+  tiny_erd_t erd);
+
+/*!
+ * Mark a read as given up on by the caller; a response to it is late.
+ */
+void in_flight_table_expire(
+  in_flight_table_t* self,
+  in_flight_request_t* request);
+
+/*!
+ * Remove a finished read from the table.
+ */
+void in_flight_table_remove(
+  in_flight_table_t* self,
+  in_flight_request_t* request);
+
+/*!
+ * Number of reads in the table, expired or not.
+ */
+uint8_t in_flight_table_count(
+  in_flight_table_t* self);
+
+/*!
+ * Ticks since the read was issued. Timer group ticks wrap, so this is only
+ * correct for reads younger than one full wrap of the tick counter.
+ */
+static inline tiny_time_source_ticks_t in_flight_request_age(
+  const in_flight_request_t* request,
+  tiny_time_source_ticks_t now)
+{
+  return (tiny_time_source_ticks_t)(now - request->issued_at);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*!
+ * @file
+ * @brief Decides how fast the component loop needs to run and measures its duty cycle.
+ */
+
+extern "C" {
+#include "loop_pacing.h"
+}
+
+bool loop_pacing_needs_high_frequency(
+  tiny_timer_ticks_t ticks_until_next_timer,
+  bool transaction_in_flight)
+{
+  return transaction_in_flight || (ticks_until_next_timer < loop_pacing_regular_interval);
+}
+
+void loop_pacing_init(
+  loop_pacing_t* self)
+{
+  self->started = false;
+  loop_pacing_start_window(self, 0);
+}
+
+void loop_pacing_start_window(
+  loop_pacing_t* self,
+  uint32_t now_us)
+{
+  self->window_start_us = now_us;
+  self->busy_us = 0;
+  self->loops = 0;
+  self->high_frequency_loops = 0;
+}
+
+bool loop_pacing_record(
+  loop_pacing_t* self,
+  uint32_t start_us,
+  uint32_t end_us,
+  bool high_frequency)
+{
+  if(!self->started) {
+    self->started = true;
+    self->window_start_us = start_us;
+  }
+
+  // Unsigned subtraction stays correct across a wrap of the microsecond clock
+  self->busy_us += end_us - start_us;
+  self->loops++;
+  if(high_frequency) {
+    self->high_frequency_loops++;
+  }
+
+  return (end_us - self->window_start_us) >= loop_pacing_report_window_us;
+}
+
+uint16_t loop_pacing_duty_cycle_permille(
+  const loop_pacing_t* self,
+  uint32_t now_us)
+{
+  uint32_t elapsed_us = now_us - self->window_start_us;
+
+  if(elapsed_us == 0) {
+    return 0;
+  }
+
+  return static_cast<uint16_t>((static_cast<uint64_t>(self->busy_us) * 1000) / elapsed_us);
+}
@@ -0,0 +1,72 @@
+/*!
+ * @file
+ * @brief Decides how fast the component loop needs to run and measures its duty cycle.
+ *
+ * ESPHome runs component loops at a fixed interval unless a component asks for
+ * high-frequency looping. The bridge only needs that while a bus transaction is
+ * in flight or a timer is due before the next regular loop pass; otherwise it
+ * yields to the regular interval.
+ *
+ * The duty cycle is the share of wall time spent inside the loop, measured over
+ * a reporting window with a wrapping microsecond clock.
+ */
+
+#ifndef loop_pacing_h
+#define loop_pacing_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_timer.h"
+
+enum {
+  // ESPHome's default loop interval in milliseconds
+  loop_pacing_regular_interval = 16,
+  loop_pacing_report_window_us = 60000000
+};
+
+typedef struct {
+  uint32_t window_start_us;
+  uint32_t busy_us;
+  uint32_t loops;
+  uint32_t high_frequency_loops;
+  bool started;
+} loop_pacing_t;
+
+/*!
+ * Returns true if the loop should run at high frequency.
+ */
+bool loop_pacing_needs_high_frequency(
+  tiny_timer_ticks_t ticks_until_next_timer,
+  bool transaction_in_flight);
+
+/*!
+ * Initialize the duty cycle measurement.
+ */
+void loop_pacing_init(
+  loop_pacing_t* self);
+
+/*!
+ * Record one loop pass. Returns true once a full reporting window has been
+ * measured; the results stay available until loop_pacing_start_window is called.
+ */
+bool loop_pacing_record(
+  loop_pacing_t* self,
+  uint32_t start_us,
+  uint32_t end_us,
+  bool high_frequency);
+
+/*!
+ * Share of the measured window spent inside the loop, in tenths of a percent.
+ */
+uint16_t loop_pacing_duty_cycle_permille(
+  const loop_pacing_t* self,
+  uint32_t now_us);
+
+/*!
+ * Start a new measurement window.
+ */
+void loop_pacing_start_window(
+  loop_pacing_t* self,
+  uint32_t now_us);
+
+#endif
@@ -0,0 +1,38 @@
+/*!
+ * @file
+ * @brief Time source backed by clock_gettime(CLOCK_MONOTONIC).
+ */
+
+extern "C" {
+#include "monotonic_time_source.h"
+}
+
+#include <time.h>
+
+static wide_time_source_ticks_t ticks(i_wide_time_source_t* _self)
+{
+  auto self = reinterpret_cast<monotonic_time_source_t*>(_self);
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  // Truncating the 64-bit count gives the same wraparound as the device time sources
+  uint64_t count;
+  if(self->resolution == monotonic_time_source_resolution_microseconds) {
+    count = static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+  }
+  else {
+    count = static_cast<uint64_t>(now.tv_sec) * 1000 + static_cast<uint64_t>(now.tv_nsec) / 1000000;
+  }
+
+  return static_cast<wide_time_source_ticks_t>(count);
+}
+
+static const i_wide_time_source_api_t api = { ticks };
+
+void monotonic_time_source_init(
+  monotonic_time_source_t* self,
+  monotonic_time_source_resolution_t resolution)
+{
+  self->interface.api = &api;
+  self->resolution = resolution;
+}
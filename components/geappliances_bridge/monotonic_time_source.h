@@ -0,0 +1,35 @@
+/*!
+ * @file
+ * @brief Time source backed by clock_gettime(CLOCK_MONOTONIC).
+ *
+ * Used where ESPHome's millis() and micros() are not available, such as Linux
+ * host builds and tests. Ticks are either milliseconds or microseconds and wrap
+ * like their ESPHome counterparts, so only differences between ticks are
+ * meaningful.
+ */
+
+#ifndef monotonic_time_source_h
+#define monotonic_time_source_h
+
+#include <stdint.h>
+#include "i_wide_time_source.h"
+
+enum {
+  monotonic_time_source_resolution_milliseconds,
+  monotonic_time_source_resolution_microseconds
+};
+typedef uint8_t monotonic_time_source_resolution_t;
+
+typedef struct {
+  i_wide_time_source_t interface;
+  monotonic_time_source_resolution_t resolution;
+} monotonic_time_source_t;
+
+/*!
+ * Initialize the time source with the given tick resolution.
+ */
+void monotonic_time_source_init(
+  monotonic_time_source_t* self,
+  monotonic_time_source_resolution_t resolution);
+
+#endif
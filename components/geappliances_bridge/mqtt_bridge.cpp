@@ -8,9 +8,7 @@ extern "C" {
 #include "tiny_utils.h"
 }
 
-#include <set>
-
-using namespace std;
+#include <cstring>
 
 // GEA3 protocol constants
 enum {
@@ -29,30 +27,98 @@ enum {
   signal_write_requested
 };
 
-static void arm_timer(mqtt_bridge_t* self, tiny_timer_ticks_t ticks)
+static void arm_timer(mqtt_bridge_host_t* host, tiny_timer_ticks_t ticks)
 {
+  auto self = reinterpret_cast<mqtt_bridge_t*>(host->bridge);
+
   tiny_timer_start(
-    self->timer_group, &self->timer, ticks, self, +[](void* context) {
-      tiny_hsm_send_signal(&reinterpret_cast<mqtt_bridge_t*>(context)->hsm, signal_timer_expired, nullptr);
+    self->timer_group, &host->timer, ticks, host, +[](void* context) {
+      tiny_hsm_send_signal(&reinterpret_cast<mqtt_bridge_host_t*>(context)->hsm, signal_timer_expired, nullptr);
     });
 }
 
-static void arm_periodic_timer(mqtt_bridge_t* self, tiny_timer_ticks_t ticks)
+static void disarm_timer(mqtt_bridge_host_t* host)
 {
-  tiny_timer_start_periodic(
-    self->timer_group, &self->timer, ticks, self, +[](void* context) {
-      tiny_hsm_send_signal(&reinterpret_cast<mqtt_bridge_t*>(context)->hsm, signal_timer_expired, nullptr);
-    });
+  auto self = reinterpret_cast<mqtt_bridge_t*>(host->bridge);
+  tiny_timer_stop(self->timer_group, &host->timer);
+}
+
+static bool host_is_managed(mqtt_bridge_t* self, uint8_t address)
+{
+  return self->host_bitmap[address / 8] & (1 << (address % 8));
+}
+
+static mqtt_bridge_host_t* find_host(mqtt_bridge_t* self, uint8_t address)
+{
+  if(!host_is_managed(self, address)) {
+    return nullptr;
+  }
+
+  for(uint8_t i = 0; i < self->host_count; i++) {
+    if(self->hosts[i].address == address) {
+      return &self->hosts[i];
+    }
+  }
+
+  return nullptr;
+}
+
+enum {
+  registration_existing,
+  registration_new,
+  registration_no_room
+};
+typedef uint8_t registration_t;
+
+// Marks the ERD as registered if there is room to remember it
+static registration_t register_erd(mqtt_bridge_host_t* host, tiny_erd_t erd)
+{
+  uint16_t index = erdIndex(erd);
+
+  if(index != UNKNOWN_ERD_INDEX) {
+    return erd_bitset_insert(&host->registered_erds, index) ? registration_new : registration_existing;
+  }
+
+  for(uint8_t i = 0; i < host->unknown_erd_count; i++) {
+    if(host->unknown_erds[i] == erd) {
+      return registration_existing;
+    }
+  }
+
+  if(host->unknown_erd_count < mqtt_bridge_max_unknown_erds) {
+    host->unknown_erds[host->unknown_erd_count++] = erd;
+    return registration_new;
+  }
+
+  return registration_no_room;
 }
 
-static void disarm_timer(mqtt_bridge_t* self)
+static void forget_registered_erds(mqtt_bridge_host_t* host)
 {
-  tiny_timer_stop(self->timer_group, &self->timer);
+  erd_bitset_clear(&host->registered_erds);
+  host->unknown_erd_count = 0;
 }
 
-static set<tiny_erd_t>& erd_set(mqtt_bridge_t* self)
+static void handle_publication(mqtt_bridge_host_t* host, const tiny_gea3_erd_client_on_activity_args_t* args)
 {
-  return *reinterpret_cast<set<tiny_erd_t>*>(self->erd_set);
+  auto erd = args->subscription_publication_received.erd;
+
+  switch(register_erd(host, erd)) {
+    case registration_new:
+      mqtt_client_register_erd(host->mqtt_client, erd);
+      break;
+
+    // Registering an ERD that cannot be remembered would register it again on every publication
+    case registration_no_room:
+      reinterpret_cast<mqtt_bridge_t*>(host->bridge)->dropped_publication_count++;
+      return;
+  }
+
+  mqtt_client_update_erd(
+    host->mqtt_client,
+    erd,
+    args->subscription_publication_received.data,
+    args->subscription_publication_received.data_size);
 }
 
 static tiny_hsm_result_t state_top(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data);
@@ -61,29 +127,25 @@ static tiny_hsm_result_t state_subscribed(tiny_hsm_t* hsm, tiny_hsm_signal_t sig
 
 static tiny_hsm_result_t state_top(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data)
 {
-  mqtt_bridge_t* self = container_of(mqtt_bridge_t, hsm, hsm);
+  mqtt_bridge_host_t* host = container_of(mqtt_bridge_host_t, hsm, hsm);
+  auto self = reinterpret_cast<mqtt_bridge_t*>(host->bridge);
 
   switch(signal) {
-    case signal_subscription_publication_received: {
-      auto args = reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(data);
-      auto erd = args->subscription_publication_received.erd;
-
-      if(erd_set(self).find(erd) == erd_set(self).end()) {
-        mqtt_client_register_erd(self->mqtt_client, erd);
-        erd_set(self).insert(erd);
-      }
-
-      mqtt_client_update_erd(
-        self->mqtt_client,
-        erd,
-        args->subscription_publication_received.data,
-        args->subscription_publication_received.data_size);
-    } break;
+    case signal_subscription_publication_received:
+      handle_publication(host, reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(data));
+      break;
 
     case signal_write_requested: {
       auto args = reinterpret_cast<const mqtt_client_on_write_request_args_t*>(data);
       tiny_gea3_erd_client_request_id_t request_id;
-      tiny_gea3_erd_client_write(self->erd_client, &request_id, self->erd_host_address, args->erd, args->value, args->size);
+
+      // Writes the appliance is documented to reject never reach the bus
+      if(!erdWriteIsValid(args->erd, args->size)) {
+        mqtt_client_update_erd_write_result(host->mqtt_client, args->erd, false, tiny_gea3_erd_client_write_failure_reason_not_supported);
+      }
+      else if(!tiny_gea3_erd_client_write(self->erd_client, &request_id, host->address, args->erd, args->value, args->size)) {
+        mqtt_client_update_erd_write_result(host->mqtt_client, args->erd, false, tiny_gea3_erd_client_write_failure_reason_retries_exhausted);
+      }
     } break;
 
     default:
@@ -95,15 +157,16 @@ static tiny_hsm_result_t state_top(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, co
 
 static tiny_hsm_result_t state_subscribing(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data)
 {
-  mqtt_bridge_t* self = container_of(mqtt_bridge_t, hsm, hsm);
+  mqtt_bridge_host_t* host = container_of(mqtt_bridge_host_t, hsm, hsm);
+  auto self = reinterpret_cast<mqtt_bridge_t*>(host->bridge);
   (void)data;
 
   switch(signal) {
     case tiny_hsm_signal_entry:
     case signal_subscription_failed:
     case signal_timer_expired:
-      if(!tiny_gea3_erd_client_subscribe(self->erd_client, self->erd_host_address)) {
-        arm_timer(self, resubscribe_delay);
+      if(!tiny_gea3_erd_client_subscribe(self->erd_client, host->address)) {
+        arm_timer(host, resubscribe_delay);
       }
       break;
 
@@ -112,7 +175,7 @@ static tiny_hsm_result_t state_subscribing(tiny_hsm_t* hsm, tiny_hsm_signal_t si
       break;
 
     case tiny_hsm_signal_exit:
-      disarm_timer(self);
+      disarm_timer(host);
       break;
 
     default:
@@ -124,17 +187,23 @@ static tiny_hsm_result_t state_subscribing(tiny_hsm_t* hsm, tiny_hsm_signal_t si
 
 static tiny_hsm_result_t state_subscribed(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data)
 {
-  mqtt_bridge_t* self = container_of(mqtt_bridge_t, hsm, hsm);
+  mqtt_bridge_host_t* host = container_of(mqtt_bridge_host_t, hsm, hsm);
+  auto self = reinterpret_cast<mqtt_bridge_t*>(host->bridge);
   (void)data;
-  (void)self;
 
   switch(signal) {
     case tiny_hsm_signal_entry:
-      arm_periodic_timer(self, subscription_retention_period);
+      arm_timer(host, subscription_retention_period);
       break;
 
+    // A retention the client cannot queue is tried again sooner
     case signal_timer_expired:
-      tiny_gea3_erd_client_retain_subscription(self->erd_client, self->erd_host_address);
+      if(tiny_gea3_erd_client_retain_subscription(self->erd_client, host->address)) {
+        arm_timer(host, subscription_retention_period);
+      }
+      else {
+        arm_timer(host, resubscribe_delay);
+      }
       break;
 
     case signal_subscription_host_came_online:
@@ -143,7 +212,7 @@ static tiny_hsm_result_t state_subscribed(tiny_hsm_t* hsm, tiny_hsm_signal_t sig
       break;
 
     case tiny_hsm_signal_exit:
-      disarm_timer(self);
+      disarm_timer(host);
       break;
 
     default:
@@ -163,6 +232,30 @@ static const tiny_hsm_configuration_t hsm_configuration = {
   .state_count = element_count(hsm_state_descriptors)
 };
 
+static void subscribe_to_write_requests(mqtt_bridge_host_t* host)
+{
+  tiny_event_subscription_init(
+    &host->mqtt_write_request_subscription, host, +[](void* context, const void* args) {
+      tiny_hsm_send_signal(&reinterpret_cast<mqtt_bridge_host_t*>(context)->hsm, signal_write_requested, args);
+    });
+  tiny_event_subscribe(mqtt_client_on_write_request(host->mqtt_client), &host->mqtt_write_request_subscription);
+}
+
+static mqtt_bridge_host_t* add_host(mqtt_bridge_t* self, uint8_t address, i_mqtt_client_t* mqtt_client)
+{
+  mqtt_bridge_host_t* host = &self->hosts[self->host_count++];
+  host->bridge = self;
+  host->address = address;
+  host->mqtt_client = mqtt_client;
+  forget_registered_erds(host);
+  self->host_bitmap[address / 8] |= (1 << (address % 8));
+
+  subscribe_to_write_requests(host);
+  tiny_hsm_init(&host->hsm, &hsm_configuration, state_subscribing);
+
+  return host;
+}
+
 void mqtt_bridge_init(
   mqtt_bridge_t* self,
   tiny_timer_group_t* timer_group,
@@ -173,66 +266,86 @@ void mqtt_bridge_init(
   self->timer_group = timer_group;
   self->erd_client = erd_client;
   self->mqtt_client = mqtt_client;
-  self->erd_host_address = address;
-  self->erd_set = reinterpret_cast<void*>(new set<tiny_erd_t>());
+  self->host_count = 0;
+  self->dropped_publication_count = 0;
+  memset(self->host_bitmap, 0, sizeof(self->host_bitmap));
 
   tiny_event_subscription_init(
     &self->erd_client_activity_subscription, self, +[](void* context, const void* _args) {
       auto self = reinterpret_cast<mqtt_bridge_t*>(context);
       auto args = reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(_args);
 
-      if(args->address != self->erd_host_address) {
+      auto host = find_host(self, args->address);
+      if(!host) {
         return;
       }
 
       switch(args->type) {
         case tiny_gea3_erd_client_activity_type_subscription_added_or_retained:
-          tiny_hsm_send_signal(&self->hsm, signal_subscription_added_or_retained, nullptr);
+          tiny_hsm_send_signal(&host->hsm, signal_subscription_added_or_retained, nullptr);
           break;
 
         case tiny_gea3_erd_client_activity_type_subscription_publication_received:
-          tiny_hsm_send_signal(&self->hsm, signal_subscription_publication_received, args);
+          tiny_hsm_send_signal(&host->hsm, signal_subscription_publication_received, args);
           break;
 
         case tiny_gea3_erd_client_activity_type_subscription_host_came_online:
-          tiny_hsm_send_signal(&self->hsm, signal_subscription_host_came_online, nullptr);
+          tiny_hsm_send_signal(&host->hsm, signal_subscription_host_came_online, nullptr);
           break;
 
         case tiny_gea3_erd_client_activity_type_subscribe_failed:
-          tiny_hsm_send_signal(&self->hsm, signal_subscription_failed, nullptr);
+          tiny_hsm_send_signal(&host->hsm, signal_subscription_failed, nullptr);
           break;
 
         case tiny_gea3_erd_client_activity_type_write_completed:
-          mqtt_client_update_erd_write_result(self->mqtt_client, args->write_completed.erd, true, 0);
+          mqtt_client_update_erd_write_result(host->mqtt_client, args->write_completed.erd, true, 0);
           break;
 
         case tiny_gea3_erd_client_activity_type_write_failed:
-          mqtt_client_update_erd_write_result(self->mqtt_client, args->write_failed.erd, false, args->write_failed.reason);
+          mqtt_client_update_erd_write_result(host->mqtt_client, args->write_failed.erd, false, args->write_failed.reason);
           break;
       }
     });
   tiny_event_subscribe(tiny_gea3_erd_client_on_activity(erd_client), &self->erd_client_activity_subscription);
 
-  tiny_event_subscription_init(
-    &self->mqtt_write_request_subscription, self, +[](void* context, const void* _args) {
-      auto self = reinterpret_cast<mqtt_bridge_t*>(context);
-      auto args = reinterpret_cast<const mqtt_client_on_write_request_args_t*>(_args);
-      tiny_hsm_send_signal(&self->hsm, signal_write_requested, args);
-    });
-  tiny_event_subscribe(mqtt_client_on_write_request(mqtt_client), &self->mqtt_write_request_subscription);
-
   tiny_event_subscription_init(
     &self->mqtt_disconnect_subscription, self, +[](void* context, const void*) {
       auto self = reinterpret_cast<mqtt_bridge_t*>(context);
-      reinterpret_cast<set<tiny_erd_t>*>(self->erd_set)->clear();
-      tiny_hsm_send_signal(&self->hsm, signal_mqtt_disconnected, nullptr);
+      for(uint8_t i = 0; i < self->host_count; i++) {
+        forget_registered_erds(&self->hosts[i]);
+        tiny_hsm_send_signal(&self->hosts[i].hsm, signal_mqtt_disconnected, nullptr);
+      }
     });
   tiny_event_subscribe(mqtt_client_on_mqtt_disconnect(mqtt_client), &self->mqtt_disconnect_subscription);
 
-  tiny_hsm_init(&self->hsm, &hsm_configuration, state_subscribing);
+  add_host(self, address, mqtt_client);
+}
+
+bool mqtt_bridge_add_host(
+  mqtt_bridge_t* self,
+  uint8_t address)
+{
+  if((self->host_count >= mqtt_bridge_max_hosts) || host_is_managed(self, address)) {
+    return false;
+  }
+
+  i_mqtt_client_t* host_client = mqtt_client_for_host(self->mqtt_client, address);
+  if(host_client == nullptr) {
+    return false;
+  }
+
+  add_host(self, address, host_client);
+  return true;
 }
 
 void mqtt_bridge_destroy(mqtt_bridge_t* self)
 {
-  delete reinterpret_cast<set<tiny_erd_t>*>(self->erd_set);
+  tiny_event_unsubscribe(tiny_gea3_erd_client_on_activity(self->erd_client), &self->erd_client_activity_subscription);
+  tiny_event_unsubscribe(mqtt_client_on_mqtt_disconnect(self->mqtt_client), &self->mqtt_disconnect_subscription);
+
+  for(uint8_t i = 0; i < self->host_count; i++) {
+    disarm_timer(&self->hosts[i]);
+    tiny_event_unsubscribe(mqtt_client_on_write_request(self->hosts[i].mqtt_client), &self->hosts[i].mqtt_write_request_subscription);
+  }
+  self->host_count = 0;
 }
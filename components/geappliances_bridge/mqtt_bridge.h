@@ -1,31 +1,55 @@
 /*!
  * @file
  * @brief Pushes published ERDs to and fulfills write requests from an MQTT server.
+ *
+ * A single bridge manages subscriptions for every host board on the bus. ERD
+ * client activity is dispatched to the host it came from, and each host runs its
+ * own subscription state machine with its own timer.
  */
 
 #ifndef mqtt_bridge_h
 #define mqtt_bridge_h
 
+#include "erd_bitset.h"
 #include "i_mqtt_client.h"
 #include "i_tiny_gea3_erd_client.h"
 #include "tiny_hsm.h"
 #include "tiny_timer.h"
 
+enum {
+  mqtt_bridge_max_hosts = 8,
+
+  // Published ERDs missing from erd_lists.h that are registered per host; publications of any more are dropped
+  mqtt_bridge_max_unknown_erds = 16
+};
+
 typedef struct {
-  tiny_timer_group_t* timer_group;
-  i_tiny_gea3_erd_client_t* erd_client;
+  void* bridge;
   i_mqtt_client_t* mqtt_client;
+  tiny_hsm_t hsm;
   tiny_timer_t timer;
   tiny_event_subscription_t mqtt_write_request_subscription;
+  erd_bitset_t registered_erds;
+  tiny_erd_t unknown_erds[mqtt_bridge_max_unknown_erds];
+  uint8_t unknown_erd_count;
+  uint8_t address;
+} mqtt_bridge_host_t;
+
+typedef struct {
+  tiny_timer_group_t* timer_group;
+  i_tiny_gea3_erd_client_t* erd_client;
+  i_mqtt_client_t* mqtt_client;
   tiny_event_subscription_t mqtt_disconnect_subscription;
   tiny_event_subscription_t erd_client_activity_subscription;
-  void* erd_set;
-  tiny_hsm_t hsm;
-  uint8_t erd_host_address;
+  mqtt_bridge_host_t hosts[mqtt_bridge_max_hosts];
+  uint8_t host_count;
+  uint8_t host_bitmap[256 / 8];
+  uint32_t dropped_publication_count;
 } mqtt_bridge_t;
 
 /*!
- * Initialize the MQTT bridge.
+ * Initialize the MQTT bridge. The given address is the primary host; its ERDs
+ * are published in the root namespace of the MQTT client.
  */
 void mqtt_bridge_init(
   mqtt_bridge_t* self,
@@ -34,6 +58,15 @@ void mqtt_bridge_init(
   i_mqtt_client_t* mqtt_client,
   uint8_t address);
 
+/*!
+ * Add another host (e.g. a secondary board found by autodiscovery). Its ERDs are
+ * published in a per-host namespace of the MQTT client. Returns false if the host
+ * table is full or the MQTT client cannot provide a namespace for the host.
+ */
+bool mqtt_bridge_add_host(
+  mqtt_bridge_t* self,
+  uint8_t address);
+
 /*!
  * Destroy the MQTT bridge.
  */
@@ -11,45 +11,78 @@ extern "C" {
 
 #include "erd_lists.h"
 #include <cstring>
-#include <map>
-#include <set>
-#include <vector>
-
-using namespace std;
 
 // GEA3 protocol constants
 enum {
   erd_host_address = 0xC0,  // Default address for GE appliance host
-  retry_delay = 100,         // Delay in ms before retrying read
   appliance_lost_timeout = 60000,  // 60 seconds timeout for appliance loss
   max_polling_retries = 3    // Maximum retries before restarting polling cycle
 };
 
+// Room left in the sealed value cache for discovery reads answered after polling has started
+enum {
+  late_erd_cache_entries = 8,
+  late_erd_cache_bytes = 256
+};
+
 enum {
   signal_start = tiny_hsm_signal_user_start,
   signal_timer_expired,
   signal_polling_timer_expired,
   signal_read_failed,
   signal_read_completed,
+  signal_late_read_completed,
   signal_mqtt_disconnected,
   signal_appliance_lost,
   signal_write_requested
 };
 
-// Common ERDs that most appliances support
-static const tiny_erd_t common_erds[] = {
-  0x0001, 0x0002, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009,
-  0x000a, 0x000e, 0x0030, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036,
-  0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e,
-  0x003f, 0x004e, 0x004f, 0x0050, 0x0051, 0x0052
-};
-static const uint16_t common_erd_count = sizeof(common_erds) / sizeof(common_erds[0]);
+static tiny_time_source_ticks_t now(mqtt_bridge_polling_t* self)
+{
+  return tiny_time_source_ticks(self->timer_group->time_source);
+}
+
+// The state machine stops waiting for the current read; a response to it is late from now on
+static void give_up_on_current_read(mqtt_bridge_polling_t* self)
+{
+  if(self->current_read) {
+    mqtt_bridge_polling_on_read_abandoned_args_t args = { self->current_read->request_id };
+    in_flight_table_expire(&self->in_flight, self->current_read);
+    self->current_read = nullptr;
+    tiny_event_publish(&self->on_read_abandoned, &args);
+  }
+}
+
+// Sends a read and tracks it as the one the state machine is waiting for
+static bool send_read(mqtt_bridge_polling_t* self, tiny_erd_t erd, uint8_t retries)
+{
+  give_up_on_current_read(self);
+
+  self->request_id++;
+  if(!tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, erd)) {
+    return false;
+  }
+
+  self->current_read = in_flight_table_add(&self->in_flight, self->request_id, self->erd_host_address, erd, now(self), retries);
+  return true;
+}
+
+// How long to wait for the host before moving on, from how quickly it has been answering
+static tiny_timer_ticks_t read_timeout(mqtt_bridge_polling_t* self)
+{
+  return rtt_estimator_timeout(&self->read_timeouts, self->erd_host_address);
+}
 
 static void arm_timer(mqtt_bridge_polling_t* self, tiny_timer_ticks_t ticks)
 {
   tiny_timer_start(
     self->timer_group, &self->timer, ticks, self, +[](void* context) {
-      tiny_hsm_send_signal(&reinterpret_cast<mqtt_bridge_polling_t*>(context)->hsm, signal_timer_expired, nullptr);
+      auto self = reinterpret_cast<mqtt_bridge_polling_t*>(context);
+      if(self->current_read) {
+        rtt_estimator_back_off(&self->read_timeouts, self->current_read->address);
+      }
+      give_up_on_current_read(self);
+      tiny_hsm_send_signal(&self->hsm, signal_timer_expired, nullptr);
     });
 }
 
@@ -75,14 +108,23 @@ static void disarm_timer(mqtt_bridge_polling_t* self)
   tiny_timer_stop(self->timer_group, &self->timer);
 }
 
-static set<tiny_erd_t>& erd_set(mqtt_bridge_polling_t* self)
+// Every ERD the bridge reads has a dense index; generate_erd_lists.py also indexes probedCommonErds
+static void add_erd_to_polling_list(mqtt_bridge_polling_t* self, tiny_erd_t erd, uint8_t data_size)
 {
-  return *reinterpret_cast<set<tiny_erd_t>*>(self->erd_set);
-}
+  uint16_t index = erdIndex(erd);
+  if(index == UNKNOWN_ERD_INDEX) {
+    return;
+  }
 
-static map<tiny_erd_t, vector<uint8_t>>& erd_cache(mqtt_bridge_polling_t* self)
-{
-  return *reinterpret_cast<map<tiny_erd_t, vector<uint8_t>>*>(self->erd_cache);
+  if(erd_bitset_insert(&self->registered_erds, index)) {
+    mqtt_client_register_erd(self->mqtt_client, erd);
+  }
+  erd_bitset_insert(&self->polled_erds, index);
+
+  // Discovery sizes the value cache; it is sealed once polling starts
+  if(self->only_publish_on_change) {
+    erd_value_cache_reserve(&self->erd_cache, erd, data_size);
+  }
 }
 
 static tiny_hsm_result_t state_top(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data);
@@ -99,13 +141,34 @@ static tiny_hsm_result_t state_top(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, co
   switch(signal) {
     case signal_write_requested: {
       auto args = reinterpret_cast<const mqtt_client_on_write_request_args_t*>(data);
-      tiny_gea3_erd_client_write(self->erd_client, &self->request_id, self->erd_host_address, args->erd, args->value, args->size);
+      // Writes are not tracked; request_id belongs to the reads in flight
+      tiny_gea3_erd_client_request_id_t request_id;
+
+      // Writes the appliance is documented to reject never reach the bus
+      if(!erdWriteIsValid(args->erd, args->size)) {
+        mqtt_client_update_erd_write_result(self->mqtt_client, args->erd, false, tiny_gea3_erd_client_write_failure_reason_not_supported);
+      }
+      else if(!tiny_gea3_erd_client_write(self->erd_client, &request_id, self->erd_host_address, args->erd, args->value, args->size)) {
+        mqtt_client_update_erd_write_result(self->mqtt_client, args->erd, false, tiny_gea3_erd_client_write_failure_reason_retries_exhausted);
+      }
     } break;
 
     case signal_appliance_lost: {
       tiny_hsm_transition(hsm, state_identify_appliance);
     } break;
 
+    // A response to a read the state machine already gave up on is still a real value
+    case signal_late_read_completed: {
+      auto args = reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(data);
+      reset_lost_appliance_timer(self);
+      add_erd_to_polling_list(self, args->read_completed.erd, args->read_completed.data_size);
+      mqtt_client_update_erd(
+        self->mqtt_client,
+        args->read_completed.erd,
+        args->read_completed.data,
+        args->read_completed.data_size);
+    } break;
+
     default:
       return tiny_hsm_result_signal_deferred;
   }
@@ -121,15 +184,25 @@ static tiny_hsm_result_t state_identify_appliance(tiny_hsm_t* hsm, tiny_hsm_sign
   switch(signal) {
     case tiny_hsm_signal_entry: {
       self->erd_host_address = tiny_gea_broadcast_address;
+      self->read_retries = 0;
+      send_read(self, 0x0008, self->read_retries);
+      arm_timer(self, read_timeout(self));
+      break;
     }
-      __attribute__((fallthrough));
 
     case signal_timer_expired: {
-      tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, 0x0008);
-      arm_timer(self, retry_delay);
+      send_read(self, 0x0008, ++self->read_retries);
+      arm_timer(self, read_timeout(self));
       break;
     }
 
+    case signal_late_read_completed:
+      if(args->read_completed.erd != 0x0008) {
+        return tiny_hsm_result_signal_deferred;
+      }
+      // Any board's answer to an earlier broadcast identifies the appliance just as well
+      __attribute__((fallthrough));
+
     case signal_read_completed: {
       disarm_timer(self);
       reset_lost_appliance_timer(self);
@@ -155,33 +228,29 @@ static tiny_hsm_result_t state_identify_appliance(tiny_hsm_t* hsm, tiny_hsm_sign
   return tiny_hsm_result_signal_consumed;
 }
 
+// A read that the client cannot queue is tried again when the timer expires
+// instead of moving on to the next ERD. A list that was left out of erd_lists.h
+// is empty and simply ends when the timer expires.
+static void read_current_erd(mqtt_bridge_polling_t* self)
+{
+  self->read_queued = erdListIteratorDone(&self->discovery_erds) ||
+    send_read(self, erdListIteratorErd(&self->discovery_erds), 0);
+  arm_timer(self, read_timeout(self));
+}
+
 static bool send_next_read_request(mqtt_bridge_polling_t* self)
 {
   reset_lost_appliance_timer(self);
-  self->erd_index++;
-  bool more_erds_to_try = (self->erd_index < self->appliance_erd_list_count);
+  if(self->read_queued) {
+    erdListIteratorNext(&self->discovery_erds);
+  }
+  bool more_erds_to_try = !erdListIteratorDone(&self->discovery_erds);
   if(more_erds_to_try) {
-    self->request_id++;
-    tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, self->appliance_erd_list[self->erd_index]);
-    arm_timer(self, retry_delay);
+    read_current_erd(self);
   }
   return more_erds_to_try;
 }
 
-static void add_erd_to_polling_list(mqtt_bridge_polling_t* self, tiny_erd_t erd)
-{
-  if(erd_set(self).find(erd) == erd_set(self).end()) {
-    mqtt_client_register_erd(self->mqtt_client, erd);
-    erd_set(self).insert(erd);
-    
-    // Only add to polling list if not already present and there's space
-    if (self->polling_list_count < POLLING_LIST_MAX_SIZE) {
-      self->erd_polling_list[self->polling_list_count] = erd;
-      self->polling_list_count++;
-    }
-  }
-}
-
 static tiny_hsm_result_t state_add_common_erds(tiny_hsm_t* hsm, tiny_hsm_signal_t signal, const void* data)
 {
   mqtt_bridge_polling_t* self = container_of(mqtt_bridge_polling_t, hsm, hsm);
@@ -189,12 +258,10 @@ static tiny_hsm_result_t state_add_common_erds(tiny_hsm_t* hsm, tiny_hsm_signal_
 
   switch(signal) {
     case tiny_hsm_signal_entry:
-      self->appliance_erd_list = common_erds;
-      self->appliance_erd_list_count = common_erd_count;
-      self->erd_index = 0;
-      self->polling_list_count = 0;
-      tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, self->appliance_erd_list[self->erd_index]);
-      arm_timer(self, retry_delay);
+      self->discovery_erds = erdListBegin(&probedCommonErds);
+      erd_bitset_clear(&self->polled_erds);
+      erd_value_cache_clear(&self->erd_cache);
+      read_current_erd(self);
       break;
 
     case signal_timer_expired:
@@ -205,7 +272,7 @@ static tiny_hsm_result_t state_add_common_erds(tiny_hsm_t* hsm, tiny_hsm_signal_
 
     case signal_read_completed:
       disarm_timer(self);
-      add_erd_to_polling_list(self, args->read_completed.erd);
+      add_erd_to_polling_list(self, args->read_completed.erd, args->read_completed.data_size);
       mqtt_client_update_erd(
         self->mqtt_client,
         args->read_completed.erd,
@@ -231,12 +298,9 @@ static tiny_hsm_result_t state_add_energy_erds(tiny_hsm_t* hsm, tiny_hsm_signal_
 
   switch(signal) {
     case tiny_hsm_signal_entry:
-      self->appliance_erd_list = energyErds;
-      self->appliance_erd_list_count = energyErdCount;
-      self->erd_index = 0;
+      self->discovery_erds = erdListBegin(&energyErds);
 
-      tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, self->appliance_erd_list[self->erd_index]);
-      arm_timer(self, retry_delay);
+      read_current_erd(self);
       break;
 
     case signal_timer_expired:
@@ -247,7 +311,7 @@ static tiny_hsm_result_t state_add_energy_erds(tiny_hsm_t* hsm, tiny_hsm_signal_
 
     case signal_read_completed:
       disarm_timer(self);
-      add_erd_to_polling_list(self, args->read_completed.erd);
+      add_erd_to_polling_list(self, args->read_completed.erd, args->read_completed.data_size);
       mqtt_client_update_erd(
         self->mqtt_client,
         args->read_completed.erd,
@@ -278,12 +342,9 @@ static tiny_hsm_result_t state_add_appliance_erds(tiny_hsm_t* hsm, tiny_hsm_sign
         self->appliance_type = 0;  // Default to first entry if out of range
       }
       
-      self->appliance_erd_list = applianceTypeToErdGroupTranslation[self->appliance_type].erdList;
-      self->appliance_erd_list_count = applianceTypeToErdGroupTranslation[self->appliance_type].erdCount;
-      self->erd_index = 0;
+      self->discovery_erds = erdListBegin(applianceTypeToErdGroupTranslation[self->appliance_type]);
 
-      tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, self->appliance_erd_list[self->erd_index]);
-      arm_timer(self, retry_delay);
+      read_current_erd(self);
       break;
 
     case signal_timer_expired:
@@ -294,7 +355,7 @@ static tiny_hsm_result_t state_add_appliance_erds(tiny_hsm_t* hsm, tiny_hsm_sign
 
     case signal_read_completed:
       disarm_timer(self);
-      add_erd_to_polling_list(self, args->read_completed.erd);
+      add_erd_to_polling_list(self, args->read_completed.erd, args->read_completed.data_size);
       mqtt_client_update_erd(
         self->mqtt_client,
         args->read_completed.erd,
@@ -313,13 +374,40 @@ static tiny_hsm_result_t state_add_appliance_erds(tiny_hsm_t* hsm, tiny_hsm_sign
   return tiny_hsm_result_signal_consumed;
 }
 
+// In the polling state erd_index is a dense ERD index, so each cycle reads the polled ERDs in ascending order
+static bool poll_cycle_is_complete(mqtt_bridge_polling_t* self)
+{
+  return erd_bitset_next(&self->polled_erds, self->erd_index) >= KNOWN_ERD_COUNT;
+}
+
 static void send_next_poll_read_request(mqtt_bridge_polling_t* self)
 {
-  if(self->erd_index < self->polling_list_count) {
-    self->request_id++;
-    tiny_gea3_erd_client_read(self->erd_client, &self->request_id, self->erd_host_address, self->erd_polling_list[self->erd_index]);
-    self->erd_index++;
-    arm_timer(self, retry_delay);
+  uint16_t index = erd_bitset_next(&self->polled_erds, self->erd_index);
+
+  if(index < KNOWN_ERD_COUNT) {
+    self->erd_index = index;
+
+    // Only move on once the read is queued; otherwise the timer tries the same ERD again
+    if(send_read(self, erdAtIndex(index), 0)) {
+      self->erd_index++;
+    }
+    arm_timer(self, read_timeout(self));
+  }
+}
+
+static void publish_polled_erd(mqtt_bridge_polling_t* self, const tiny_gea3_erd_client_on_activity_args_t* args)
+{
+  tiny_erd_t erd = args->read_completed.erd;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(args->read_completed.data);
+  uint8_t data_size = args->read_completed.data_size;
+  // Register any ERD that arrives here for the first time. This handles
+  // late discovery responses that arrive after the transition to polling
+  // state (when the device takes longer than the read timeout to respond).
+  add_erd_to_polling_list(self, erd, data_size);
+  bool should_publish = !self->only_publish_on_change ||
+    erd_value_cache_update(&self->erd_cache, erd, data, data_size);
+  if(should_publish) {
+    mqtt_client_update_erd(self->mqtt_client, erd, data, data_size);
   }
 }
 
@@ -330,7 +418,13 @@ static tiny_hsm_result_t state_polling(tiny_hsm_t* hsm, tiny_hsm_signal_t signal
 
   switch(signal) {
     case tiny_hsm_signal_entry:
-      erd_cache(self).clear();
+      // Every ERD is published on the first cycle; discovery only laid out the cache.
+      // Sealing it leaves polling with nothing to allocate.
+      if(self->only_publish_on_change) {
+        erd_value_cache_seal(&self->erd_cache, late_erd_cache_entries, late_erd_cache_bytes);
+        erd_value_cache_invalidate(&self->erd_cache);
+      }
+      self->erd_index = 0;
       arm_polling_timer(self, self->polling_interval_ms);
       __attribute__((fallthrough));
 
@@ -339,7 +433,7 @@ static tiny_hsm_result_t state_polling(tiny_hsm_t* hsm, tiny_hsm_signal_t signal
       break;
 
     case signal_polling_timer_expired:
-      if((self->erd_index >= self->polling_list_count) || (self->polling_retries >= max_polling_retries)) {
+      if(poll_cycle_is_complete(self) || (self->polling_retries >= max_polling_retries)) {
         self->erd_index = 0;
         self->polling_retries = 0;
         send_next_poll_read_request(self);
@@ -353,42 +447,15 @@ static tiny_hsm_result_t state_polling(tiny_hsm_t* hsm, tiny_hsm_signal_t signal
     case signal_read_completed:
       disarm_timer(self);
       reset_lost_appliance_timer(self);
-      {
-        tiny_erd_t erd = args->read_completed.erd;
-        const uint8_t* data = reinterpret_cast<const uint8_t*>(args->read_completed.data);
-        uint8_t data_size = args->read_completed.data_size;
-        // Register any ERD that arrives here for the first time. This handles
-        // delayed discovery responses that arrive after the transition to polling
-        // state (when the device takes longer than retry_delay to respond).
-        add_erd_to_polling_list(self, erd);
-        bool should_publish;
-        if(self->only_publish_on_change) {
-          auto& cache = erd_cache(self);
-          auto it = cache.find(erd);
-          bool data_changed;
-          if(it == cache.end()) {
-            data_changed = true;
-          }
-          else {
-            data_changed = (it->second.size() != data_size) ||
-              (memcmp(it->second.data(), data, data_size) != 0);
-          }
-          if(data_changed) {
-            cache[erd] = vector<uint8_t>(data, data + data_size);
-          }
-          should_publish = data_changed;
-        }
-        else {
-          should_publish = true;
-        }
-        if(should_publish) {
-          mqtt_client_update_erd(self->mqtt_client, erd, data, data_size);
-        }
-      }
-
+      publish_polled_erd(self, args);
       send_next_poll_read_request(self);
       break;
 
+    case signal_late_read_completed:
+      reset_lost_appliance_timer(self);
+      publish_polled_erd(self, args);
+      break;
+
     case signal_mqtt_disconnected:
       tiny_hsm_transition(&self->hsm, state_identify_appliance);
       break;
@@ -424,15 +491,26 @@ void mqtt_bridge_polling_init(
   i_tiny_gea3_erd_client_t* erd_client,
   i_mqtt_client_t* mqtt_client,
   uint32_t polling_interval_ms,
-  bool only_publish_on_change)
+  bool only_publish_on_change,
+  erd_value_cache_mode_t change_detection,
+  const rtt_estimator_configuration_t* read_timeout_configuration)
 {
   self->timer_group = timer_group;
   self->erd_client = erd_client;
   self->mqtt_client = mqtt_client;
   self->polling_interval_ms = polling_interval_ms;
   self->only_publish_on_change = only_publish_on_change;
-  self->erd_set = reinterpret_cast<void*>(new set<tiny_erd_t>());
-  self->erd_cache = reinterpret_cast<void*>(new map<tiny_erd_t, vector<uint8_t>>());
+  self->read_queued = false;
+  self->read_retries = 0;
+  self->request_id = 0;
+  self->current_read = nullptr;
+  self->last_read_latency = 0;
+  in_flight_table_init(&self->in_flight);
+  tiny_event_init(&self->on_read_abandoned);
+  rtt_estimator_init(&self->read_timeouts, read_timeout_configuration);
+  erd_bitset_clear(&self->polled_erds);
+  erd_bitset_clear(&self->registered_erds);
+  erd_value_cache_init(&self->erd_cache, change_detection);
 
   tiny_event_subscription_init(
     &self->erd_client_activity_subscription, self, +[](void* context, const void* _args) {
@@ -440,13 +518,43 @@ void mqtt_bridge_polling_init(
       auto args = reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(_args);
 
       switch(args->type) {
-        case tiny_gea3_erd_client_activity_type_read_completed:
-          tiny_hsm_send_signal(&self->hsm, signal_read_completed, args);
-          break;
+        case tiny_gea3_erd_client_activity_type_read_completed: {
+          auto request = in_flight_table_match(&self->in_flight, args->read_completed.request_id, args->address, args->read_completed.erd);
+          if(!request) {
+            break;
+          }
 
-        case tiny_gea3_erd_client_activity_type_read_failed:
-          tiny_hsm_send_signal(&self->hsm, signal_read_failed, args);
-          break;
+          bool current = (request == self->current_read);
+          self->last_read_latency = in_flight_request_age(request, now(self));
+          // Only a first attempt answered before it timed out is known to measure a single round trip
+          if(!request->expired && (request->retries == 0)) {
+            rtt_estimator_add_sample(&self->read_timeouts, request->address, self->last_read_latency);
+          }
+          in_flight_table_remove(&self->in_flight, request);
+
+          if(current) {
+            self->current_read = nullptr;
+            tiny_hsm_send_signal(&self->hsm, signal_read_completed, args);
+          }
+          else {
+            tiny_hsm_send_signal(&self->hsm, signal_late_read_completed, args);
+          }
+        } break;
+
+        case tiny_gea3_erd_client_activity_type_read_failed: {
+          auto request = in_flight_table_match(&self->in_flight, args->read_failed.request_id, args->address, args->read_failed.erd);
+          if(!request) {
+            break;
+          }
+
+          bool current = (request == self->current_read);
+          in_flight_table_remove(&self->in_flight, request);
+
+          if(current) {
+            self->current_read = nullptr;
+            tiny_hsm_send_signal(&self->hsm, signal_read_failed, args);
+          }
+        } break;
 
         case tiny_gea3_erd_client_activity_type_write_completed:
           mqtt_client_update_erd_write_result(self->mqtt_client, args->write_completed.erd, true, 0);
@@ -470,7 +578,7 @@ void mqtt_bridge_polling_init(
   tiny_event_subscription_init(
     &self->mqtt_disconnect_subscription, self, +[](void* context, const void*) {
       auto self = reinterpret_cast<mqtt_bridge_polling_t*>(context);
-      reinterpret_cast<set<tiny_erd_t>*>(self->erd_set)->clear();
+      erd_bitset_clear(&self->registered_erds);
       tiny_hsm_send_signal(&self->hsm, signal_mqtt_disconnected, nullptr);
     });
   tiny_event_subscribe(mqtt_client_on_mqtt_disconnect(mqtt_client), &self->mqtt_disconnect_subscription);
@@ -478,8 +586,18 @@ void mqtt_bridge_polling_init(
   tiny_hsm_init(&self->hsm, &hsm_configuration, state_identify_appliance);
 }
 
+i_tiny_event_t* mqtt_bridge_polling_on_read_abandoned(mqtt_bridge_polling_t* self)
+{
+  return &self->on_read_abandoned.interface;
+}
+
 void mqtt_bridge_polling_destroy(mqtt_bridge_polling_t* self)
 {
-  delete reinterpret_cast<set<tiny_erd_t>*>(self->erd_set);
-  delete reinterpret_cast<map<tiny_erd_t, vector<uint8_t>>*>(self->erd_cache);
+  tiny_timer_stop(self->timer_group, &self->timer);
+  tiny_timer_stop(self->timer_group, &self->appliance_lost_timer);
+  tiny_timer_stop(self->timer_group, &self->polling_timer);
+  tiny_event_unsubscribe(tiny_gea3_erd_client_on_activity(self->erd_client), &self->erd_client_activity_subscription);
+  tiny_event_unsubscribe(mqtt_client_on_write_request(self->mqtt_client), &self->mqtt_write_request_subscription);
+  tiny_event_unsubscribe(mqtt_client_on_mqtt_disconnect(self->mqtt_client), &self->mqtt_disconnect_subscription);
+  erd_value_cache_destroy(&self->erd_cache);
 }
@@ -6,15 +6,23 @@
 #ifndef mqtt_bridge_polling_h
 #define mqtt_bridge_polling_h
 
+#include "erd_bitset.h"
+#include "erd_value_cache.h"
 #include "i_mqtt_client.h"
+#include "in_flight_table.h"
 #include "i_tiny_gea3_erd_client.h"
+#include "rtt_estimator.h"
+#include "tiny_event.h"
 #include "tiny_hsm.h"
 #include "tiny_timer.h"
-#include "erd_lists.h"
 
 typedef struct {
-  tiny_erd_t erd_polling_list[POLLING_LIST_MAX_SIZE];
-  uint16_t polling_list_count;
+  tiny_gea3_erd_client_request_id_t request_id;
+} mqtt_bridge_polling_on_read_abandoned_args_t;
+
+typedef struct {
+  erd_bitset_t polled_erds;
+  erd_bitset_t registered_erds;
   uint32_t polling_interval_ms;
   tiny_timer_group_t* timer_group;
   i_tiny_gea3_erd_client_t* erd_client;
@@ -25,21 +33,29 @@ typedef struct {
   tiny_event_subscription_t mqtt_write_request_subscription;
   tiny_event_subscription_t mqtt_disconnect_subscription;
   tiny_event_subscription_t erd_client_activity_subscription;
+  tiny_event_t on_read_abandoned;
   tiny_hsm_t hsm;
-  void* erd_set;
-  void* erd_cache;
+  erd_value_cache_t erd_cache;
   tiny_gea3_erd_client_request_id_t request_id;
+  in_flight_table_t in_flight;
+  in_flight_request_t* current_read;
+  tiny_time_source_ticks_t last_read_latency;
+  rtt_estimator_t read_timeouts;
   uint8_t erd_host_address;
   uint8_t appliance_type;
-  const tiny_erd_t* appliance_erd_list;
-  uint16_t appliance_erd_list_count;
+  erdListIterator_t discovery_erds;
   uint16_t erd_index;
   uint16_t polling_retries;
+  bool read_queued;
+  uint8_t read_retries;
   bool only_publish_on_change;
 } mqtt_bridge_polling_t;
 
 /*!
- * Initialize the MQTT polling bridge.
+ * Initialize the MQTT polling bridge. With only_publish_on_change, the change
+ * detection mode picks whether full copies or digests of published values are
+ * kept. Reads time out after a per-host estimate of the host's response time,
+ * within the limits in the read timeout configuration.
  */
 void mqtt_bridge_polling_init(
   mqtt_bridge_polling_t* self,
@@ -47,7 +63,16 @@ void mqtt_bridge_polling_init(
   i_tiny_gea3_erd_client_t* erd_client,
   i_mqtt_client_t* mqtt_client,
   uint32_t polling_interval_ms,
-  bool only_publish_on_change);
+  bool only_publish_on_change,
+  erd_value_cache_mode_t change_detection,
+  const rtt_estimator_configuration_t* read_timeout_configuration);
+
+/*!
+ * Published when the bridge stops waiting for a read that the ERD client is
+ * still working on. Its response is still used if it arrives.
+ */
+i_tiny_event_t* mqtt_bridge_polling_on_read_abandoned(
+  mqtt_bridge_polling_t* self);
 
 /*!
  * Destroy the MQTT polling bridge.
@@ -0,0 +1,31 @@
+/*!
+ * @file
+ * @brief Storage for the MQTT bridge that is running.
+ *
+ * The subscription and polling bridges never run at the same time, so they share
+ * one block of memory. kind says which of them, if any, has been initialized and
+ * must be destroyed before the other one is initialized in its place.
+ */
+
+#ifndef mqtt_bridge_storage_h
+#define mqtt_bridge_storage_h
+
+#include "mqtt_bridge.h"
+#include "mqtt_bridge_polling.h"
+
+enum {
+  mqtt_bridge_storage_kind_none,
+  mqtt_bridge_storage_kind_subscription,
+  mqtt_bridge_storage_kind_polling
+};
+typedef uint8_t mqtt_bridge_storage_kind_t;
+
+typedef struct {
+  union {
+    mqtt_bridge_t subscription;
+    mqtt_bridge_polling_t polling;
+  };
+  mqtt_bridge_storage_kind_t kind;
+} mqtt_bridge_storage_t;
+
+#endif
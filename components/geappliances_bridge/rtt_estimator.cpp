@@ -0,0 +1,132 @@
+/*!
+ * @file
+ * @brief Estimates how long each host takes to answer a read and derives a timeout from it.
+ */
+
+extern "C" {
+#include "rtt_estimator.h"
+}
+
+#include <cstring>
+
+static rtt_estimator_host_t* find_host(rtt_estimator_t* self, uint8_t address)
+{
+  for(uint8_t i = 0; i < rtt_estimator_max_hosts; i++) {
+    if(self->hosts[i].in_use && (self->hosts[i].address == address)) {
+      return &self->hosts[i];
+    }
+  }
+
+  return nullptr;
+}
+
+static rtt_estimator_host_t* add_host(rtt_estimator_t* self, uint8_t address)
+{
+  rtt_estimator_host_t* host = nullptr;
+
+  for(uint8_t i = 0; i < rtt_estimator_max_hosts; i++) {
+    if(!self->hosts[i].in_use) {
+      host = &self->hosts[i];
+      break;
+    }
+  }
+
+  if(!host) {
+    host = &self->hosts[self->next_replacement];
+    self->next_replacement = (self->next_replacement + 1) % rtt_estimator_max_hosts;
+  }
+
+  memset(host, 0, sizeof(*host));
+  host->address = address;
+  host->in_use = true;
+  return host;
+}
+
+void rtt_estimator_init(
+  rtt_estimator_t* self,
+  const rtt_estimator_configuration_t* configuration)
+{
+  self->configuration = configuration;
+  memset(self->hosts, 0, sizeof(self->hosts));
+  self->next_replacement = 0;
+}
+
+void rtt_estimator_add_sample(
+  rtt_estimator_t* self,
+  uint8_t address,
+  tiny_timer_ticks_t rtt)
+{
+  rtt_estimator_host_t* host = find_host(self, address);
+
+  if(!host) {
+    host = add_host(self, address);
+  }
+
+  host->backoff = 0;
+
+  if(!host->measured) {
+    // The first sample seeds the average, with half of it as the deviation
+    host->measured = true;
+    host->scaled_smoothed_rtt = rtt << 3;
+    host->scaled_rtt_deviation = rtt << 1;
+    return;
+  }
+
+  int32_t error = static_cast<int32_t>(rtt) - static_cast<int32_t>(host->scaled_smoothed_rtt >> 3);
+  host->scaled_smoothed_rtt += error;
+
+  if(error < 0) {
+    error = -error;
+  }
+  host->scaled_rtt_deviation += error - static_cast<int32_t>(host->scaled_rtt_deviation >> 2);
+}
+
+void rtt_estimator_back_off(
+  rtt_estimator_t* self,
+  uint8_t address)
+{
+  rtt_estimator_host_t* host = find_host(self, address);
+
+  if(!host) {
+    host = add_host(self, address);
+  }
+
+  if((host->backoff < rtt_estimator_max_backoff) &&
+    (rtt_estimator_timeout(self, address) < self->configuration->maximum_timeout)) {
+    host->backoff++;
+  }
+}
+
+tiny_timer_ticks_t rtt_estimator_timeout(
+  rtt_estimator_t* self,
+  uint8_t address)
+{
+  rtt_estimator_host_t* host = find_host(self, address);
+  uint32_t timeout = self->configuration->initial_timeout;
+
+  if(host && host->measured) {
+    timeout = (host->scaled_smoothed_rtt >> 3) + host->scaled_rtt_deviation;
+
+    if(timeout < self->configuration->minimum_timeout) {
+      timeout = self->configuration->minimum_timeout;
+    }
+  }
+
+  if(host) {
+    timeout <<= host->backoff;
+  }
+
+  if(timeout > self->configuration->maximum_timeout) {
+    return self->configuration->maximum_timeout;
+  }
+
+  return static_cast<tiny_timer_ticks_t>(timeout);
+}
+
+tiny_timer_ticks_t rtt_estimator_smoothed_rtt(
+  rtt_estimator_t* self,
+  uint8_t address)
+{
+  rtt_estimator_host_t* host = find_host(self, address);
+  return (host && host->measured) ? static_cast<tiny_timer_ticks_t>(host->scaled_smoothed_rtt >> 3) : 0;
+}
@@ -0,0 +1,86 @@
+/*!
+ * @file
+ * @brief Estimates how long each host takes to answer a read and derives a timeout from it.
+ *
+ * Each host keeps a smoothed round trip time and its mean deviation, updated the
+ * way TCP does (gains of 1/8 and 1/4). The timeout is the smoothed round trip
+ * time plus four deviations, clamped to the configured limits. Hosts that have
+ * not answered yet use the initial timeout. Samples must be unambiguous, i.e.
+ * matched to the exact request they answer and answered before it timed out
+ * (Karn's rule). Since late answers are not measured, each timeout doubles the
+ * host's timeout instead until a read is answered in time.
+ */
+
+#ifndef rtt_estimator_h
+#define rtt_estimator_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_timer.h"
+
+enum {
+  rtt_estimator_max_hosts = 4,
+  rtt_estimator_max_backoff = 16
+};
+
+typedef struct {
+  tiny_timer_ticks_t initial_timeout;
+  tiny_timer_ticks_t minimum_timeout;
+  tiny_timer_ticks_t maximum_timeout;
+} rtt_estimator_configuration_t;
+
+typedef struct {
+  // Scaled by 8 and 4 respectively so the gains need no fractions
+  uint32_t scaled_smoothed_rtt;
+  uint32_t scaled_rtt_deviation;
+  uint8_t address;
+  uint8_t backoff;
+  bool measured;
+  bool in_use;
+} rtt_estimator_host_t;
+
+typedef struct {
+  const rtt_estimator_configuration_t* configuration;
+  rtt_estimator_host_t hosts[rtt_estimator_max_hosts];
+  uint8_t next_replacement;
+} rtt_estimator_t;
+
+/*!
+ * Initialize with no hosts measured.
+ */
+void rtt_estimator_init(
+  rtt_estimator_t* self,
+  const rtt_estimator_configuration_t* configuration);
+
+/*!
+ * Add a measured round trip for a host. When every slot is taken, hosts are
+ * replaced in turn.
+ */
+void rtt_estimator_add_sample(
+  rtt_estimator_t* self,
+  uint8_t address,
+  tiny_timer_ticks_t rtt);
+
+/*!
+ * A read to a host timed out. Doubles the host's timeout, up to the maximum,
+ * until its next sample.
+ */
+void rtt_estimator_back_off(
+  rtt_estimator_t* self,
+  uint8_t address);
+
+/*!
+ * How long to wait for a host to answer a read.
+ */
+tiny_timer_ticks_t rtt_estimator_timeout(
+  rtt_estimator_t* self,
+  uint8_t address);
+
+/*!
+ * Smoothed round trip time for a host, or 0 if it has not been measured.
+ */
+tiny_timer_ticks_t rtt_estimator_smoothed_rtt(
+  rtt_estimator_t* self,
+  uint8_t address);
+
+#endif
@@ -0,0 +1,83 @@
+/*!
+ * @file
+ * @brief Lock-free single-producer/single-consumer byte ring.
+ */
+
+extern "C" {
+#include "spsc_ring.h"
+}
+
+static uint16_t load_acquire(const uint16_t* index)
+{
+  return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint16_t* index, uint16_t value)
+{
+  __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+// Copies count bytes between the ring and a linear buffer, splitting where the ring wraps
+static void copy_in(spsc_ring_t* self, uint16_t position, const uint8_t* data, uint16_t count)
+{
+  for(uint16_t i = 0; i < count; i++) {
+    self->buffer[(position + i) & (self->size - 1)] = data[i];
+  }
+}
+
+static void copy_out(spsc_ring_t* self, uint16_t position, uint8_t* data, uint16_t count)
+{
+  for(uint16_t i = 0; i < count; i++) {
+    data[i] = self->buffer[(position + i) & (self->size - 1)];
+  }
+}
+
+void spsc_ring_init(
+  spsc_ring_t* self,
+  uint8_t* buffer,
+  uint16_t size)
+{
+  self->buffer = buffer;
+  self->size = size;
+  self->head = 0;
+  self->tail = 0;
+}
+
+uint16_t spsc_ring_write(
+  spsc_ring_t* self,
+  const uint8_t* data,
+  uint16_t size)
+{
+  // Only the producer writes head, so it can be read without ordering
+  uint16_t head = self->head;
+  uint16_t used = static_cast<uint16_t>(head - load_acquire(&self->tail));
+  uint16_t free = self->size - used;
+  uint16_t count = (size < free) ? size : free;
+
+  copy_in(self, head, data, count);
+  store_release(&self->head, static_cast<uint16_t>(head + count));
+
+  return count;
+}
+
+uint16_t spsc_ring_read(
+  spsc_ring_t* self,
+  uint8_t* data,
+  uint16_t size)
+{
+  // Only the consumer writes tail, so it can be read without ordering
+  uint16_t tail = self->tail;
+  uint16_t available = static_cast<uint16_t>(load_acquire(&self->head) - tail);
+  uint16_t count = (size < available) ? size : available;
+
+  copy_out(self, tail, data, count);
+  store_release(&self->tail, static_cast<uint16_t>(tail + count));
+
+  return count;
+}
+
+uint16_t spsc_ring_count(
+  spsc_ring_t* self)
+{
+  return static_cast<uint16_t>(load_acquire(&self->head) - load_acquire(&self->tail));
+}
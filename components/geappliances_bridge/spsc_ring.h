@@ -0,0 +1,53 @@
+/*!
+ * @file
+ * @brief Lock-free single-producer/single-consumer byte ring.
+ *
+ * One task writes and another task reads without any locking. The producer only
+ * ever advances the head and the consumer only ever advances the tail; each side
+ * publishes its index with release ordering and reads the other side's index with
+ * acquire ordering, so bytes are visible before the index that covers them.
+ */
+
+#ifndef spsc_ring_h
+#define spsc_ring_h
+
+#include <stdint.h>
+
+typedef struct {
+  uint8_t* buffer;
+  uint16_t size;
+  uint16_t head;
+  uint16_t tail;
+} spsc_ring_t;
+
+/*!
+ * Initialize the ring. size must be a power of two no larger than 32768.
+ */
+void spsc_ring_init(
+  spsc_ring_t* self,
+  uint8_t* buffer,
+  uint16_t size);
+
+/*!
+ * Producer side. Writes as many bytes as fit and returns the number written.
+ */
+uint16_t spsc_ring_write(
+  spsc_ring_t* self,
+  const uint8_t* data,
+  uint16_t size);
+
+/*!
+ * Consumer side. Reads up to size bytes and returns the number read.
+ */
+uint16_t spsc_ring_read(
+  spsc_ring_t* self,
+  uint8_t* data,
+  uint16_t size);
+
+/*!
+ * Number of bytes written and not yet read. Safe to call from either side.
+ */
+uint16_t spsc_ring_count(
+  spsc_ring_t* self);
+
+#endif
@@ -0,0 +1,28 @@
+/*!
+ * @file
+ * @brief Measures elapsed time on a 32-bit time source, across tick wraparound.
+ */
+
+extern "C" {
+#include "stopwatch.h"
+}
+
+void stopwatch_init(
+  stopwatch_t* self,
+  i_wide_time_source_t* time_source)
+{
+  self->time_source = time_source;
+  stopwatch_restart(self);
+}
+
+void stopwatch_restart(
+  stopwatch_t* self)
+{
+  self->start = wide_time_source_ticks(self->time_source);
+}
+
+wide_time_source_ticks_t stopwatch_elapsed(
+  stopwatch_t* self)
+{
+  return stopwatch_ticks_between(self->start, wide_time_source_ticks(self->time_source));
+}
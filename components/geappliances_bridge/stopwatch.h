@@ -0,0 +1,48 @@
+/*!
+ * @file
+ * @brief Measures elapsed time on a 32-bit time source, across tick wraparound.
+ *
+ * With a microsecond time source this is precise enough for sub-millisecond bus
+ * round trips. Intervals must be shorter than one full wrap of the tick counter.
+ */
+
+#ifndef stopwatch_h
+#define stopwatch_h
+
+#include "i_wide_time_source.h"
+
+typedef struct {
+  i_wide_time_source_t* time_source;
+  wide_time_source_ticks_t start;
+} stopwatch_t;
+
+/*!
+ * Initialize the stopwatch and start it.
+ */
+void stopwatch_init(
+  stopwatch_t* self,
+  i_wide_time_source_t* time_source);
+
+/*!
+ * Restart the stopwatch from now.
+ */
+void stopwatch_restart(
+  stopwatch_t* self);
+
+/*!
+ * Ticks elapsed since the stopwatch was started.
+ */
+wide_time_source_ticks_t stopwatch_elapsed(
+  stopwatch_t* self);
+
+/*!
+ * Ticks from start to end, correct when the tick counter wrapped in between.
+ */
+static inline wide_time_source_ticks_t stopwatch_ticks_between(
+  wide_time_source_ticks_t start,
+  wide_time_source_ticks_t end)
+{
+  return (wide_time_source_ticks_t)(end - start);
+}
+
+#endif
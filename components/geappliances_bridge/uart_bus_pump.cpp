@@ -0,0 +1,69 @@
+/*!
+ * @file
+ * @brief Moves UART bytes between a dedicated bus task and the component loop.
+ */
+
+extern "C" {
+#include "uart_bus_pump.h"
+}
+
+void uart_bus_pump_init(
+  uart_bus_pump_t* self)
+{
+  spsc_ring_init(&self->rx, self->rx_buffer, sizeof(self->rx_buffer));
+  spsc_ring_init(&self->tx, self->tx_buffer, sizeof(self->tx_buffer));
+}
+
+void uart_bus_pump_run(
+  uart_bus_pump_t* self,
+  uart_rx_ring_read_t read,
+  uart_tx_batch_write_t write,
+  void* context)
+{
+  uint8_t chunk[uart_bus_pump_chunk_size];
+
+  // Bytes that do not fit stay in the UART driver until the loop catches up
+  while(true) {
+    uint16_t room = uart_bus_pump_rx_size - spsc_ring_count(&self->rx);
+    uint16_t requested = (room < sizeof(chunk)) ? room : sizeof(chunk);
+    if(requested == 0) {
+      break;
+    }
+
+    uint16_t received = read(context, chunk, requested);
+    spsc_ring_write(&self->rx, chunk, received);
+
+    if(received < requested) {
+      break;
+    }
+  }
+
+  // The bus task can wait for the driver, so every chunk is written in full
+  uint16_t count;
+  while((count = spsc_ring_read(&self->tx, chunk, sizeof(chunk))) > 0) {
+    write(context, chunk, count);
+  }
+}
+
+uint16_t uart_bus_pump_read(
+  void* context,
+  uint8_t* buffer,
+  uint16_t size)
+{
+  auto self = static_cast<uart_bus_pump_t*>(context);
+  return spsc_ring_read(&self->rx, buffer, size);
+}
+
+uint16_t uart_bus_pump_write(
+  uart_bus_pump_t* self,
+  const uint8_t* data,
+  uint16_t size)
+{
+  return spsc_ring_write(&self->tx, data, size);
+}
+
+uint16_t uart_bus_pump_received_count(
+  uart_bus_pump_t* self)
+{
+  return spsc_ring_count(&self->rx);
+}
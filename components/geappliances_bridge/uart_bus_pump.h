@@ -0,0 +1,70 @@
+/*!
+ * @file
+ * @brief Moves UART bytes between a dedicated bus task and the component loop.
+ *
+ * The bus task owns the UART driver: it drains received bytes into the receive
+ * ring and writes out whatever the loop queued in the transmit ring. The loop
+ * only ever touches the rings, so a stalled loop no longer leaves received bytes
+ * sitting in the UART driver. Each ring has exactly one producer and one consumer.
+ */
+
+#ifndef uart_bus_pump_h
+#define uart_bus_pump_h
+
+#include <stdint.h>
+#include "spsc_ring.h"
+#include "uart_rx_ring.h"
+#include "uart_tx_batch.h"
+
+enum {
+  uart_bus_pump_rx_size = 1024,
+  uart_bus_pump_tx_size = 512,
+  uart_bus_pump_chunk_size = 64
+};
+
+typedef struct {
+  spsc_ring_t rx;
+  spsc_ring_t tx;
+  uint8_t rx_buffer[uart_bus_pump_rx_size];
+  uint8_t tx_buffer[uart_bus_pump_tx_size];
+} uart_bus_pump_t;
+
+/*!
+ * Initialize the pump.
+ */
+void uart_bus_pump_init(
+  uart_bus_pump_t* self);
+
+/*!
+ * Bus task side. Moves received bytes from the driver into the receive ring, as far
+ * as it has room, and queued bytes from the transmit ring to the driver.
+ */
+void uart_bus_pump_run(
+  uart_bus_pump_t* self,
+  uart_rx_ring_read_t read,
+  uart_tx_batch_write_t write,
+  void* context);
+
+/*!
+ * Loop side. Reads received bytes; matches uart_rx_ring_read_t with the pump as context.
+ */
+uint16_t uart_bus_pump_read(
+  void* context,
+  uint8_t* buffer,
+  uint16_t size);
+
+/*!
+ * Loop side. Queues bytes for transmission and returns the number that fit.
+ */
+uint16_t uart_bus_pump_write(
+  uart_bus_pump_t* self,
+  const uint8_t* data,
+  uint16_t size);
+
+/*!
+ * Loop side. Number of received bytes waiting to be read.
+ */
+uint16_t uart_bus_pump_received_count(
+  uart_bus_pump_t* self);
+
+#endif
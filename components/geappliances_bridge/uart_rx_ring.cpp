@@ -0,0 +1,81 @@
+/*!
+ * @file
+ * @brief Ring buffer that drains a UART in bulk and hands out contiguous chunks.
+ */
+
+extern "C" {
+#include "uart_rx_ring.h"
+}
+
+// Head and tail run freely and are masked on use, so a full ring is distinguishable from an empty one
+static uint16_t index_of(uint16_t position)
+{
+  return position & (uart_rx_ring_size - 1);
+}
+
+void uart_rx_ring_init(
+  uart_rx_ring_t* self,
+  uart_rx_ring_read_t read,
+  void* context)
+{
+  self->read = read;
+  self->context = context;
+  self->head = 0;
+  self->tail = 0;
+}
+
+uint16_t uart_rx_ring_count(
+  const uart_rx_ring_t* self)
+{
+  return static_cast<uint16_t>(self->head - self->tail);
+}
+
+uint16_t uart_rx_ring_fill(
+  uart_rx_ring_t* self)
+{
+  uint16_t total = 0;
+
+  while(uart_rx_ring_count(self) < uart_rx_ring_size) {
+    uint16_t start = index_of(self->head);
+    uint16_t free = uart_rx_ring_size - uart_rx_ring_count(self);
+    uint16_t contiguous = uart_rx_ring_size - start;
+    uint16_t requested = (free < contiguous) ? free : contiguous;
+
+    uint16_t received = self->read(self->context, &self->buffer[start], requested);
+    self->head += received;
+    total += received;
+
+    // A short read means the UART is drained for now
+    if(received < requested) {
+      break;
+    }
+  }
+
+  return total;
+}
+
+void uart_rx_ring_dispatch(
+  uart_rx_ring_t* self,
+  uart_rx_ring_on_chunk_t on_chunk,
+  void* context)
+{
+  while(uart_rx_ring_count(self) > 0) {
+    uint16_t start = index_of(self->tail);
+    uint16_t contiguous = uart_rx_ring_size - start;
+    uint16_t count = uart_rx_ring_count(self);
+    uint16_t size = (count < contiguous) ? count : contiguous;
+
+    on_chunk(context, &self->buffer[start], size);
+    self->tail += size;
+  }
+}
+
+void uart_rx_ring_run(
+  uart_rx_ring_t* self,
+  uart_rx_ring_on_chunk_t on_chunk,
+  void* context)
+{
+  while(uart_rx_ring_fill(self) > 0) {
+    uart_rx_ring_dispatch(self, on_chunk, context);
+  }
+}
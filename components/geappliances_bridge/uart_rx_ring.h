@@ -0,0 +1,76 @@
+/*!
+ * @file
+ * @brief Ring buffer that drains a UART in bulk and hands out contiguous chunks.
+ *
+ * The UART is read with as few driver calls as possible, straight into the free
+ * space of the ring, and the received bytes are then passed on one contiguous
+ * chunk at a time so that framing and statistics can work on whole runs of bytes.
+ */
+
+#ifndef uart_rx_ring_h
+#define uart_rx_ring_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum {
+  // Must be a power of two
+  uart_rx_ring_size = 256
+};
+
+/*!
+ * Reads up to size bytes without blocking and returns the number of bytes read.
+ */
+typedef uint16_t (*uart_rx_ring_read_t)(void* context, uint8_t* buffer, uint16_t size);
+
+/*!
+ * Receives a contiguous chunk of received bytes.
+ */
+typedef void (*uart_rx_ring_on_chunk_t)(void* context, const uint8_t* data, uint16_t size);
+
+typedef struct {
+  uart_rx_ring_read_t read;
+  void* context;
+  uint16_t head;
+  uint16_t tail;
+  uint8_t buffer[uart_rx_ring_size];
+} uart_rx_ring_t;
+
+/*!
+ * Initialize the ring.
+ */
+void uart_rx_ring_init(
+  uart_rx_ring_t* self,
+  uart_rx_ring_read_t read,
+  void* context);
+
+/*!
+ * Read from the UART until it has no more data or the ring is full. Returns the
+ * number of bytes read.
+ */
+uint16_t uart_rx_ring_fill(
+  uart_rx_ring_t* self);
+
+/*!
+ * Hand every buffered byte to on_chunk, in at most two contiguous chunks.
+ */
+void uart_rx_ring_dispatch(
+  uart_rx_ring_t* self,
+  uart_rx_ring_on_chunk_t on_chunk,
+  void* context);
+
+/*!
+ * Fill and dispatch until the UART has no more data.
+ */
+void uart_rx_ring_run(
+  uart_rx_ring_t* self,
+  uart_rx_ring_on_chunk_t on_chunk,
+  void* context);
+
+/*!
+ * Number of bytes buffered and not yet dispatched.
+ */
+uint16_t uart_rx_ring_count(
+  const uart_rx_ring_t* self);
+
+#endif
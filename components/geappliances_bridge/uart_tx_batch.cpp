@@ -0,0 +1,85 @@
+/*!
+ * @file
+ * @brief Batches UART transmit bytes into bulk writes.
+ */
+
+extern "C" {
+#include "uart_tx_batch.h"
+}
+
+#include <cstring>
+
+// Bytes the driver did not take move to the front to go out first next time
+static void flush(uart_tx_batch_t* self)
+{
+  if(self->count > 0) {
+    uint16_t written = self->write(self->context, self->buffer, self->count);
+    self->count -= written;
+    memmove(self->buffer, &self->buffer[written], self->count);
+  }
+}
+
+static bool has_room(uart_tx_batch_t* self)
+{
+  return self->batch ? (self->count < uart_tx_batch_buffer_size) : (self->count == 0);
+}
+
+void uart_tx_batch_init(
+  uart_tx_batch_t* self,
+  uart_tx_batch_write_t write,
+  void* context,
+  bool batch)
+{
+  self->write = write;
+  self->context = context;
+  self->count = 0;
+  self->byte_pending = false;
+  self->batch = batch;
+}
+
+void uart_tx_batch_send(
+  uart_tx_batch_t* self,
+  uint8_t byte)
+{
+  self->byte_pending = true;
+
+  // Only a sender that does not wait for send complete can find the buffer full
+  if(self->count == uart_tx_batch_buffer_size) {
+    flush(self);
+  }
+  if(self->count < uart_tx_batch_buffer_size) {
+    self->buffer[self->count++] = byte;
+  }
+
+  if(!self->batch) {
+    flush(self);
+  }
+}
+
+void uart_tx_batch_run(
+  uart_tx_batch_t* self,
+  tiny_event_t* send_complete_event)
+{
+  // Bytes left behind by a busy driver have to go out before anything else is sent
+  if(!has_room(self)) {
+    flush(self);
+  }
+
+  // Each completion may send another byte, which is collected instead of written
+  while(self->byte_pending && has_room(self)) {
+    self->byte_pending = false;
+    tiny_event_publish(send_complete_event, NULL);
+
+    if(!self->batch) {
+      break;
+    }
+  }
+
+  flush(self);
+}
+
+bool uart_tx_batch_has_unwritten_bytes(
+  const uart_tx_batch_t* self)
+{
+  return self->count > 0;
+}
@@ -0,0 +1,72 @@
+/*!
+ * @file
+ * @brief Batches UART transmit bytes into bulk writes.
+ *
+ * The GEA interfaces send one byte and wait for the send complete event before
+ * sending the next. Instead of writing each byte and reporting it complete on a
+ * later loop iteration, bytes are collected and the send complete event is raised
+ * again for as long as the interface keeps sending. A whole frame is then handed
+ * to the UART driver in as few bulk writes as the buffer allows.
+ *
+ * The write may take fewer bytes than it was given when the driver is busy. The
+ * rest stays in the buffer and goes out first on the next run, and the send
+ * complete event is held back while the buffer has no room for another byte.
+ */
+
+#ifndef uart_tx_batch_h
+#define uart_tx_batch_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_event.h"
+
+enum {
+  uart_tx_batch_buffer_size = 64
+};
+
+// Returns the number of bytes the driver took
+typedef uint16_t (*uart_tx_batch_write_t)(void* context, const uint8_t* data, uint16_t size);
+
+typedef struct {
+  uart_tx_batch_write_t write;
+  void* context;
+  uint8_t buffer[uart_tx_batch_buffer_size];
+  uint8_t count;
+  bool byte_pending;
+  bool batch;
+} uart_tx_batch_t;
+
+/*!
+ * Initialize the batch. When batch is false every byte is written immediately
+ * and reported complete on the next call to uart_tx_batch_run once the driver
+ * has taken it.
+ */
+void uart_tx_batch_init(
+  uart_tx_batch_t* self,
+  uart_tx_batch_write_t write,
+  void* context,
+  bool batch);
+
+/*!
+ * Queue a byte to be written. Called from the UART send function. The GEA
+ * interfaces only send again after send complete, so there is always room.
+ */
+void uart_tx_batch_send(
+  uart_tx_batch_t* self,
+  uint8_t byte);
+
+/*!
+ * Raise send_complete_event for the queued bytes, collecting any bytes sent in
+ * response, and write as much as the driver takes.
+ */
+void uart_tx_batch_run(
+  uart_tx_batch_t* self,
+  tiny_event_t* send_complete_event);
+
+/*!
+ * True while bytes are waiting for the driver to take them.
+ */
+bool uart_tx_batch_has_unwritten_bytes(
+  const uart_tx_batch_t* self);
+
+#endif
@@ -6,11 +6,12 @@ This script reads the ERD definitions from the public-appliance-api-documentatio
 library and generates a C header file with ERD lists organized by appliance type.
 """
 
+import argparse
 import json
 import re
 import sys
 from pathlib import Path
-from typing import Dict, List, Set
+from typing import Dict, List, Optional, Set, Tuple
 
 
 def parse_erd_id(erd_id_str: str) -> int:
@@ -75,150 +76,541 @@ def categorize_erds(erds: List[Dict]) -> Dict[str, List[int]]:
     return {key: sorted(list(value)) for key, value in categories.items()}
 
 
-def format_erd_list(erds: List[int], indent: int = 2) -> str:
-    """Format a list of ERDs as C array elements."""
+def erd_runs(erds: List[int]) -> List[Tuple[int, int, int]]:
+    """Split a sorted list of ERDs into runs of consecutive IDs as (first, last, offset)."""
+    runs = []
+    for offset, erd in enumerate(erds):
+        if runs and erd == runs[-1][1] + 1:
+            first, _, run_offset = runs[-1]
+            runs[-1] = (first, erd, run_offset)
+        else:
+            runs.append((erd, erd, offset))
+    return runs
+
+
+def format_erd_list(array_name: str, count_name: str, erds: List[int]) -> str:
+    """Format a sorted list of ERDs as a run table, its erdList_t and its ERD count."""
     if not erds:
-        return ""
-    
-    lines = []
-    indent_str = ' ' * indent
-    
-    for erd in erds:
-        lines.append(f"{indent_str}0x{erd:04x},")
-    
-    return '\n'.join(lines)
+        return (f"constexpr erdList_t {array_name} = {{ nullptr, 0, 0 }};\n"
+                f"constexpr uint16_t {count_name} = 0;\n")
+
+    runs_name = array_name[:-len('Erds')] + 'ErdRuns'
+    lines = [f"constexpr erdRun_t {runs_name}[] = {{"]
+    for first, last, offset in erd_runs(erds):
+        comment = f" // to 0x{last:04x}" if last != first else ""
+        lines.append(f"  {{ 0x{first:04x}, {offset} }},{comment}")
+    lines.append("};")
+    lines.append(f"constexpr erdList_t {array_name} = {{ {runs_name}, sizeof({runs_name}) / sizeof({runs_name}[0]), {len(erds)} }};")
+    lines.append(f"constexpr uint16_t {count_name} = {array_name}.erdCount;")
+    return '\n'.join(lines) + '\n'
+
+
+ERD_LIST_TYPES = """// Each list is a table of runs of consecutive ERDs. A run holds its first ERD and the
+// position of that ERD in the list; it ends where the next run starts.
+typedef struct {
+  tiny_erd_t first;
+  uint16_t offset;
+} erdRun_t;
+
+typedef struct {
+  const erdRun_t* runs;
+  uint16_t runCount;
+  uint16_t erdCount;
+} erdList_t;
+
+// Position in the list just past the end of a run
+constexpr uint16_t erdRunEnd(const erdList_t* list, uint16_t run)
+{
+  return (run + 1 < list->runCount) ? list->runs[run + 1].offset : list->erdCount;
+}
+
+// Position of an ERD in a list, or the list's erdCount if it is not in the list
+constexpr uint16_t erdListPosition(const erdList_t* list, tiny_erd_t erd)
+{
+  uint16_t low = 0;
+  uint16_t high = list->runCount;
+
+  // First run that starts after the ERD
+  while(low < high) {
+    uint16_t middle = (low + high) / 2;
+    if(list->runs[middle].first <= erd) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  if(low == 0) {
+    return list->erdCount;
+  }
+
+  const erdRun_t& run = list->runs[low - 1];
+  uint16_t distance = erd - run.first;
+  return (distance < erdRunEnd(list, low - 1) - run.offset) ? run.offset + distance : list->erdCount;
+}
+
+constexpr bool erdListContains(const erdList_t* list, tiny_erd_t erd)
+{
+  return erdListPosition(list, erd) < list->erdCount;
+}
+
+// ERD at a position in a list, which must be below the list's erdCount
+constexpr tiny_erd_t erdListAt(const erdList_t* list, uint16_t position)
+{
+  uint16_t low = 0;
+  uint16_t high = list->runCount;
+
+  // First run that starts after the position
+  while(low < high) {
+    uint16_t middle = (low + high) / 2;
+    if(list->runs[middle].offset <= position) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  const erdRun_t& run = list->runs[low - 1];
+  return run.first + (position - run.offset);
+}
+
+// Walks a list in ascending order without searching
+typedef struct {
+  const erdList_t* list;
+  uint16_t run;
+  uint16_t position;
+} erdListIterator_t;
+
+constexpr erdListIterator_t erdListBegin(const erdList_t* list)
+{
+  return { list, 0, 0 };
+}
+
+constexpr bool erdListIteratorDone(const erdListIterator_t* iterator)
+{
+  return iterator->position >= iterator->list->erdCount;
+}
+
+// Current ERD; the iterator must not be done
+constexpr tiny_erd_t erdListIteratorErd(const erdListIterator_t* iterator)
+{
+  const erdRun_t& run = iterator->list->runs[iterator->run];
+  return run.first + (iterator->position - run.offset);
+}
+
+constexpr void erdListIteratorNext(erdListIterator_t* iterator)
+{
+  iterator->position++;
+  if((iterator->position < iterator->list->erdCount) &&
+    (iterator->position == erdRunEnd(iterator->list, iterator->run))) {
+    iterator->run++;
+  }
+}
+
+"""
+
+
+# Category lists in dense index order, keyed by the top nibble of their ERDs
+INDEXED_CATEGORIES = [
+    (0x0, 'commonErds', 'commonErdCount'),
+    (0x1, 'refrigerationErds', 'refrigerationErdCount'),
+    (0x2, 'laundryErds', 'laundryErdCount'),
+    (0x3, 'dishWasherErds', 'dishWasherErdCount'),
+    (0x4, 'waterHeaterErds', 'waterHeaterErdCount'),
+    (0x5, 'rangeErds', 'rangeErdCount'),
+    (0x7, 'airConditioningErds', 'airConditioningErdCount'),
+    (0x8, 'waterFilterErds', 'waterFilterErdCount'),
+    (0x9, 'smallApplianceErds', 'smallApplianceErdCount'),
+    (0xD, 'energyErds', 'energyErdCount'),
+]
+
+
+# Category key, array name, count name and description of every ERD list, in header order
+CATEGORY_INFO = [
+    ('common', 'commonErds', 'commonErdCount', '0x0000 to 0x0FFF: common ERDs (all appliance types)'),
+    ('refrigeration', 'refrigerationErds', 'refrigerationErdCount', '0x1000 to 0x1FFF: refrigeration ERDs'),
+    ('laundry', 'laundryErds', 'laundryErdCount', '0x2000 to 0x2FFF: laundry ERDs'),
+    ('dishWasher', 'dishWasherErds', 'dishWasherErdCount', '0x3000 to 0x3FFF: dishwasher ERDs'),
+    ('waterHeater', 'waterHeaterErds', 'waterHeaterErdCount', '0x4000 to 0x4FFF: waterHeater ERDs'),
+    ('range', 'rangeErds', 'rangeErdCount', '0x5000 to 0x5FFF: range ERDs (stoves, cooktops, ovens, etc)'),
+    ('airConditioning', 'airConditioningErds', 'airConditioningErdCount', '0x7000 to 0x7FFF: air conditioning ERDs (mini split, Zoneline, etc)'),
+    ('waterFilter', 'waterFilterErds', 'waterFilterErdCount', '0x8000 to 0x8FFF: water filter ERDs'),
+    ('smallAppliance', 'smallApplianceErds', 'smallApplianceErdCount', '0x9000 to 0x9FFF: small appliance ERDs (coffee makers, etc)'),
+    ('energy', 'energyErds', 'energyErdCount', '0xD000 to 0xDFFF: energy ERDs (all appliance types)')
+]
+
+# ERD list polled on each appliance type, indexed by the value of ERD 0x0008
+APPLIANCE_TYPE_CATEGORIES = [
+    ('waterHeater', 'Water heater'),  # 0x00
+    ('laundry', 'Clothes washer'),  # 0x01
+    ('laundry', 'Clothes dryer'),  # 0x02
+    ('refrigeration', 'Refrigerator'),  # 0x03
+    ('smallAppliance', 'Microwave'),  # 0x04
+    ('range', 'Advantium'),  # 0x05
+    ('dishWasher', 'Dishwasher'),  # 0x06
+    ('range', 'Oven'),  # 0x07
+    ('range', 'Electric range'),  # 0x08
+    ('range', 'Gas range'),  # 0x09
+    ('airConditioning', 'Thermostat/RAC'),  # 0x0A
+    ('range', 'Electric Cooktop'),  # 0x0B
+    ('range', 'Pizza Oven'),  # 0x0C
+    ('range', 'Gas Cooktop'),  # 0x0D
+    ('airConditioning', 'Split / DFS (Duct-Free Split) AC'),  # 0x0E
+    ('range', 'Hood'),  # 0x0F
+    ('waterFilter', 'Point of Entry Water Filter'),  # 0x10
+    ('range', 'Induction Cooktop'),  # 0x11
+    ('refrigeration', 'Delivery Box'),  # 0x12
+    ('range', 'Kitchen Hub Vent Hood'),  # 0x13
+    ('airConditioning', 'Zoneline/PTAC'),  # 0x14
+    ('waterFilter', 'Water Softener'),  # 0x15
+    ('airConditioning', 'Portable AC'),  # 0x16
+    ('laundry', 'Combination Washer Dryer'),  # 0x17
+    ('refrigeration', 'Dual Zone Wine Chiller'),  # 0x18
+    ('refrigeration', 'Beverage Center'),  # 0x19
+    ('smallAppliance', 'Coffee Brewer'),  # 0x1A
+    ('smallAppliance', 'Opal Nugget Ice Maker'),  # 0x1B
+    ('refrigeration', 'In-Home Grower'),  # 0x1C
+    ('airConditioning', 'Dehumidifer'),  # 0x1D
+    ('refrigeration', 'Under Counter Ice Maker'),  # 0x1E
+    ('airConditioning', 'Through Wall AC'),  # 0x1F
+    ('dishWasher', 'F&P DishDrawer'),  # 0x20
+    ('smallAppliance', 'Espresso Coffee Maker'),  # 0x21
+    ('smallAppliance', 'Toaster Oven'),  # 0x22
+    ('airConditioning', 'Zoneline/VTAC'),  # 0x23
+    ('airConditioning', 'Central DFS (Duct-Free Split) Controller'),  # 0x24
+    ('smallAppliance', 'BLE Mesh Gateway'),  # 0x25
+    ('smallAppliance', 'Stand Mixer'),  # 0x26
+    ('range', 'Fisher & Paykel Cooktop'),  # 0x27
+    ('range', 'Fisher & Paykel Cooktop Teppanyaki'),  # 0x28
+    ('range', 'Fisher & Paykel Ventilation Downdraft'),  # 0x29
+    ('smallAppliance', 'Smart Plug'),  # 0x2A
+    ('smallAppliance', 'Smoker'),  # 0x2B
+    ('airConditioning', 'Air Handler VRF'),  # 0x2C
+    ('laundry', 'Fabric Care Cabinet Closet'),  # 0x2D
+    ('laundry', 'Laundry Center'),  # 0x2E
+    ('range', 'Grill'),  # 0x2F
+    ('refrigeration', 'Freezer'),  # 0x30
+    ('range', 'Warming Drawer'),  # 0x31
+    ('smallAppliance', 'Vacuum Seal Drawer'),  # 0x32
+    ('refrigeration', 'Wine Cabinet'),  # 0x33
+    ('airConditioning', 'Central AC'),  # 0x34
+    ('range', 'Hearth Pizza Oven'),  # 0x35
+    ('smallAppliance', 'Sourdough Starter'),  # 0x36
+]
+
+# Common ERDs that most appliances support. mqtt_bridge_polling.cpp probes these on every
+# appliance; some are not documented, but they are still added to the common list.
+PROBED_COMMON_ERDS = [
+    0x0001, 0x0002, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009,
+    0x000a, 0x000e, 0x0030, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036,
+    0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e,
+    0x003f, 0x004e, 0x004f, 0x0050, 0x0051, 0x0052,
+]
+
+# Categories every appliance is polled for, whatever its type
+ALWAYS_INCLUDED_CATEGORIES = {'common', 'energy'}
+
+
+def categories_for_appliance_types(appliance_types: Optional[List[int]]) -> Set[str]:
+    """Categories needed for the given appliance types, or all of them if there are none."""
+    if not appliance_types:
+        return {category for category, _, _, _ in CATEGORY_INFO}
+
+    included = set(ALWAYS_INCLUDED_CATEGORIES)
+    for appliance_type in appliance_types:
+        if not 0 <= appliance_type < len(APPLIANCE_TYPE_CATEGORIES):
+            raise ValueError(f"Unknown appliance type {appliance_type}")
+        included.add(APPLIANCE_TYPE_CATEGORIES[appliance_type][0])
+    return included
+
+
+def generate_erd_index(categories: Dict[str, List[int]]) -> str:
+    """Generate the dense ERD index: ranges per top nibble plus constexpr lookups."""
+    list_sizes = {
+        'commonErds': len(categories['common']),
+        'refrigerationErds': len(categories['refrigeration']),
+        'laundryErds': len(categories['laundry']),
+        'dishWasherErds': len(categories['dishWasher']),
+        'waterHeaterErds': len(categories['waterHeater']),
+        'rangeErds': len(categories['range']),
+        'airConditioningErds': len(categories['airConditioning']),
+        'waterFilterErds': len(categories['waterFilter']),
+        'smallApplianceErds': len(categories['smallAppliance']),
+        'energyErds': len(categories['energy']),
+    }
+    known_erd_count = sum(list_sizes.values())
+
+    ranges = {}
+    first_index = 0
+    for nibble, array_name, count_name in INDEXED_CATEGORIES:
+        ranges[nibble] = f"  {{ &{array_name}, {first_index} }}, // 0x{nibble:X}000"
+        first_index += list_sizes[array_name]
+
+    index = f"""// Dense index over every ERD above. Each list's ERDs are numbered consecutively in
+// ascending order, so any set of known ERDs fits in a bitset of KNOWN_ERD_COUNT bits.
+#define KNOWN_ERD_COUNT {known_erd_count}
+#define UNKNOWN_ERD_INDEX KNOWN_ERD_COUNT
+
+typedef struct {{
+  const erdList_t* erdList;
+  uint16_t firstIndex;
+}} erdIndexRange_t;
+
+constexpr erdList_t noErds = {{ nullptr, 0, 0 }};
+
+// One range per value of the top nibble of an ERD
+constexpr erdIndexRange_t erdIndexRanges[] = {{
+"""
+    for nibble in range(16):
+        index += ranges.get(nibble, f"  {{ &noErds, KNOWN_ERD_COUNT }}, // 0x{nibble:X}000") + "\n"
+    index += """};
+
+// Dense index of an ERD, or UNKNOWN_ERD_INDEX if it is in none of the lists above
+constexpr uint16_t erdIndex(tiny_erd_t erd)
+{
+  const erdIndexRange_t& range = erdIndexRanges[erd >> 12];
+  uint16_t position = erdListPosition(range.erdList, erd);
+  return (position < range.erdList->erdCount) ? range.firstIndex + position : UNKNOWN_ERD_INDEX;
+}
+
+// ERD with the given dense index, which must be below KNOWN_ERD_COUNT
+constexpr tiny_erd_t erdAtIndex(uint16_t index)
+{
+  for(const erdIndexRange_t& range : erdIndexRanges) {
+    if((index >= range.firstIndex) && (index < range.firstIndex + range.erdList->erdCount)) {
+      return erdListAt(range.erdList, index - range.firstIndex);
+    }
+  }
+
+  return 0;
+}
+
+"""
+    return index
+
+
+# Data types for the metadata table; the first field of an ERD decides its type
+DATA_TYPES = {
+    'bool': 'erdDataTypeBool',
+    'enum': 'erdDataTypeEnum',
+    'string': 'erdDataTypeString',
+}
+
+
+def field_data_type(field_type: str) -> str:
+    """Map the type of an ERD data field to an erdDataType constant."""
+    if field_type in DATA_TYPES:
+        return DATA_TYPES[field_type]
+    if re.fullmatch(r'u\d+', field_type):
+        return 'erdDataTypeUnsigned'
+    if re.fullmatch(r'i\d+', field_type):
+        return 'erdDataTypeSigned'
+    return 'erdDataTypeRaw'
 
 
-def generate_header(categories: Dict[str, List[int]], polling_list_max_size: int) -> str:
+def parse_erd_metadata(erd: Dict) -> Tuple[int, str, str]:
+    """
+    Work out the payload size, access and data type of one ERD definition.
+
+    The size is the end of the furthest field, or 0 when any field has no size or
+    the payload does not fit in a GEA3 packet. ERDs without a list of operations
+    are assumed to allow both reads and writes.
+    """
+    fields = erd.get('data') or []
+    size = 0
+    next_offset = 0
+    for field in fields:
+        field_size = field.get('size')
+        offset = field.get('offset', next_offset)
+        if not isinstance(field_size, int) or not isinstance(offset, int):
+            size = 0
+            break
+        next_offset = offset + field_size
+        size = max(size, next_offset)
+    if size > 255:
+        size = 0
+
+    operations = erd.get('operations')
+    if operations:
+        flags = []
+        if 'read' in operations:
+            flags.append('erdAccessRead')
+        if 'write' in operations:
+            flags.append('erdAccessWrite')
+        access = ' | '.join(flags) if flags else '0'
+    else:
+        access = 'erdAccessRead | erdAccessWrite'
+
+    if len(fields) > 1:
+        data_type = 'erdDataTypeStruct'
+    elif fields:
+        data_type = field_data_type(str(fields[0].get('type', '')))
+    else:
+        data_type = 'erdDataTypeRaw'
+
+    return size, access, data_type
+
+
+def generate_erd_metadata(categories: Dict[str, List[int]], metadata: Dict[int, Tuple[int, str, str]]) -> str:
+    """Generate the per-ERD metadata table in dense index order, plus its lookups."""
+    unknown = (0, 'erdAccessRead | erdAccessWrite', 'erdDataTypeRaw')
+
+    table = """// Access, payload size and data type of every known ERD. ERDs that are not documented
+// have an unknown size and allow both reads and writes.
+enum {
+  erdAccessRead = 0x01,
+  erdAccessWrite = 0x02
+};
+
+enum {
+  erdDataTypeRaw,
+  erdDataTypeBool,
+  erdDataTypeUnsigned,
+  erdDataTypeSigned,
+  erdDataTypeEnum,
+  erdDataTypeString,
+  erdDataTypeStruct
+};
+
+typedef struct {
+  uint8_t size; // Payload size in bytes, or 0 if it is unknown or variable
+  uint8_t access : 2;
+  uint8_t dataType : 6;
+} erdMetadata_t;
+
+// Indexed by erdIndex()
+constexpr erdMetadata_t erdMetadataTable[KNOWN_ERD_COUNT] = {
+"""
+    for category in ['common', 'refrigeration', 'laundry', 'dishWasher', 'waterHeater', 'range',
+                     'airConditioning', 'waterFilter', 'smallAppliance', 'energy']:
+        for erd in categories[category]:
+            size, access, data_type = metadata.get(erd, unknown)
+            table += f"  {{ {size}, {access}, {data_type} }}, // 0x{erd:04x}\n"
+    table += """};
+
+// Metadata of an ERD, or nullptr if it is in none of the lists above
+constexpr const erdMetadata_t* erdMetadata(tiny_erd_t erd)
+{
+  return (erdIndex(erd) == UNKNOWN_ERD_INDEX) ? nullptr : &erdMetadataTable[erdIndex(erd)];
+}
+
+// False if the ERD is known to be read only or to have a different payload size
+constexpr bool erdWriteIsValid(tiny_erd_t erd, uint8_t size)
+{
+  const erdMetadata_t* metadata = erdMetadata(erd);
+  return !metadata ||
+    ((metadata->access & erdAccessWrite) && ((metadata->size == 0) || (metadata->size == size)));
+}
+
+"""
+    return table
+
+
+def generate_header(
+        categories: Dict[str, List[int]],
+        metadata: Dict[int, Tuple[int, str, str]],
+        appliance_types: Optional[List[int]] = None) -> str:
     """Generate the complete erd_lists.h header file."""
+    if appliance_types:
+        scope = ' * Only the lists for appliance types ' + ', '.join(f'0x{t:02X}' for t in appliance_types) + \
+            ' are included;\n * the others are empty.\n'
+    else:
+        scope = ''
+
     header = f"""/*!
  * @file
  * @brief Erd lists for various appliances
  * 
  * This file is auto-generated from appliance_api_erd_definitions.json
  * Do not edit this file manually. Run scripts/generate_erd_lists.py to regenerate.
- */
+{scope} */
 
 #ifndef ERD_LISTS_H
 #define ERD_LISTS_H
 
 #include "tiny_erd.h"
 
-// Maximum number of ERDs that can be held in the polling list.
-// Sized for the worst case: common ERDs + energy ERDs + largest appliance-specific ERD list.
-#define POLLING_LIST_MAX_SIZE {polling_list_max_size}
-
 """
     
-    # Generate each category
-    category_info = [
-        ('common', 'commonErds', 'commonErdCount', '0x0000 to 0x0FFF: common ERDs (all appliance types)'),
-        ('refrigeration', 'refrigerationErds', 'refrigerationErdCount', '0x1000 to 0x1FFF: refrigeration ERDs'),
-        ('laundry', 'laundryErds', 'laundryErdCount', '0x2000 to 0x2FFF: laundry ERDs'),
-        ('dishWasher', 'dishWasherErds', 'dishWasherErdCount', '0x3000 to 0x3FFF: dishwasher ERDs'),
-        ('waterHeater', 'waterHeaterErds', 'waterHeaterErdCount', '0x4000 to 0x4FFF: waterHeater ERDs'),
-        ('range', 'rangeErds', 'rangeErdCount', '0x5000 to 0x5FFF: range ERDs (stoves, cooktops, ovens, etc)'),
-        ('airConditioning', 'airConditioningErds', 'airConditioningErdCount', '0x7000 to 0x7FFF: air conditioning ERDs (mini split, Zoneline, etc)'),
-        ('waterFilter', 'waterFilterErds', 'waterFilterErdCount', '0x8000 to 0x8FFF: water filter ERDs'),
-        ('smallAppliance', 'smallApplianceErds', 'smallApplianceErdCount', '0x9000 to 0x9FFF: small appliance ERDs (coffee makers, etc)'),
-        ('energy', 'energyErds', 'energyErdCount', '0xD000 to 0xDFFF: energy ERDs (all appliance types)')
-    ]
-    
-    for category_key, array_name, count_name, description in category_info:
-        erds = categories[category_key]
+    header += ERD_LIST_TYPES
+
+    for category_key, array_name, count_name, description in CATEGORY_INFO:
         header += f"// {description}\n"
-        header += f"const tiny_erd_t {array_name}[] = {{\n"
-        if erds:
-            header += format_erd_list(erds)
-            header += "\n"
-        header += "};\n"
-        header += f"const uint16_t {count_name} = sizeof({array_name}) / sizeof({array_name}[0]);\n\n"
-    
+        header += format_erd_list(array_name, count_name, categories[category_key]) + "\n"
+
+    header += "// Common ERDs that mqtt_bridge_polling.cpp probes on every appliance\n"
+    header += format_erd_list('probedCommonErds', 'probedCommonErdCount', PROBED_COMMON_ERDS) + "\n"
+
+    header += generate_erd_index(categories)
+    header += generate_erd_metadata(categories, metadata)
+
     # Add the lookup table structure
-    header += """typedef struct {
-  const tiny_erd_t* erdList;
-  uint16_t erdCount;
-} applianceTypeToErdListAndCount_t;
-
-const applianceTypeToErdListAndCount_t applianceTypeToErdGroupTranslation[] = {
-  { waterHeaterErds, waterHeaterErdCount }, // 0x00 = Water heater
-  { laundryErds, laundryErdCount }, // 0x01 = Clothes washer
-  { laundryErds, laundryErdCount }, // 0x02 = Clothes dryer
-  { refrigerationErds, refrigerationErdCount }, // 0x03 = Refrigerator
-  { smallApplianceErds, smallApplianceErdCount }, // 0x04 = Microwave
-  { rangeErds, rangeErdCount }, // 0x05 = Advantium
-  { dishWasherErds, dishWasherErdCount }, // 0x06 = Dishwasher
-  { rangeErds, rangeErdCount }, // 0x07 = Oven
-  { rangeErds, rangeErdCount }, // 0x08 = Electric range
-  { rangeErds, rangeErdCount }, // 0x09 = Gas range
-  { airConditioningErds, airConditioningErdCount }, // 0x0A = Thermostat/RAC
-  { rangeErds, rangeErdCount }, // 0x0B = Electric Cooktop
-  { rangeErds, rangeErdCount }, // 0x0C = Pizza Oven
-  { rangeErds, rangeErdCount }, // 0x0D = Gas Cooktop
-  { airConditioningErds, airConditioningErdCount }, // 0x0E = Split / DFS (Duct-Free Split) AC
-  { rangeErds, rangeErdCount }, // 0x0F = Hood
-  { waterFilterErds, waterFilterErdCount }, // 0x10 = Point of Entry Water Filter
-  { rangeErds, rangeErdCount }, // 0x11 = Induction Cooktop
-  { refrigerationErds, refrigerationErdCount }, // 0x12 = Delivery Box
-  { rangeErds, rangeErdCount }, // 0x13 = Kitchen Hub Vent Hood
-  { airConditioningErds, airConditioningErdCount }, // 0x14 = Zoneline/PTAC
-  { waterFilterErds, waterFilterErdCount }, // 0x15 = Water Softener
-  { airConditioningErds, airConditioningErdCount }, // 0x16 = Portable AC
-  { laundryErds, laundryErdCount }, // 0x17 = Combination Washer Dryer
-  { refrigerationErds, refrigerationErdCount }, // 0x18 = Dual Zone Wine Chiller
-  { refrigerationErds, refrigerationErdCount }, // 0x19 = Beverage Center
-  { smallApplianceErds, smallApplianceErdCount }, // 0x1A = Coffee Brewer
-  { smallApplianceErds, smallApplianceErdCount }, // 0x1B = Opal Nugget Ice Maker
-  { refrigerationErds, refrigerationErdCount }, // 0x1C = In-Home Grower
-  { airConditioningErds, airConditioningErdCount }, // 0x1D = Dehumidifer
-  { refrigerationErds, refrigerationErdCount }, // 0x1E = Under Counter Ice Maker
-  { airConditioningErds, airConditioningErdCount }, // 0x1F = Through Wall AC
-  { dishWasherErds, dishWasherErdCount }, // 0x20 = F&P DishDrawer
-  { smallApplianceErds, smallApplianceErdCount }, // 0x21 = Espresso Coffee Maker
-  { smallApplianceErds, smallApplianceErdCount }, // 0x22 = Toaster Oven
-  { airConditioningErds, airConditioningErdCount }, // 0x23 = Zoneline/VTAC
-  { airConditioningErds, airConditioningErdCount }, // 0x24 = Central DFS (Duct-Free Split) Controller
-  { smallApplianceErds, smallApplianceErdCount }, // 0x25 = BLE Mesh Gateway
-  { smallApplianceErds, smallApplianceErdCount }, // 0x26 = Stand Mixer
-  { rangeErds, rangeErdCount }, // 0x27 = Fisher & Paykel Cooktop
-  { rangeErds, rangeErdCount }, // 0x28 = Fisher & Paykel Cooktop Teppanyaki
-  { rangeErds, rangeErdCount }, // 0x29 = Fisher & Paykel Ventilation Downdraft
-  { smallApplianceErds, smallApplianceErdCount }, // 0x2A = Smart Plug
-  { smallApplianceErds, smallApplianceErdCount }, // 0x2B = Smoker
-  { airConditioningErds, airConditioningErdCount }, // 0x2C = Air Handler VRF
-  { laundryErds, laundryErdCount }, // 0x2D = Fabric Care Cabinet Closet
-  { laundryErds, laundryErdCount }, // 0x2E = Laundry Center
-  { rangeErds, rangeErdCount }, // 0x2F = Grill
-  { refrigerationErds, refrigerationErdCount }, // 0x30 = Freezer
-  { rangeErds, rangeErdCount }, // 0x31 = Warming Drawer
-  { smallApplianceErds, smallApplianceErdCount }, // 0x32 = Vacuum Seal Drawer
-  { refrigerationErds, refrigerationErdCount }, // 0x33 = Wine Cabinet
-  { airConditioningErds, airConditioningErdCount }, // 0x34 = Central AC
-  { rangeErds, rangeErdCount }, // 0x35 = Hearth Pizza Oven
-  { smallApplianceErds, smallApplianceErdCount }, // 0x36 = Sourdough Starter
-};
-const uint16_t maximumApplianceType = sizeof(applianceTypeToErdGroupTranslation) / sizeof(applianceTypeToErdGroupTranslation[0]);
+    header += """constexpr const erdList_t* applianceTypeToErdGroupTranslation[] = {
+"""
+    for appliance_type, (category, name) in enumerate(APPLIANCE_TYPE_CATEGORIES):
+        header += f"  &{category}Erds, // 0x{appliance_type:02X} = {name}\n"
+    header += """};
+constexpr uint16_t maximumApplianceType = sizeof(applianceTypeToErdGroupTranslation) / sizeof(applianceTypeToErdGroupTranslation[0]);
 #endif
 """
     
     return header
 
 
-def read_common_erds_count(repo_root: Path) -> int:
-    """Read the number of entries in common_erds[] from mqtt_bridge_polling.cpp."""
-    polling_cpp = repo_root / 'components' / 'geappliances_bridge' / 'mqtt_bridge_polling.cpp'
-    content = polling_cpp.read_text()
-    match = re.search(r'common_erds\[\]\s*=\s*\{([^}]*)\}', content, re.DOTALL)
-    if not match:
-        print("Error: could not find common_erds[] in mqtt_bridge_polling.cpp", file=sys.stderr)
-        sys.exit(1)
-    # Strip line comments before counting hex values to avoid matching values in comments
-    body = re.sub(r'//[^\n]*', '', match.group(1))
-    return len(re.findall(r'0x[0-9a-fA-F]+', body))
+def generate_erd_lists(data: Dict, appliance_types: Optional[List[int]] = None, log=print) -> str:
+    """
+    Generate erd_lists.h from parsed ERD definitions.
+
+    With a list of appliance types, only the common and energy lists and the lists
+    those appliance types poll are filled in; the dense index and the metadata table
+    shrink to match. Without one, every list is generated.
+    """
+    erds = data.get('erds', [])
+    log(f"Found {len(erds)} ERD definitions")
+
+    # Categorize ERDs
+    categories = categorize_erds(erds)
+
+    # Print statistics
+    log("\nERD counts by category:")
+    for category, erd_list in categories.items():
+        log(f"  {category}: {len(erd_list)}")
+
+    # The polling bridge probes its own list of common ERDs on every appliance. Some of
+    # them are not documented, but they still need a dense index to be tracked.
+    undocumented = sorted(set(PROBED_COMMON_ERDS) - set(categories['common']))
+    categories['common'] = sorted(set(categories['common']) | set(PROBED_COMMON_ERDS))
+    log(f"\nAdded {len(undocumented)} undocumented common ERDs probed by mqtt_bridge_polling.cpp")
+
+    included = categories_for_appliance_types(appliance_types)
+    for category in categories:
+        if category not in included:
+            categories[category] = []
+    if appliance_types:
+        log(f"Keeping only the lists for appliance types {appliance_types}: {', '.join(sorted(included))}")
+
+    known_erd_count = sum(len(erd_list) for erd_list in categories.values())
+    run_count = sum(len(erd_runs(erd_list)) for erd_list in categories.values())
+    log(f"Known ERDs in the dense index: {known_erd_count}, in {run_count} runs of consecutive ERDs")
+
+    metadata = {parse_erd_id(erd['id']): parse_erd_metadata(erd) for erd in erds}
+    sized = sum(1 for size, _, _ in metadata.values() if size)
+    log(f"ERDs with a known payload size: {sized}")
+
+    return generate_header(categories, metadata, appliance_types)
 
 
 def main():
     """Main entry point for the script."""
+    parser = argparse.ArgumentParser(description='Generate erd_lists.h from the ERD definitions.')
+    parser.add_argument(
+        '--appliance-types',
+        help='Comma-separated appliance types (values of ERD 0x0008) to generate lists for; all by default')
+    args = parser.parse_args()
+    appliance_types = [int(t, 0) for t in args.appliance_types.split(',')] if args.appliance_types else None
+
     # Determine paths relative to script location
     script_dir = Path(__file__).parent
     repo_root = script_dir.parent
@@ -235,35 +627,12 @@ def main():
     print(f"Reading ERD definitions from {json_file}")
     with open(json_file, 'r') as f:
         data = json.load(f)
-    
-    erds = data.get('erds', [])
-    print(f"Found {len(erds)} ERD definitions")
-    
-    # Categorize ERDs
-    categories = categorize_erds(erds)
-    
-    # Print statistics
-    print("\nERD counts by category:")
-    for category, erd_list in categories.items():
-        print(f"  {category}: {len(erd_list)}")
-    
-    # Calculate required POLLING_LIST_MAX_SIZE.
-    # The polling list holds: common ERDs + energy ERDs + appliance-specific ERDs.
-    # Use the worst case across all appliance-specific categories.
-    appliance_specific_categories = [
-        'waterHeater', 'laundry', 'refrigeration', 'smallAppliance',
-        'range', 'dishWasher', 'airConditioning', 'waterFilter'
-    ]
-    max_appliance_erds = max(len(categories[cat]) for cat in appliance_specific_categories)
-    common_erds_count = read_common_erds_count(repo_root)
-    energy_erds_count = len(categories['energy'])
-    polling_list_max_size = common_erds_count + energy_erds_count + max_appliance_erds
-    print(f"\nPolling list size check:")
-    print(f"  common ERDs: {common_erds_count}, energy ERDs: {energy_erds_count}, max appliance ERDs: {max_appliance_erds}")
-    print(f"  POLLING_LIST_MAX_SIZE: {polling_list_max_size}")
-
-    # Generate header (includes POLLING_LIST_MAX_SIZE)
-    header_content = generate_header(categories, polling_list_max_size)
+
+    try:
+        header_content = generate_erd_lists(data, appliance_types)
+    except ValueError as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
     
     # Write output
     print(f"\nWriting generated header to {output_file}")
@@ -0,0 +1,76 @@
+/*!
+ * @file
+ * @brief Counts the heap allocations made through operator new and delete.
+ *
+ * Counting happens between allocation_counter_begin and allocation_counter_end,
+ * which usually bracket the steady-state part of a test. Each allocation made in
+ * that scope is remembered until it is freed, so the scope's live bytes and their
+ * peak are measured from zero and ignore memory that was allocated before it. If
+ * more than allocation_counter_tracked_allocations are live at once the rest are
+ * still counted but never subtracted, so the peak can only read high.
+ *
+ * The counts only move when the test binary is linked with operator new and
+ * delete wrapped (see the Makefile), which GNU ld supports. Elsewhere tests that
+ * depend on them skip themselves with SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED.
+ */
+
+#ifndef allocation_counter_hpp
+#define allocation_counter_hpp
+
+#include <stdint.h>
+#include "CppUTest/TestHarness.h"
+
+enum {
+  allocation_counter_tracked_allocations = 256
+};
+
+typedef struct {
+  uint32_t allocations;
+  uint32_t deallocations;
+  uint32_t bytes;
+  uint32_t live_bytes;
+  uint32_t peak_bytes;
+} allocation_counter_counts_t;
+
+bool allocation_counter_is_enabled();
+
+/*!
+ * Start a new scope with every count at zero.
+ */
+void allocation_counter_begin();
+
+/*!
+ * Stop counting. The counts keep their values until the next scope begins.
+ */
+void allocation_counter_end();
+
+const allocation_counter_counts_t* allocation_counter_counts();
+
+#define SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED() \
+  do {                                        \
+    if(!allocation_counter_is_enabled()) {    \
+      TEST_EXIT;                              \
+    }                                         \
+  } while(0)
+
+#define CHECK_ALLOCATIONS_AT_MOST(budget)                              \
+  CHECK_TEXT(                                                          \
+    allocation_counter_counts()->allocations <= (budget),              \
+    StringFromFormat(                                                  \
+      "%u allocations, budget %u",                                     \
+      static_cast<unsigned>(allocation_counter_counts()->allocations), \
+      static_cast<unsigned>(budget))                                   \
+      .asCharString())
+
+#define CHECK_NO_ALLOCATIONS() CHECK_ALLOCATIONS_AT_MOST(0)
+
+#define CHECK_PEAK_HEAP_AT_MOST(budget)                               \
+  CHECK_TEXT(                                                         \
+    allocation_counter_counts()->peak_bytes <= (budget),              \
+    StringFromFormat(                                                 \
+      "%u bytes peak heap, budget %u",                                \
+      static_cast<unsigned>(allocation_counter_counts()->peak_bytes), \
+      static_cast<unsigned>(budget))                                  \
+      .asCharString())
+
+#endif
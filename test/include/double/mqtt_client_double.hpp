@@ -11,11 +11,26 @@ extern "C" {
 #include "tiny_event.h"
 }
 
+enum {
+  mqtt_client_double_max_hosts = 8
+};
+
+typedef struct {
+  i_mqtt_client_t interface;
+
+  tiny_event_t on_write_request;
+  void* parent;
+  uint8_t address;
+} mqtt_client_double_host_t;
+
 typedef struct {
   i_mqtt_client_t interface;
 
   tiny_event_t on_write_request;
   tiny_event_t on_mqtt_disconnect;
+
+  mqtt_client_double_host_t hosts[mqtt_client_double_max_hosts];
+  uint8_t host_count;
 } mqtt_client_double_t;
 
 /*!
@@ -32,6 +47,24 @@ void mqtt_client_double_trigger_write_request(
   uint8_t size,
   const void* value);
 
+/*!
+ * Get the host namespace client for an address. Register and update calls made in
+ * that namespace are reported with this client as the mock object.
+ */
+i_mqtt_client_t* mqtt_client_double_host(
+  mqtt_client_double_t* self,
+  uint8_t address);
+
+/*!
+ * Trigger publication via the on_write_request event of a host namespace.
+ */
+void mqtt_client_double_trigger_host_write_request(
+  mqtt_client_double_t* self,
+  uint8_t address,
+  tiny_erd_t erd,
+  uint8_t size,
+  const void* value);
+
 /*!
  * Trigger publication via the on_mqtt_disconnect event.
  */
@@ -0,0 +1,26 @@
+/*!
+ * @file
+ * @brief Read timeout configuration for tests that step the polling bridge read by read.
+ *
+ * The initial, minimum and maximum timeouts are equal, so the timeout never adapts
+ * and the tests control exactly when reads are given up on.
+ */
+
+#ifndef fixed_read_timeout_hpp
+#define fixed_read_timeout_hpp
+
+extern "C" {
+#include "rtt_estimator.h"
+}
+
+enum {
+  fixed_read_timeout = 100
+};
+
+static const rtt_estimator_configuration_t fixed_read_timeout_configuration = {
+  fixed_read_timeout,
+  fixed_read_timeout,
+  fixed_read_timeout
+};
+
+#endif
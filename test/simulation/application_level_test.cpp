@@ -17,6 +17,7 @@ extern "C" {
 #include "double/mqtt_client_double.hpp"
 #include "double/tiny_gea3_erd_client_double.hpp"
 #include "double/tiny_timer_group_double.hpp"
+#include "fixed_read_timeout.hpp"
 
 /*!
  * Test group for application-level integration tests.
@@ -43,6 +44,8 @@ TEST_GROUP(application_level)
   
   mqtt_bridge_t mqtt_bridge;
   mqtt_bridge_polling_t mqtt_bridge_polling;
+  bool mqtt_bridge_initialized;
+  bool mqtt_bridge_polling_initialized;
   
   tiny_timer_group_double_t timer_group;
   tiny_gea3_erd_client_double_t erd_client;
@@ -55,12 +58,19 @@ TEST_GROUP(application_level)
     tiny_timer_group_double_init(&timer_group);
     tiny_gea3_erd_client_double_init(&erd_client);
     mqtt_client_double_init(&mqtt_client);
+    mqtt_bridge_initialized = false;
+    mqtt_bridge_polling_initialized = false;
   }
   
   void teardown()
   {
-    mqtt_bridge_destroy(&mqtt_bridge);
-    mqtt_bridge_polling_destroy(&mqtt_bridge_polling);
+    // Only bridges that were initialized have subscriptions and timers to release
+    if(mqtt_bridge_initialized) {
+      mqtt_bridge_destroy(&mqtt_bridge);
+    }
+    if(mqtt_bridge_polling_initialized) {
+      mqtt_bridge_polling_destroy(&mqtt_bridge_polling);
+    }
     mock().clear();
   }
   
@@ -75,6 +85,7 @@ TEST_GROUP(application_level)
       &erd_client.interface,
       &mqtt_client.interface,
       appliance_address);
+    mqtt_bridge_initialized = true;
   }
   
   /*!
@@ -88,7 +99,10 @@ TEST_GROUP(application_level)
       &erd_client.interface,
       &mqtt_client.interface,
       polling_interval,
-      false);
+      false,
+      erd_value_cache_mode_full_copy,
+      &fixed_read_timeout_configuration);
+    mqtt_bridge_polling_initialized = true;
   }
   
   /*!
@@ -0,0 +1,414 @@
+/*!
+ * @file
+ * @brief Boot-time benchmark comparing full autodiscovery against a cached identity.
+ *
+ * A cold boot runs the autodiscovery module the component uses: it samples a quiet
+ * bus until it settles, broadcasts, selects the appliance and reads its identity.
+ * The reads go through the GEA3 ERD client double to a simulated appliance that
+ * answers them one after another, each after a bus round trip. The identity that
+ * was read is then saved through the cached identity module into a preference
+ * store that survives a reboot. A cached boot restores from that store and
+ * verifies the serial number over the bus while the bridge is already running,
+ * the same way the component does. Boot to bridge is the timer group's time from
+ * power-on until the bridge subscribes to the appliance; MQTT is assumed to be
+ * connected by then.
+ */
+
+extern "C" {
+#include "autodiscovery.h"
+#include "bus_activity_monitor.h"
+#include "cached_identity.h"
+#include "mqtt_bridge.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/mqtt_client_double.hpp"
+#include "double/tiny_gea3_erd_client_double.hpp"
+#include "double/tiny_timer_group_double.hpp"
+
+enum {
+  ERD_MODEL_NUMBER = 0x0001,
+  ERD_SERIAL_NUMBER = 0x0002,
+  ERD_APPLIANCE_TYPE = 0x0008,
+
+  APPLIANCE_ADDRESS = 0xC0,
+  APPLIANCE_TYPE = 6,
+  BROADCAST_ADDRESS = 0xFF,
+
+  // Request plus response for a 32-byte ERD at 230400 baud, with time for the appliance to answer
+  BUS_ROUND_TRIP = 20,
+
+  MAX_PENDING_READS = 8
+};
+
+static const uint8_t model_number[32] = { 'Z', 'L', '4', '2', '0', '0', 'A', 'B', 'C' };
+
+// The appliance, the flash preference, which survives a reboot, and what the component does
+// with the results
+typedef struct {
+  tiny_timer_group_double_t* timer_group;
+  tiny_gea3_erd_client_double_t* erd_client;
+  autodiscovery_t* autodiscovery;
+  cached_identity_t* identity;
+
+  tiny_timer_t appliance_timer;
+  tiny_erd_t pending_reads[MAX_PENDING_READS];
+  uint8_t pending_read_count;
+  bool appliance_answers;
+  const uint8_t* appliance_serial_number;
+  uint8_t read_count;
+
+  bus_activity_monitor_t bus_monitor;
+
+  uint8_t serial_number[32];
+  bool identity_read;
+  tiny_time_source_ticks_t identity_read_at;
+
+  identity_cache_record_t flash;
+  bool has_record;
+  bool verification_finished;
+  cached_identity_result_t verification_result;
+} platform_t;
+
+static void appliance_answer_next_read(void* context)
+{
+  auto platform = static_cast<platform_t*>(context);
+  tiny_erd_t erd = platform->pending_reads[0];
+  platform->pending_read_count--;
+  memmove(platform->pending_reads, platform->pending_reads + 1, platform->pending_read_count * sizeof(tiny_erd_t));
+
+  if(platform->pending_read_count > 0) {
+    tiny_timer_start(&platform->timer_group->timer_group, &platform->appliance_timer, BUS_ROUND_TRIP, platform, appliance_answer_next_read);
+  }
+
+  uint8_t type = APPLIANCE_TYPE;
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.address = APPLIANCE_ADDRESS;
+
+  if(!platform->appliance_answers) {
+    args.type = tiny_gea3_erd_client_activity_type_read_failed;
+    args.read_failed.request_id = 0;
+    args.read_failed.erd = erd;
+    args.read_failed.reason = tiny_gea3_erd_client_read_failure_reason_retries_exhausted;
+  }
+  else {
+    args.type = tiny_gea3_erd_client_activity_type_read_completed;
+    args.read_completed.request_id = 0;
+    args.read_completed.erd = erd;
+    if(erd == ERD_APPLIANCE_TYPE) {
+      args.read_completed.data = &type;
+      args.read_completed.data_size = sizeof(type);
+    }
+    else {
+      args.read_completed.data = (erd == ERD_MODEL_NUMBER) ? model_number : platform->appliance_serial_number;
+      args.read_completed.data_size = 32;
+    }
+  }
+
+  tiny_gea3_erd_client_double_trigger_activity_event(platform->erd_client, &args);
+}
+
+// Reads are queued on the ERD client and answered by the appliance in order, one round trip each
+static bool read(platform_t* platform, uint8_t address, tiny_erd_t erd)
+{
+  tiny_gea3_erd_client_request_id_t request_id;
+  if(!tiny_gea3_erd_client_read(&platform->erd_client->interface, &request_id, address, erd)) {
+    return false;
+  }
+  platform->read_count++;
+
+  if((address == APPLIANCE_ADDRESS) || (address == BROADCAST_ADDRESS)) {
+    platform->pending_reads[platform->pending_read_count++] = erd;
+    if(!tiny_timer_is_running(&platform->timer_group->timer_group, &platform->appliance_timer)) {
+      tiny_timer_start(&platform->timer_group->timer_group, &platform->appliance_timer, BUS_ROUND_TRIP, platform, appliance_answer_next_read);
+    }
+  }
+  return true;
+}
+
+// Serial number reads go to the cached identity first, then to autodiscovery, as in the component
+static void route_read(platform_t* platform, const tiny_gea3_erd_client_on_activity_args_t* args)
+{
+  if(args->type == tiny_gea3_erd_client_activity_type_read_completed) {
+    if((args->read_completed.erd == ERD_SERIAL_NUMBER) &&
+      cached_identity_read_finished(platform->identity, args->address, true, args->read_completed.data, args->read_completed.data_size)) {
+      return;
+    }
+    autodiscovery_read_finished(
+      platform->autodiscovery,
+      autodiscovery_protocol_gea3,
+      args->address,
+      args->read_completed.erd,
+      true,
+      args->read_completed.data,
+      args->read_completed.data_size);
+  }
+  else if(args->type == tiny_gea3_erd_client_activity_type_read_failed) {
+    if((args->read_failed.erd == ERD_SERIAL_NUMBER) &&
+      cached_identity_read_finished(platform->identity, args->address, false, nullptr, 0)) {
+      return;
+    }
+    autodiscovery_read_finished(platform->autodiscovery, autodiscovery_protocol_gea3, args->address, args->read_failed.erd, false, nullptr, 0);
+  }
+}
+
+static const autodiscovery_callbacks_t autodiscovery_callbacks = {
+  +[](void* context) {
+    auto platform = static_cast<platform_t*>(context);
+    bus_activity_monitor_sample(&platform->bus_monitor, 0, 0);
+    return bus_activity_monitor_is_settled(&platform->bus_monitor);
+  },
+  +[](void* context, autodiscovery_protocol_t, uint8_t address, tiny_erd_t erd) {
+    return read(static_cast<platform_t*>(context), address, erd);
+  },
+  +[](void*, autodiscovery_protocol_t, uint8_t, uint8_t) {
+  },
+  +[](void* context, tiny_erd_t erd, const void* data, uint8_t data_size) {
+    auto platform = static_cast<platform_t*>(context);
+    if(erd == ERD_SERIAL_NUMBER) {
+      memcpy(platform->serial_number, data, data_size);
+    }
+  },
+  +[](void* context, autodiscovery_progress_t progress) {
+    auto platform = static_cast<platform_t*>(context);
+    if(progress == autodiscovery_progress_identity_read) {
+      platform->identity_read = true;
+      platform->identity_read_at = platform->timer_group->time_source.ticks;
+    }
+  }
+};
+
+static const cached_identity_callbacks_t cached_identity_callbacks = {
+  +[](void* context, identity_cache_record_t* record) {
+    auto platform = static_cast<platform_t*>(context);
+    memcpy(record, &platform->flash, sizeof(*record));
+    return platform->has_record;
+  },
+  +[](void* context, const identity_cache_record_t* record) {
+    auto platform = static_cast<platform_t*>(context);
+    memcpy(&platform->flash, record, sizeof(*record));
+    platform->has_record = true;
+    return true;
+  },
+  +[](void* context, uint8_t address) {
+    return read(static_cast<platform_t*>(context), address, ERD_SERIAL_NUMBER);
+  },
+  +[](void* context, cached_identity_result_t result, const void*, uint8_t) {
+    auto platform = static_cast<platform_t*>(context);
+    platform->verification_finished = true;
+    platform->verification_result = result;
+  }
+};
+
+TEST_GROUP(boot_time_benchmark)
+{
+  enum {
+    // Quiet samples until the bus settles, then the broadcast and three identity reads. The
+    // preferred address answers, so the broadcast window closes without a quiet period.
+    cold_boot_to_bridge = (bus_activity_monitor_stable_samples + 1) * autodiscovery_bus_settle_sample_period + 4 * BUS_ROUND_TRIP
+  };
+
+  mqtt_bridge_t mqtt_bridge;
+  bool bridge_running;
+  autodiscovery_t autodiscovery;
+  cached_identity_t identity;
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  mqtt_client_double_t mqtt_client;
+  tiny_event_subscription_t erd_client_activity_subscription;
+  platform_t platform;
+
+  const uint8_t serial_number[32] = { 'S', 'N', '1', '2', '3', '4', '5', '6', '7', '8' };
+  const uint8_t replacement_serial_number[32] = { 'S', 'N', '8', '7', '6', '5', '4', '3', '2', '1' };
+
+  void setup()
+  {
+    memset(&platform, 0, sizeof(platform));
+    bridge_running = false;
+    power_on(serial_number);
+  }
+
+  void power_on(const uint8_t* appliance_serial_number)
+  {
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    mqtt_client_double_init(&mqtt_client);
+
+    // Only the flash survives a reboot
+    identity_cache_record_t flash = platform.flash;
+    bool has_record = platform.has_record;
+    memset(&platform, 0, sizeof(platform));
+    platform.flash = flash;
+    platform.has_record = has_record;
+
+    platform.timer_group = &timer_group;
+    platform.erd_client = &erd_client;
+    platform.autodiscovery = &autodiscovery;
+    platform.identity = &identity;
+    platform.appliance_answers = true;
+    platform.appliance_serial_number = appliance_serial_number;
+    bus_activity_monitor_init(&platform.bus_monitor);
+
+    const autodiscovery_configuration_t configuration = { true, false, APPLIANCE_ADDRESS, 0xA0 };
+    autodiscovery_init(&autodiscovery, &timer_group.timer_group, &configuration, &autodiscovery_callbacks, &platform);
+    cached_identity_init(&identity, &timer_group.timer_group, &cached_identity_callbacks, &platform);
+
+    tiny_event_subscription_init(
+      &erd_client_activity_subscription, &platform, +[](void* context, const void* args) {
+        route_read(static_cast<platform_t*>(context), reinterpret_cast<const tiny_gea3_erd_client_on_activity_args_t*>(args));
+      });
+    tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&erd_client.interface), &erd_client_activity_subscription);
+  }
+
+  void reboot(const uint8_t* appliance_serial_number)
+  {
+    mock().disable();
+    if(bridge_running) {
+      mqtt_bridge_destroy(&mqtt_bridge);
+      bridge_running = false;
+    }
+    mock().enable();
+    power_on(appliance_serial_number);
+  }
+
+  void teardown()
+  {
+    reboot(serial_number);
+    mock().clear();
+  }
+
+  // The bus and the bridge's own traffic are not under test
+  void after(tiny_timer_ticks_t ticks)
+  {
+    mock().disable();
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+    mock().enable();
+  }
+
+  tiny_time_source_ticks_t now()
+  {
+    return timer_group.time_source.ticks;
+  }
+
+  void the_bridge_starts()
+  {
+    mock().expectOneCall("subscribe").onObject(&erd_client).withParameter("address", APPLIANCE_ADDRESS).andReturnValue(true);
+    mqtt_bridge_init(
+      &mqtt_bridge,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      APPLIANCE_ADDRESS);
+    bridge_running = true;
+    mock().checkExpectations();
+  }
+
+  // Autodiscovery and device ID generation, then the save the component does once they are done
+  tiny_time_source_ticks_t cold_boot()
+  {
+    CHECK_FALSE(cached_identity_restore(&identity));
+
+    autodiscovery_start(&autodiscovery, true);
+    after(autodiscovery_startup_delay);
+    CHECK_TRUE(platform.identity_read);
+    the_bridge_starts();
+
+    identity_cache_record_init(
+      cached_identity_record(&identity),
+      identity_cache_protocol_gea3,
+      autodiscovery_host_address(&autodiscovery),
+      APPLIANCE_TYPE,
+      platform.serial_number,
+      sizeof(platform.serial_number),
+      "Dishwasher_ZL4200ABC_SN12345678");
+    CHECK_TRUE(cached_identity_save(&identity));
+
+    return platform.identity_read_at;
+  }
+
+  // The bridge starts from the restored identity while its serial number is read in the background
+  tiny_time_source_ticks_t cached_boot()
+  {
+    CHECK_TRUE(cached_identity_restore(&identity));
+    autodiscovery_restore(&autodiscovery, autodiscovery_protocol_gea3, cached_identity_record(&identity)->host_address, nullptr, 0);
+
+    mock().disable();
+    cached_identity_verify(&identity);
+    mock().enable();
+    the_bridge_starts();
+
+    return now();
+  }
+};
+
+TEST(boot_time_benchmark, cached_identity_should_start_the_bridge_without_autodiscovery)
+{
+  tiny_time_source_ticks_t cold = cold_boot();
+  uint8_t cold_reads = platform.read_count;
+
+  reboot(serial_number);
+  tiny_time_source_ticks_t cached = cached_boot();
+  CHECK_FALSE(platform.verification_finished);
+
+  after(BUS_ROUND_TRIP);
+  tiny_time_source_ticks_t verified = now();
+
+  SimpleString report = StringFromFormat(
+    "Boot to bridge: cold %lu ms, cached %lu ms (verified at %lu ms)",
+    static_cast<unsigned long>(cold),
+    static_cast<unsigned long>(cached),
+    static_cast<unsigned long>(verified));
+  UT_PRINT(report.asCharString());
+
+  CHECK_EQUAL(cold_boot_to_bridge, cold);
+  CHECK_EQUAL(4, cold_reads);
+  CHECK_EQUAL(1, platform.read_count);
+  CHECK_TRUE(cached < cold);
+  CHECK_TRUE(platform.verification_finished);
+  CHECK_EQUAL(cached_identity_result_verified, platform.verification_result);
+  CHECK_TRUE(cached < verified);
+}
+
+TEST(boot_time_benchmark, cached_identity_should_keep_the_bridge_running_while_the_appliance_does_not_answer)
+{
+  cold_boot();
+
+  reboot(serial_number);
+  platform.appliance_answers = false;
+  cached_boot();
+
+  after(BUS_ROUND_TRIP);
+  CHECK_FALSE(platform.verification_finished);
+  CHECK_TRUE(bridge_running);
+
+  platform.appliance_answers = true;
+  after(cached_identity_retry_delay + BUS_ROUND_TRIP);
+  CHECK_EQUAL(2, platform.read_count);
+  CHECK_TRUE(platform.verification_finished);
+  CHECK_EQUAL(cached_identity_result_verified, platform.verification_result);
+}
+
+TEST(boot_time_benchmark, replaced_appliance_should_run_full_autodiscovery_after_the_reboot)
+{
+  cold_boot();
+
+  reboot(replacement_serial_number);
+  cached_boot();
+
+  after(BUS_ROUND_TRIP);
+  CHECK_EQUAL(cached_identity_result_mismatched, platform.verification_result);
+
+  // The component restarts on a mismatch; the invalidated record sends it through autodiscovery
+  reboot(replacement_serial_number);
+  tiny_time_source_ticks_t rediscovered = cold_boot();
+  CHECK_EQUAL(cold_boot_to_bridge, rediscovered);
+  MEMCMP_EQUAL(replacement_serial_number, platform.serial_number, sizeof(replacement_serial_number));
+
+  reboot(replacement_serial_number);
+  cached_boot();
+  after(BUS_ROUND_TRIP);
+  CHECK_EQUAL(cached_identity_result_verified, platform.verification_result);
+}
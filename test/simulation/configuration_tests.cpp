@@ -17,6 +17,7 @@ extern "C" {
 #include "double/mqtt_client_double.hpp"
 #include "double/tiny_gea3_erd_client_double.hpp"
 #include "double/tiny_timer_group_double.hpp"
+#include "fixed_read_timeout.hpp"
 
 /*!
  * Test group for configuration-based application-level tests.
@@ -65,6 +66,8 @@ TEST_GROUP(configuration_based_tests)
   
   mqtt_bridge_t mqtt_bridge;
   mqtt_bridge_polling_t mqtt_bridge_polling;
+  bool mqtt_bridge_initialized;
+  bool mqtt_bridge_polling_initialized;
   
   tiny_timer_group_double_t timer_group;
   tiny_gea3_erd_client_double_t erd_client;
@@ -77,12 +80,19 @@ TEST_GROUP(configuration_based_tests)
     tiny_timer_group_double_init(&timer_group);
     tiny_gea3_erd_client_double_init(&erd_client);
     mqtt_client_double_init(&mqtt_client);
+    mqtt_bridge_initialized = false;
+    mqtt_bridge_polling_initialized = false;
   }
   
   void teardown()
   {
-    mqtt_bridge_destroy(&mqtt_bridge);
-    mqtt_bridge_polling_destroy(&mqtt_bridge_polling);
+    // Only bridges that were initialized have subscriptions and timers to release
+    if(mqtt_bridge_initialized) {
+      mqtt_bridge_destroy(&mqtt_bridge);
+    }
+    if(mqtt_bridge_polling_initialized) {
+      mqtt_bridge_polling_destroy(&mqtt_bridge_polling);
+    }
     mock().clear();
   }
   
@@ -99,6 +109,7 @@ TEST_GROUP(configuration_based_tests)
       &erd_client.interface,
       &mqtt_client.interface,
       address);
+    mqtt_bridge_initialized = true;
   }
   
   /*!
@@ -115,7 +126,10 @@ TEST_GROUP(configuration_based_tests)
       &erd_client.interface,
       &mqtt_client.interface,
       polling_interval,
-      only_publish_on_change);
+      only_publish_on_change,
+      erd_value_cache_mode_full_copy,
+      &fixed_read_timeout_configuration);
+    mqtt_bridge_polling_initialized = true;
   }
   
   // Helper methods for simulating appliance behavior
@@ -806,7 +820,9 @@ TEST_GROUP(only_publish_on_change_config)
       &erd_client.interface,
       &mqtt_client.interface,
       polling_interval,
-      true);
+      true,
+      erd_value_cache_mode_full_copy,
+      &fixed_read_timeout_configuration);
   }
 
   void configure_always_publish()
@@ -817,7 +833,9 @@ TEST_GROUP(only_publish_on_change_config)
       &erd_client.interface,
       &mqtt_client.interface,
       polling_interval,
-      false);
+      false,
+      erd_value_cache_mode_full_copy,
+      &fixed_read_timeout_configuration);
   }
 
   void simulate_read_completed(tiny_erd_t erd, const uint8_t* data, uint8_t size)
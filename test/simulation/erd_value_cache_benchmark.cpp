@@ -0,0 +1,122 @@
+/*!
+ * @file
+ * @brief Benchmark of the ERD value caches used for change detection while polling.
+ *
+ * Replays polling cycles over the largest appliance ERD list with only_publish_on_change
+ * enabled: every read is looked up and compared, and one value in eight changes per
+ * cycle. The flat cache in full copy and digest modes is measured against the std::map
+ * cache it replaced. All of them must find the same changes; the time per update and
+ * the memory held for values are reported.
+ */
+
+extern "C" {
+#include "erd_value_cache.h"
+}
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "erd_lists.h"
+
+#include "CppUTest/TestHarness.h"
+
+using namespace std;
+
+TEST_GROUP(erd_value_cache_benchmark)
+{
+  enum {
+    cycles = 200,
+    max_value_size = 16
+  };
+
+  uint8_t value[max_value_size];
+
+  // Payload sizes vary like real ERDs do, from flags to strings
+  uint8_t size_of(tiny_erd_t erd)
+  {
+    return 1 + (erd % max_value_size);
+  }
+
+  const uint8_t* value_of(tiny_erd_t erd, uint32_t cycle)
+  {
+    memset(value, static_cast<uint8_t>(erd), sizeof(value));
+    value[0] = static_cast<uint8_t>((erd % 8 == cycle % 8) ? cycle : 0);
+    return value;
+  }
+
+  template <typename Update>
+  uint32_t run(Update update, double* nanoseconds_per_update)
+  {
+    uint32_t changes = 0;
+    auto start = chrono::steady_clock::now();
+
+    for(uint32_t cycle = 0; cycle < cycles; cycle++) {
+      for(erdListIterator_t erds = erdListBegin(&rangeErds); !erdListIteratorDone(&erds); erdListIteratorNext(&erds)) {
+        tiny_erd_t erd = erdListIteratorErd(&erds);
+        changes += update(erd, value_of(erd, cycle), size_of(erd));
+      }
+    }
+
+    auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    *nanoseconds_per_update = static_cast<double>(elapsed.count()) / (cycles * rangeErdCount);
+    return changes;
+  }
+
+  uint32_t run_flat_cache(erd_value_cache_t* cache, erd_value_cache_mode_t mode, double* nanoseconds_per_update)
+  {
+    erd_value_cache_init(cache, mode);
+    for(erdListIterator_t erds = erdListBegin(&rangeErds); !erdListIteratorDone(&erds); erdListIteratorNext(&erds)) {
+      tiny_erd_t erd = erdListIteratorErd(&erds);
+      erd_value_cache_reserve(cache, erd, size_of(erd));
+    }
+
+    return run(
+      [&](tiny_erd_t erd, const uint8_t* data, uint8_t size) {
+        return erd_value_cache_update(cache, erd, data, size);
+      },
+      nanoseconds_per_update);
+  }
+};
+
+TEST(erd_value_cache_benchmark, flat_caches_should_find_the_same_changes_as_the_map_cache)
+{
+  double map_time;
+  double full_copy_time;
+  double digest_time;
+
+  map<tiny_erd_t, vector<uint8_t>> map_cache;
+  uint32_t map_changes = run(
+    [&](tiny_erd_t erd, const uint8_t* data, uint8_t size) {
+      auto it = map_cache.find(erd);
+      if((it != map_cache.end()) && (it->second.size() == size) && (memcmp(it->second.data(), data, size) == 0)) {
+        return false;
+      }
+      map_cache[erd] = vector<uint8_t>(data, data + size);
+      return true;
+    },
+    &map_time);
+
+  erd_value_cache_t full_copy_cache;
+  uint32_t full_copy_changes = run_flat_cache(&full_copy_cache, erd_value_cache_mode_full_copy, &full_copy_time);
+
+  erd_value_cache_t digest_cache;
+  uint32_t digest_changes = run_flat_cache(&digest_cache, erd_value_cache_mode_digest, &digest_time);
+
+  SimpleString report = StringFromFormat(
+    "Lookup and compare of %u ERDs per update: map %.1f ns, full copy %.1f ns (%u bytes of values), digest %.1f ns (%u bytes of digests)",
+    static_cast<unsigned>(rangeErdCount),
+    map_time,
+    full_copy_time,
+    static_cast<unsigned>(full_copy_cache.arena_used),
+    digest_time,
+    static_cast<unsigned>(digest_cache.arena_used));
+  UT_PRINT(report.asCharString());
+
+  CHECK_EQUAL(map_changes, full_copy_changes);
+  CHECK_EQUAL(map_changes, digest_changes);
+  CHECK_EQUAL(rangeErdCount * sizeof(uint32_t), digest_cache.arena_used);
+
+  erd_value_cache_destroy(&full_copy_cache);
+  erd_value_cache_destroy(&digest_cache);
+}
@@ -0,0 +1,134 @@
+/*!
+ * @file
+ * @brief Receive benchmark comparing byte-at-a-time UART reads against bulk reads.
+ *
+ * A fake UART is fed a saturated 230400 baud stream of GEA frames in loop-period
+ * sized slices. The byte-at-a-time path mirrors the previous adapter (check
+ * available, read one byte, handle it) while the bulk path goes through the
+ * receive ring. Both count frames by their ETX byte and the host CPU time spent
+ * per received frame is reported.
+ */
+
+extern "C" {
+#include "uart_rx_ring.h"
+}
+
+#include <chrono>
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  frame_size = 20,
+  etx = 0xE3,
+
+  // 230400 baud with 10 bits per byte
+  wire_bytes_per_second = 23040,
+  loop_period_ms = 16,
+  bytes_per_loop = wire_bytes_per_second * loop_period_ms / 1000,
+  simulated_seconds = 60
+};
+
+typedef struct {
+  uint32_t position;
+  uint32_t available;
+} fake_uart_t;
+
+static uint8_t stream_byte(uint32_t position)
+{
+  uint32_t offset = position % frame_size;
+  return (offset == frame_size - 1) ? static_cast<uint8_t>(etx) : static_cast<uint8_t>(offset);
+}
+
+static uint16_t fake_uart_available(fake_uart_t* uart)
+{
+  return static_cast<uint16_t>(uart->available);
+}
+
+static uint16_t fake_uart_read(void* context, uint8_t* buffer, uint16_t size)
+{
+  auto uart = static_cast<fake_uart_t*>(context);
+  uint16_t count = (uart->available < size) ? static_cast<uint16_t>(uart->available) : size;
+
+  for(uint16_t i = 0; i < count; i++) {
+    buffer[i] = stream_byte(uart->position++);
+  }
+  uart->available -= count;
+
+  return count;
+}
+
+static void count_frames(void* context, const uint8_t* data, uint16_t size)
+{
+  auto frames = static_cast<uint32_t*>(context);
+
+  for(uint16_t i = 0; i < size; i++) {
+    if(data[i] == etx) {
+      (*frames)++;
+    }
+  }
+}
+
+TEST_GROUP(uart_receive_benchmark)
+{
+  fake_uart_t uart;
+  uart_rx_ring_t ring;
+  uint32_t frames;
+
+  void setup()
+  {
+    memset(&uart, 0, sizeof(uart));
+    frames = 0;
+    uart_rx_ring_init(&ring, fake_uart_read, &uart);
+  }
+
+  void poll_byte_at_a_time()
+  {
+    while(fake_uart_available(&uart)) {
+      uint8_t byte;
+      fake_uart_read(&uart, &byte, 1);
+      count_frames(&frames, &byte, 1);
+    }
+  }
+
+  void poll_in_bulk()
+  {
+    uart_rx_ring_run(&ring, count_frames, &frames);
+  }
+
+  double nanoseconds_per_frame(bool bulk)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 0; i < simulated_seconds * 1000 / loop_period_ms; i++) {
+      uart.available += bytes_per_loop;
+      if(bulk) {
+        poll_in_bulk();
+      }
+      else {
+        poll_byte_at_a_time();
+      }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / frames;
+  }
+};
+
+TEST(uart_receive_benchmark, bulk_reads_should_receive_every_frame)
+{
+  double byte_at_a_time = nanoseconds_per_frame(false);
+  uint32_t byte_at_a_time_frames = frames;
+
+  setup();
+  double bulk = nanoseconds_per_frame(true);
+
+  SimpleString report = StringFromFormat(
+    "Saturated 230400 baud receive: byte at a time %.0f ns/frame, bulk %.0f ns/frame",
+    byte_at_a_time,
+    bulk);
+  UT_PRINT(report.asCharString());
+
+  CHECK_EQUAL(byte_at_a_time_frames, frames);
+  CHECK_EQUAL(uart.position / frame_size, frames);
+}
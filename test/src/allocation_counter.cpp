@@ -0,0 +1,134 @@
+/*!
+ * @file
+ * @brief Counts the heap allocations made through operator new and delete.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include "allocation_counter.hpp"
+
+typedef struct {
+  void* pointer;
+  size_t size;
+} tracked_allocation_t;
+
+static allocation_counter_counts_t counts;
+static tracked_allocation_t tracked[allocation_counter_tracked_allocations];
+static uint16_t tracked_count;
+static bool counting;
+
+static void allocated(void* pointer, size_t size)
+{
+  if(!counting || !pointer) {
+    return;
+  }
+
+  counts.allocations++;
+  counts.bytes += static_cast<uint32_t>(size);
+  counts.live_bytes += static_cast<uint32_t>(size);
+  if(counts.live_bytes > counts.peak_bytes) {
+    counts.peak_bytes = counts.live_bytes;
+  }
+
+  if(tracked_count < allocation_counter_tracked_allocations) {
+    tracked[tracked_count].pointer = pointer;
+    tracked[tracked_count].size = size;
+    tracked_count++;
+  }
+}
+
+// Memory allocated before the scope began is freed without being counted
+static void freed(void* pointer)
+{
+  if(!counting || !pointer) {
+    return;
+  }
+
+  for(uint16_t i = 0; i < tracked_count; i++) {
+    if(tracked[i].pointer == pointer) {
+      counts.deallocations++;
+      counts.live_bytes -= static_cast<uint32_t>(tracked[i].size);
+      tracked[i] = tracked[--tracked_count];
+      return;
+    }
+  }
+}
+
+#ifdef ALLOCATION_COUNTER_WRAPS_OPERATOR_NEW
+
+// Linked with -Wl,--wrap so every call to these operators comes here first
+extern "C" void* __real__Znwm(size_t size);
+extern "C" void* __real__Znam(size_t size);
+extern "C" void __real__ZdlPv(void* pointer);
+extern "C" void __real__ZdaPv(void* pointer);
+extern "C" void __real__ZdlPvm(void* pointer, size_t size);
+extern "C" void __real__ZdaPvm(void* pointer, size_t size);
+
+extern "C" void* __wrap__Znwm(size_t size)
+{
+  void* pointer = __real__Znwm(size);
+  allocated(pointer, size);
+  return pointer;
+}
+
+extern "C" void* __wrap__Znam(size_t size)
+{
+  void* pointer = __real__Znam(size);
+  allocated(pointer, size);
+  return pointer;
+}
+
+extern "C" void __wrap__ZdlPv(void* pointer)
+{
+  freed(pointer);
+  __real__ZdlPv(pointer);
+}
+
+extern "C" void __wrap__ZdaPv(void* pointer)
+{
+  freed(pointer);
+  __real__ZdaPv(pointer);
+}
+
+extern "C" void __wrap__ZdlPvm(void* pointer, size_t size)
+{
+  freed(pointer);
+  __real__ZdlPvm(pointer, size);
+}
+
+extern "C" void __wrap__ZdaPvm(void* pointer, size_t size)
+{
+  freed(pointer);
+  __real__ZdaPvm(pointer, size);
+}
+
+bool allocation_counter_is_enabled()
+{
+  return true;
+}
+
+#else
+
+bool allocation_counter_is_enabled()
+{
+  return false;
+}
+
+#endif
+
+void allocation_counter_begin()
+{
+  memset(&counts, 0, sizeof(counts));
+  tracked_count = 0;
+  counting = true;
+}
+
+void allocation_counter_end()
+{
+  counting = false;
+}
+
+const allocation_counter_counts_t* allocation_counter_counts()
+{
+  return &counts;
+}
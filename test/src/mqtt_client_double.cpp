@@ -45,21 +45,91 @@ static i_tiny_event_t* on_mqtt_disconnect(i_mqtt_client_t* _self)
   return &self->on_mqtt_disconnect.interface;
 }
 
+static i_mqtt_client_t* for_host(i_mqtt_client_t* _self, uint8_t host)
+{
+  auto self = reinterpret_cast<mqtt_client_double_t*>(_self);
+  return mqtt_client_double_host(self, host);
+}
+
 static const i_mqtt_client_api_t api = {
   register_erd,
   update_erd,
   update_erd_write_result,
   on_write_request,
-  on_mqtt_disconnect
+  on_mqtt_disconnect,
+  for_host
+};
+
+static i_tiny_event_t* host_on_write_request(i_mqtt_client_t* _self)
+{
+  auto self = reinterpret_cast<mqtt_client_double_host_t*>(_self);
+  return &self->on_write_request.interface;
+}
+
+static i_tiny_event_t* host_on_mqtt_disconnect(i_mqtt_client_t* _self)
+{
+  auto self = reinterpret_cast<mqtt_client_double_host_t*>(_self);
+  return on_mqtt_disconnect(reinterpret_cast<i_mqtt_client_t*>(self->parent));
+}
+
+static i_mqtt_client_t* host_for_host(i_mqtt_client_t* _self, uint8_t host)
+{
+  auto self = reinterpret_cast<mqtt_client_double_host_t*>(_self);
+  return for_host(reinterpret_cast<i_mqtt_client_t*>(self->parent), host);
+}
+
+static const i_mqtt_client_api_t host_api = {
+  register_erd,
+  update_erd,
+  update_erd_write_result,
+  host_on_write_request,
+  host_on_mqtt_disconnect,
+  host_for_host
 };
 
 void mqtt_client_double_init(mqtt_client_double_t* self)
 {
   self->interface.api = &api;
+  self->host_count = 0;
   tiny_event_init(&self->on_write_request);
   tiny_event_init(&self->on_mqtt_disconnect);
 }
 
+i_mqtt_client_t* mqtt_client_double_host(
+  mqtt_client_double_t* self,
+  uint8_t address)
+{
+  for(uint8_t i = 0; i < self->host_count; i++) {
+    if(self->hosts[i].address == address) {
+      return &self->hosts[i].interface;
+    }
+  }
+
+  if(self->host_count >= mqtt_client_double_max_hosts) {
+    return nullptr;
+  }
+
+  mqtt_client_double_host_t* host = &self->hosts[self->host_count++];
+  host->interface.api = &host_api;
+  host->parent = self;
+  host->address = address;
+  tiny_event_init(&host->on_write_request);
+
+  return &host->interface;
+}
+
+void mqtt_client_double_trigger_host_write_request(
+  mqtt_client_double_t* self,
+  uint8_t address,
+  tiny_erd_t erd,
+  uint8_t size,
+  const void* value)
+{
+  auto host = reinterpret_cast<mqtt_client_double_host_t*>(mqtt_client_double_host(self, address));
+  mqtt_client_on_write_request_args_t args = { erd, size, value };
+  tiny_event_publish(&host->on_write_request, &args);
+}
+
 void mqtt_client_double_trigger_write_request(
   mqtt_client_double_t* self,
   tiny_erd_t erd,
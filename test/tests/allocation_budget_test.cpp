@@ -0,0 +1,254 @@
+/*!
+ * @file
+ * @brief Heap allocation budgets for the bridges once they reach steady state
+ *
+ * Each test drives a bridge through thousands of polling cycles or subscription
+ * publications with the mocks disabled, so only the bridge itself can allocate.
+ */
+
+extern "C" {
+#include "mqtt_bridge.h"
+#include "mqtt_bridge_polling.h"
+}
+
+#include "allocation_counter.hpp"
+#include "erd_lists.h"
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/mqtt_client_double.hpp"
+#include "double/tiny_gea3_erd_client_double.hpp"
+#include "double/tiny_timer_group_double.hpp"
+#include "fixed_read_timeout.hpp"
+
+TEST_GROUP(allocation_budget_polling)
+{
+  enum {
+    appliance_address = 0xC0,
+    appliance_type = 0x00, // Water heater
+    polling_interval = 1000,
+    cycles = 2000,
+
+    // Reads in one discovery: the appliance type, then each list the bridge walks
+    max_reads = 1 + probedCommonErdCount + energyErdCount + waterHeaterErdCount,
+
+    ERD_APPLIANCE_TYPE = 0x0008
+  };
+
+  mqtt_bridge_polling_t self;
+
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  mqtt_client_double_t mqtt_client;
+
+  uint32_t cycle;
+
+  void setup()
+  {
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    mqtt_client_double_init(&mqtt_client);
+    cycle = 0;
+
+    mock().disable();
+  }
+
+  void teardown()
+  {
+    allocation_counter_end();
+    mqtt_bridge_polling_destroy(&self);
+    mock().enable();
+  }
+
+  void when_the_bridge_is_initialized(bool only_publish_on_change, erd_value_cache_mode_t change_detection)
+  {
+    mqtt_bridge_polling_init(
+      &self,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      polling_interval,
+      only_publish_on_change,
+      change_detection,
+      &fixed_read_timeout_configuration);
+  }
+
+  // Each answer lets the bridge send its next read straight away, so this runs
+  // until the bridge stops to wait for a timer
+  void the_appliance_answers_every_read()
+  {
+    for(uint16_t reads = 0; self.current_read && (reads < max_reads); reads++) {
+      tiny_erd_t erd = self.current_read->erd;
+
+      // One ERD in eight changes every cycle
+      uint8_t value[4] = { static_cast<uint8_t>(erd), 0, 0, 0 };
+      if(erd % 8 == cycle % 8) {
+        value[1] = static_cast<uint8_t>(cycle);
+      }
+      uint8_t type = appliance_type;
+
+      tiny_gea3_erd_client_on_activity_args_t args;
+      args.type = tiny_gea3_erd_client_activity_type_read_completed;
+      args.address = appliance_address;
+      args.read_completed.request_id = self.current_read->request_id;
+      args.read_completed.erd = erd;
+      args.read_completed.data = (erd == ERD_APPLIANCE_TYPE) ? &type : static_cast<const void*>(value);
+      args.read_completed.data_size = (erd == ERD_APPLIANCE_TYPE) ? sizeof(type) : sizeof(value);
+      tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+    }
+  }
+
+  void given_that_discovery_has_finished(bool only_publish_on_change, erd_value_cache_mode_t change_detection)
+  {
+    when_the_bridge_is_initialized(only_publish_on_change, change_detection);
+    the_appliance_answers_every_read();
+  }
+
+  void after_polling_cycles(uint32_t count)
+  {
+    for(uint32_t i = 0; i < count; i++, cycle++) {
+      tiny_timer_group_double_elapse_time(&timer_group, polling_interval);
+      the_appliance_answers_every_read();
+    }
+  }
+};
+
+TEST(allocation_budget_polling, should_not_allocate_at_all_without_change_detection)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  allocation_counter_begin();
+  given_that_discovery_has_finished(false, erd_value_cache_mode_full_copy);
+  after_polling_cycles(cycles);
+  allocation_counter_end();
+
+  CHECK_NO_ALLOCATIONS();
+}
+
+TEST(allocation_budget_polling, should_only_allocate_the_value_cache_during_discovery)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  allocation_counter_begin();
+  given_that_discovery_has_finished(true, erd_value_cache_mode_full_copy);
+  allocation_counter_end();
+
+  // The index and arena grow by doubling, then are copied into the sealed block
+  CHECK_ALLOCATIONS_AT_MOST(16);
+  CHECK_PEAK_HEAP_AT_MOST(6144);
+
+  // Only the sealed block is still held once polling starts
+  CHECK_EQUAL(
+    self.erd_cache.entry_capacity * sizeof(erd_value_cache_entry_t) + self.erd_cache.arena_capacity,
+    allocation_counter_counts()->live_bytes);
+}
+
+TEST(allocation_budget_polling, should_not_allocate_while_polling_with_full_copy_change_detection)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  given_that_discovery_has_finished(true, erd_value_cache_mode_full_copy);
+
+  allocation_counter_begin();
+  after_polling_cycles(cycles);
+  allocation_counter_end();
+
+  CHECK_NO_ALLOCATIONS();
+}
+
+TEST(allocation_budget_polling, should_not_allocate_while_polling_with_digest_change_detection)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  given_that_discovery_has_finished(true, erd_value_cache_mode_digest);
+
+  allocation_counter_begin();
+  after_polling_cycles(cycles);
+  allocation_counter_end();
+
+  CHECK_NO_ALLOCATIONS();
+}
+
+TEST_GROUP(allocation_budget_subscription)
+{
+  enum {
+    appliance_address = 0xC0,
+    subscription_retention_period = 30 * 1000,
+    publications = 5000,
+    publication_period = 50
+  };
+
+  mqtt_bridge_t self;
+
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  mqtt_client_double_t mqtt_client;
+
+  void setup()
+  {
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    mqtt_client_double_init(&mqtt_client);
+
+    mock().disable();
+  }
+
+  void teardown()
+  {
+    allocation_counter_end();
+    mqtt_bridge_destroy(&self);
+    mock().enable();
+  }
+
+  void when_the_bridge_is_initialized()
+  {
+    mqtt_bridge_init(
+      &self,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      appliance_address);
+  }
+
+  void after_a_subscription_is_added_or_retained()
+  {
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_subscription_added_or_retained;
+    args.address = appliance_address;
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  // Publications walk the water heater's ERDs over and over, one every publication_period
+  void after_publications(uint32_t count)
+  {
+    for(uint32_t i = 0; i < count; i++) {
+      uint32_t value = i;
+
+      tiny_gea3_erd_client_on_activity_args_t args;
+      args.type = tiny_gea3_erd_client_activity_type_subscription_publication_received;
+      args.address = appliance_address;
+      args.subscription_publication_received.erd = erdListAt(&waterHeaterErds, i % waterHeaterErdCount);
+      args.subscription_publication_received.data = &value;
+      args.subscription_publication_received.data_size = sizeof(value);
+      tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+
+      tiny_timer_group_double_elapse_time(&timer_group, publication_period);
+      if((i * publication_period) % subscription_retention_period == 0) {
+        after_a_subscription_is_added_or_retained();
+      }
+    }
+  }
+};
+
+TEST(allocation_budget_subscription, should_not_allocate_from_init_through_thousands_of_publications)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  allocation_counter_begin();
+  when_the_bridge_is_initialized();
+  after_a_subscription_is_added_or_retained();
+  after_publications(publications);
+  allocation_counter_end();
+
+  CHECK_NO_ALLOCATIONS();
+}
@@ -0,0 +1,543 @@
+/*!
+ * @file
+ * @brief Tests for finding the host and reading its identity
+ */
+
+extern "C" {
+#include "autodiscovery.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_timer_group_double.hpp"
+
+enum {
+  max_reads = 32
+};
+
+typedef struct {
+  autodiscovery_protocol_t protocol;
+  uint8_t address;
+  tiny_erd_t erd;
+} read_t;
+
+// Stands in for the buses and the component
+typedef struct {
+  bool settled;
+  uint8_t settle_samples;
+
+  bool accept_gea3_reads;
+  bool accept_gea2_reads;
+  read_t reads[max_reads];
+  uint8_t read_count;
+
+  uint8_t boards_discovered;
+  uint8_t last_discovered_address;
+
+  uint8_t identity_erds_read;
+  uint8_t model_number[32];
+
+  autodiscovery_progress_t progress[max_reads];
+  uint8_t progress_count;
+} fake_platform_t;
+
+static const autodiscovery_callbacks_t callbacks = {
+  +[](void* context) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    platform->settle_samples++;
+    return platform->settled;
+  },
+  +[](void* context, autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    bool accept = (protocol == autodiscovery_protocol_gea3) ? platform->accept_gea3_reads : platform->accept_gea2_reads;
+    if(accept && (platform->read_count < max_reads)) {
+      platform->reads[platform->read_count++] = { protocol, address, erd };
+    }
+    return accept;
+  },
+  +[](void* context, autodiscovery_protocol_t, uint8_t address, uint8_t) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    platform->boards_discovered++;
+    platform->last_discovered_address = address;
+  },
+  +[](void* context, tiny_erd_t erd, const void* data, uint8_t data_size) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    platform->identity_erds_read++;
+    if(erd == 0x0001) {
+      memcpy(platform->model_number, data, data_size);
+    }
+  },
+  +[](void* context, autodiscovery_progress_t progress) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    if(platform->progress_count < max_reads) {
+      platform->progress[platform->progress_count++] = progress;
+    }
+  }
+};
+
+TEST_GROUP(autodiscovery)
+{
+  enum {
+    erd_model_number = 0x0001,
+    erd_serial_number = 0x0002,
+    erd_appliance_type = 0x0008,
+    broadcast_address = 0xFF,
+    gea3_preferred_address = 0xC0,
+    gea2_preferred_address = 0xA0,
+    gea3_address = 0xC1,
+    other_gea3_address = 0xC2,
+    gea2_address = 0xA1,
+    appliance_type = 6,
+    round_trip = 20
+  };
+
+  autodiscovery_t self;
+  tiny_timer_group_double_t timer_group;
+  fake_platform_t platform;
+  autodiscovery_configuration_t configuration;
+
+  const uint8_t model_number[32] = { 'Z', 'L', '4', '2', '0', '0', 'A', 'B', 'C' };
+  const uint8_t serial_number[32] = { 'S', 'N', '1', '2', '3', '4', '5', '6', '7', '8' };
+
+  void setup()
+  {
+    memset(&platform, 0, sizeof(platform));
+    platform.accept_gea3_reads = true;
+    platform.accept_gea2_reads = true;
+
+    configuration.gea3 = true;
+    configuration.gea2 = false;
+    configuration.gea3_preferred_address = gea3_preferred_address;
+    configuration.gea2_preferred_address = gea2_preferred_address;
+
+    tiny_timer_group_double_init(&timer_group);
+  }
+
+  void given_initialized()
+  {
+    autodiscovery_init(&self, &timer_group.timer_group, &configuration, &callbacks, &platform);
+  }
+
+  void given_both_buses_are_in_use()
+  {
+    configuration.gea2 = true;
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  void given_the_broadcasts_were_sent(bool read_identity = false)
+  {
+    given_initialized();
+    platform.settled = true;
+    autodiscovery_start(&self, read_identity);
+    after(autodiscovery_bus_settle_sample_period);
+    platform.read_count = 0;
+    platform.progress_count = 0;
+  }
+
+  void given_the_identity_is_being_read()
+  {
+    given_the_broadcasts_were_sent(true);
+    a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address);
+    after(0);
+    platform.read_count = 0;
+    platform.progress_count = 0;
+  }
+
+  bool a_board_answers(autodiscovery_protocol_t protocol, uint8_t address)
+  {
+    uint8_t type = appliance_type;
+    return autodiscovery_read_finished(&self, protocol, address, erd_appliance_type, true, &type, sizeof(type));
+  }
+
+  void the_host_answers(tiny_erd_t erd, const uint8_t* data, uint8_t data_size)
+  {
+    autodiscovery_read_finished(&self, autodiscovery_protocol_gea3, gea3_preferred_address, erd, true, data, data_size);
+  }
+
+  void the_host_does_not_answer(tiny_erd_t erd)
+  {
+    autodiscovery_read_finished(&self, autodiscovery_protocol_gea3, gea3_preferred_address, erd, false, nullptr, 0);
+  }
+
+  void the_host_answers_every_identity_read()
+  {
+    uint8_t type = appliance_type;
+    the_host_answers(erd_appliance_type, &type, sizeof(type));
+    the_host_answers(erd_model_number, model_number, sizeof(model_number));
+    the_host_answers(erd_serial_number, serial_number, sizeof(serial_number));
+  }
+
+  void the_last_read_should_be(autodiscovery_protocol_t protocol, uint8_t address, tiny_erd_t erd)
+  {
+    CHECK_TRUE(platform.read_count > 0);
+    const read_t& read = platform.reads[platform.read_count - 1];
+    CHECK_EQUAL(protocol, read.protocol);
+    CHECK_EQUAL(address, read.address);
+    CHECK_EQUAL(erd, read.erd);
+  }
+
+  void the_last_progress_should_be(autodiscovery_progress_t progress)
+  {
+    CHECK_TRUE(platform.progress_count > 0);
+    CHECK_EQUAL(progress, platform.progress[platform.progress_count - 1]);
+  }
+
+  void the_host_should_be(autodiscovery_protocol_t protocol, uint8_t address)
+  {
+    CHECK_TRUE(autodiscovery_host_selected(&self));
+    CHECK_EQUAL(protocol, autodiscovery_host_protocol(&self));
+    CHECK_EQUAL(address, autodiscovery_host_address(&self));
+  }
+};
+
+TEST(autodiscovery, should_not_broadcast_before_the_buses_settle)
+{
+  given_initialized();
+  autodiscovery_start(&self, false);
+
+  after(autodiscovery_bus_settle_sample_period * 4);
+  CHECK_EQUAL(4, platform.settle_samples);
+  CHECK_EQUAL(0, platform.read_count);
+}
+
+TEST(autodiscovery, should_broadcast_on_each_bus_in_use_once_they_settle)
+{
+  given_both_buses_are_in_use();
+  given_initialized();
+  autodiscovery_start(&self, false);
+
+  after(autodiscovery_bus_settle_sample_period);
+  CHECK_EQUAL(0, platform.read_count);
+
+  platform.settled = true;
+  after(autodiscovery_bus_settle_sample_period);
+  CHECK_EQUAL(2, platform.read_count);
+  CHECK_EQUAL(autodiscovery_protocol_gea3, platform.reads[0].protocol);
+  CHECK_EQUAL(autodiscovery_protocol_gea2, platform.reads[1].protocol);
+  the_last_read_should_be(autodiscovery_protocol_gea2, broadcast_address, erd_appliance_type);
+  the_last_progress_should_be(autodiscovery_progress_buses_settled);
+}
+
+TEST(autodiscovery, should_broadcast_after_the_startup_delay_when_the_buses_never_settle)
+{
+  given_initialized();
+  autodiscovery_start(&self, false);
+
+  after(autodiscovery_startup_delay - 1);
+  CHECK_EQUAL(0, platform.read_count);
+
+  after(1);
+  the_last_read_should_be(autodiscovery_protocol_gea3, broadcast_address, erd_appliance_type);
+  the_last_progress_should_be(autodiscovery_progress_startup_delay_expired);
+}
+
+TEST(autodiscovery, should_retry_a_broadcast_the_client_refused)
+{
+  platform.accept_gea3_reads = false;
+  given_the_broadcasts_were_sent();
+
+  platform.accept_gea3_reads = true;
+  after(autodiscovery_broadcast_retry_delay - 1);
+  CHECK_EQUAL(0, platform.read_count);
+
+  after(1);
+  the_last_read_should_be(autodiscovery_protocol_gea3, broadcast_address, erd_appliance_type);
+}
+
+TEST(autodiscovery, should_send_a_refused_gea3_broadcast_once_the_client_is_ready)
+{
+  platform.accept_gea3_reads = false;
+  given_the_broadcasts_were_sent();
+
+  platform.accept_gea3_reads = true;
+  autodiscovery_notify_ready(&self);
+  CHECK_EQUAL(1, platform.read_count);
+
+  after(autodiscovery_broadcast_retry_delay);
+  CHECK_EQUAL(1, platform.read_count);
+}
+
+TEST(autodiscovery, should_select_the_preferred_board_as_soon_as_it_answers)
+{
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  CHECK_TRUE(a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address));
+  after(0);
+
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_preferred_address);
+  the_last_progress_should_be(autodiscovery_progress_host_selected);
+}
+
+TEST(autodiscovery, should_select_another_board_once_the_bus_has_been_quiet_for_the_quiet_period)
+{
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_address);
+
+  after(autodiscovery_min_quiet_period - 1);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+
+  after(1);
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_address);
+}
+
+TEST(autodiscovery, should_scale_the_quiet_period_with_the_first_response_latency)
+{
+  enum {
+    latency = 200
+  };
+
+  given_the_broadcasts_were_sent();
+
+  after(latency);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_address);
+
+  after(latency * autodiscovery_quiet_period_factor - 1);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+
+  after(1);
+  CHECK_TRUE(autodiscovery_host_selected(&self));
+}
+
+TEST(autodiscovery, should_restart_the_quiet_period_when_another_board_answers)
+{
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_address);
+  after(autodiscovery_min_quiet_period - 1);
+  a_board_answers(autodiscovery_protocol_gea3, other_gea3_address);
+
+  after(autodiscovery_min_quiet_period - 1);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+
+  after(1);
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_address);
+  CHECK_EQUAL(2, autodiscovery_gea3_board_count(&self));
+}
+
+TEST(autodiscovery, should_never_keep_the_window_open_longer_than_its_upper_bound)
+{
+  given_the_broadcasts_were_sent();
+
+  after(autodiscovery_broadcast_window - 100);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_address);
+
+  after(99);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+
+  after(1);
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_address);
+}
+
+TEST(autodiscovery, should_broadcast_again_when_no_board_answers)
+{
+  given_the_broadcasts_were_sent();
+
+  after(autodiscovery_broadcast_window - 1);
+  CHECK_EQUAL(0, platform.read_count);
+
+  after(1);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+  CHECK_EQUAL(autodiscovery_progress_no_boards_found, platform.progress[0]);
+  the_last_read_should_be(autodiscovery_protocol_gea3, broadcast_address, erd_appliance_type);
+}
+
+TEST(autodiscovery, should_prefer_gea3_when_both_buses_answer)
+{
+  given_both_buses_are_in_use();
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea2, gea2_address);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_address);
+  after(autodiscovery_min_quiet_period);
+
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_address);
+}
+
+TEST(autodiscovery, should_wait_for_gea3_when_the_preferred_gea2_board_answers_first)
+{
+  given_both_buses_are_in_use();
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea2, gea2_preferred_address);
+  after(0);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+
+  after(autodiscovery_min_quiet_period);
+  the_host_should_be(autodiscovery_protocol_gea2, gea2_preferred_address);
+}
+
+TEST(autodiscovery, should_select_the_preferred_gea2_board_as_soon_as_it_answers_when_gea3_is_not_in_use)
+{
+  configuration.gea3 = false;
+  configuration.gea2 = true;
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea2, gea2_preferred_address);
+  after(0);
+
+  the_host_should_be(autodiscovery_protocol_gea2, gea2_preferred_address);
+}
+
+TEST(autodiscovery, should_report_gea3_boards_that_answer_after_the_preferred_board)
+{
+  given_the_broadcasts_were_sent();
+
+  after(round_trip);
+  a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address);
+  after(0);
+
+  CHECK_TRUE(a_board_answers(autodiscovery_protocol_gea3, gea3_address));
+  CHECK_TRUE(a_board_answers(autodiscovery_protocol_gea3, gea3_address));
+  CHECK_EQUAL(2, platform.boards_discovered);
+  CHECK_EQUAL(gea3_address, platform.last_discovered_address);
+  CHECK_EQUAL(2, autodiscovery_gea3_board_count(&self));
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_preferred_address);
+}
+
+TEST(autodiscovery, should_queue_every_identity_read_at_once_once_the_host_is_selected)
+{
+  given_the_broadcasts_were_sent(true);
+
+  a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address);
+  after(0);
+
+  CHECK_EQUAL(3, platform.read_count);
+  CHECK_EQUAL(erd_appliance_type, platform.reads[0].erd);
+  CHECK_EQUAL(erd_model_number, platform.reads[1].erd);
+  the_last_read_should_be(autodiscovery_protocol_gea3, gea3_preferred_address, erd_serial_number);
+}
+
+TEST(autodiscovery, should_not_read_the_identity_unless_asked_to)
+{
+  given_the_broadcasts_were_sent(false);
+
+  a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address);
+  after(0);
+
+  CHECK_EQUAL(0, platform.read_count);
+}
+
+TEST(autodiscovery, should_report_the_identity_once_every_read_has_been_answered)
+{
+  given_the_identity_is_being_read();
+
+  uint8_t type = appliance_type;
+  the_host_answers(erd_appliance_type, &type, sizeof(type));
+  the_host_answers(erd_model_number, model_number, sizeof(model_number));
+  CHECK_EQUAL(0, platform.progress_count);
+
+  the_host_answers(erd_serial_number, serial_number, sizeof(serial_number));
+  CHECK_EQUAL(3, platform.identity_erds_read);
+  MEMCMP_EQUAL(model_number, platform.model_number, sizeof(model_number));
+  the_last_progress_should_be(autodiscovery_progress_identity_read);
+}
+
+TEST(autodiscovery, should_ignore_reads_from_other_boards_while_reading_the_identity)
+{
+  given_the_identity_is_being_read();
+
+  CHECK_FALSE(autodiscovery_read_finished(&self, autodiscovery_protocol_gea3, gea3_address, erd_model_number, true, model_number, sizeof(model_number)));
+  CHECK_EQUAL(0, platform.identity_erds_read);
+}
+
+TEST(autodiscovery, should_retry_only_the_failed_identity_reads_with_a_doubling_delay)
+{
+  given_the_identity_is_being_read();
+
+  uint8_t type = appliance_type;
+  the_host_answers(erd_appliance_type, &type, sizeof(type));
+  the_host_does_not_answer(erd_model_number);
+  the_host_does_not_answer(erd_serial_number);
+  the_last_progress_should_be(autodiscovery_progress_identity_read_retrying);
+
+  after(autodiscovery_identity_retry_base_delay - 1);
+  CHECK_EQUAL(0, platform.read_count);
+  after(1);
+  CHECK_EQUAL(2, platform.read_count);
+  CHECK_EQUAL(erd_model_number, platform.reads[0].erd);
+  CHECK_EQUAL(erd_serial_number, platform.reads[1].erd);
+
+  the_host_does_not_answer(erd_model_number);
+  after(autodiscovery_identity_retry_base_delay * 2 - 1);
+  CHECK_EQUAL(2, platform.read_count);
+  after(1);
+  the_last_read_should_be(autodiscovery_protocol_gea3, gea3_preferred_address, erd_model_number);
+}
+
+TEST(autodiscovery, should_queue_refused_gea3_identity_reads_once_the_client_is_ready)
+{
+  platform.accept_gea3_reads = true;
+  given_the_broadcasts_were_sent(true);
+
+  platform.accept_gea3_reads = false;
+  a_board_answers(autodiscovery_protocol_gea3, gea3_preferred_address);
+  after(autodiscovery_identity_retry_max_delay);
+  CHECK_EQUAL(0, platform.read_count);
+
+  platform.accept_gea3_reads = true;
+  autodiscovery_notify_ready(&self);
+  CHECK_EQUAL(3, platform.read_count);
+}
+
+TEST(autodiscovery, should_retry_refused_gea2_identity_reads_after_a_delay)
+{
+  configuration.gea3 = false;
+  configuration.gea2 = true;
+  given_the_broadcasts_were_sent(true);
+
+  platform.accept_gea2_reads = false;
+  a_board_answers(autodiscovery_protocol_gea2, gea2_preferred_address);
+  after(0);
+  CHECK_EQUAL(0, platform.read_count);
+
+  platform.accept_gea2_reads = true;
+  after(autodiscovery_identity_retry_base_delay);
+  CHECK_EQUAL(3, platform.read_count);
+  the_last_read_should_be(autodiscovery_protocol_gea2, gea2_preferred_address, erd_serial_number);
+}
+
+TEST(autodiscovery, should_start_over_from_the_broadcasts_once_the_identity_retries_run_out)
+{
+  given_the_identity_is_being_read();
+
+  for(uint8_t i = 0; i < autodiscovery_identity_max_retries; i++) {
+    the_host_does_not_answer(erd_appliance_type);
+    after(autodiscovery_identity_retry_max_delay);
+  }
+  the_host_does_not_answer(erd_appliance_type);
+  the_last_progress_should_be(autodiscovery_progress_identity_read_failed);
+  CHECK_TRUE(autodiscovery_host_selected(&self));
+
+  platform.read_count = 0;
+  after(autodiscovery_identity_recovery_delay - 1);
+  CHECK_EQUAL(0, platform.read_count);
+
+  after(1);
+  CHECK_FALSE(autodiscovery_host_selected(&self));
+  the_last_read_should_be(autodiscovery_protocol_gea3, broadcast_address, erd_appliance_type);
+}
+
+TEST(autodiscovery, should_restore_the_host_and_secondary_boards_without_reading_the_bus)
+{
+  const uint8_t secondary_addresses[] = { gea3_address, other_gea3_address };
+  given_initialized();
+
+  autodiscovery_restore(&self, autodiscovery_protocol_gea3, gea3_preferred_address, secondary_addresses, sizeof(secondary_addresses));
+
+  the_host_should_be(autodiscovery_protocol_gea3, gea3_preferred_address);
+  CHECK_EQUAL(3, autodiscovery_gea3_board_count(&self));
+  CHECK_EQUAL(other_gea3_address, autodiscovery_gea3_board(&self, 2));
+  CHECK_EQUAL(0, platform.read_count);
+}
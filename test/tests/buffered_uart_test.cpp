@@ -0,0 +1,227 @@
+/*!
+ * @file
+ * @brief Tests for the event-driven buffered UART
+ */
+
+extern "C" {
+#include "buffered_uart.h"
+#include "tiny_gea_constants.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_timer_group_double.hpp"
+
+enum {
+  max_bytes = 64
+};
+
+typedef struct {
+  uint8_t rx[max_bytes];
+  uint16_t rx_available;
+  uint16_t rx_offset;
+  uint16_t read_calls;
+
+  uint8_t tx[max_bytes];
+  uint16_t tx_count;
+  uint16_t tx_room;
+} fake_uart_t;
+
+typedef struct {
+  uint8_t bytes[max_bytes];
+  uint16_t count;
+} received_t;
+
+static uint16_t fake_uart_read(void* context, uint8_t* buffer, uint16_t size)
+{
+  auto uart = static_cast<fake_uart_t*>(context);
+  uint16_t count = (uart->rx_available < size) ? uart->rx_available : size;
+
+  memcpy(buffer, &uart->rx[uart->rx_offset], count);
+  uart->rx_offset += count;
+  uart->rx_available -= count;
+  uart->read_calls++;
+
+  return count;
+}
+
+static uint16_t fake_uart_write(void* context, const uint8_t* data, uint16_t size)
+{
+  auto uart = static_cast<fake_uart_t*>(context);
+  uint16_t count = (size < uart->tx_room) ? size : uart->tx_room;
+  memcpy(&uart->tx[uart->tx_count], data, count);
+  uart->tx_count += count;
+  return count;
+}
+
+static void byte_received(void* context, const void* _args)
+{
+  auto received = static_cast<received_t*>(context);
+  auto args = static_cast<const tiny_uart_on_receive_args_t*>(_args);
+  received->bytes[received->count++] = args->byte;
+}
+
+TEST_GROUP(buffered_uart)
+{
+  buffered_uart_t self;
+  tiny_timer_group_double_t timer_group;
+  fake_uart_t uart;
+  received_t received;
+  tiny_event_subscription_t receive_subscription;
+
+  void setup()
+  {
+    memset(&uart, 0, sizeof(uart));
+    uart.tx_room = max_bytes;
+    memset(&received, 0, sizeof(received));
+
+    tiny_timer_group_double_init(&timer_group);
+    buffered_uart_init(&self, &timer_group.timer_group, fake_uart_read, fake_uart_write, &uart, true);
+
+    tiny_event_subscription_init(&receive_subscription, &received, byte_received);
+    tiny_event_subscribe(tiny_uart_on_receive(&self.interface), &receive_subscription);
+  }
+
+  void the_uart_receives(const uint8_t* data, uint16_t size)
+  {
+    memcpy(&uart.rx[uart.rx_offset + uart.rx_available], data, size);
+    uart.rx_available += size;
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  void a_frame_is_sent_from(uint8_t source)
+  {
+    const uint8_t frame[] = { tiny_gea_stx, 0xC0, 0x08, source, 0x01, 0x12, 0x34, tiny_gea_etx };
+    for(uint8_t byte : frame) {
+      tiny_uart_send(&self.interface, byte);
+    }
+    after(0);
+  }
+
+  void a_frame_is_received_from(uint8_t source)
+  {
+    const uint8_t frame[] = { tiny_gea_stx, 0xE4, 0x08, source, 0x01, 0x56, 0x78, tiny_gea_etx };
+    the_uart_receives(frame, sizeof(frame));
+    buffered_uart_notify_rx_ready(&self);
+    after(0);
+  }
+};
+
+TEST(buffered_uart, should_not_read_the_uart_until_rx_ready_is_notified)
+{
+  const uint8_t data[] = { 1, 2, 3 };
+  the_uart_receives(data, sizeof(data));
+
+  after(100);
+
+  CHECK_EQUAL(0, uart.read_calls);
+  CHECK_EQUAL(0, received.count);
+}
+
+TEST(buffered_uart, should_publish_received_bytes_once_rx_ready_is_notified)
+{
+  const uint8_t data[] = { 1, 2, 3 };
+  the_uart_receives(data, sizeof(data));
+
+  buffered_uart_notify_rx_ready(&self);
+  after(0);
+
+  CHECK_EQUAL(sizeof(data), received.count);
+  MEMCMP_EQUAL(data, received.bytes, sizeof(data));
+}
+
+TEST(buffered_uart, should_write_sent_bytes_when_processing_runs)
+{
+  tiny_uart_send(&self.interface, 0x42);
+  CHECK_EQUAL(0, uart.tx_count);
+
+  after(0);
+
+  CHECK_EQUAL(1, uart.tx_count);
+  CHECK_EQUAL(0x42, uart.tx[0]);
+}
+
+TEST(buffered_uart, should_keep_writing_until_the_uart_has_taken_every_byte)
+{
+  const uint8_t data[] = { 1, 2, 3, 4, 5 };
+  uart.tx_room = 2;
+
+  for(uint8_t byte : data) {
+    tiny_uart_send(&self.interface, byte);
+  }
+  after(0);
+  after(0);
+  after(0);
+
+  CHECK_EQUAL(sizeof(data), uart.tx_count);
+  MEMCMP_EQUAL(data, uart.tx, sizeof(data));
+}
+
+TEST(buffered_uart, should_count_frames_but_not_escaped_etx_bytes)
+{
+  const uint8_t data[] = { tiny_gea_stx, 0x10, tiny_gea_esc, tiny_gea_etx, 0x20, tiny_gea_etx };
+  the_uart_receives(data, sizeof(data));
+
+  buffered_uart_notify_rx_ready(&self);
+  after(0);
+
+  CHECK_EQUAL(sizeof(data), self.received_byte_count);
+  CHECK_EQUAL(1, self.received_frame_count);
+}
+
+TEST(buffered_uart, should_have_a_transaction_in_flight_until_the_response_window_ends)
+{
+  CHECK_FALSE(buffered_uart_transaction_in_flight(&self));
+
+  a_frame_is_sent_from(0xE4);
+  after(buffered_uart_response_window - 1);
+  CHECK_TRUE(buffered_uart_transaction_in_flight(&self));
+
+  after(1);
+  CHECK_FALSE(buffered_uart_transaction_in_flight(&self));
+}
+
+TEST(buffered_uart, should_have_a_transaction_in_flight_while_a_frame_is_being_sent)
+{
+  tiny_uart_send(&self.interface, tiny_gea_stx);
+  after(buffered_uart_response_window);
+  CHECK_TRUE(buffered_uart_transaction_in_flight(&self));
+}
+
+TEST(buffered_uart, should_end_the_transaction_when_the_response_arrives)
+{
+  a_frame_is_sent_from(0xE4);
+  a_frame_is_received_from(0xC0);
+  CHECK_FALSE(buffered_uart_transaction_in_flight(&self));
+}
+
+TEST(buffered_uart, should_not_end_the_transaction_on_the_reflection_of_the_request)
+{
+  a_frame_is_sent_from(0xE4);
+  a_frame_is_received_from(0xE4);
+  CHECK_TRUE(buffered_uart_transaction_in_flight(&self));
+
+  a_frame_is_received_from(0xC0);
+  CHECK_FALSE(buffered_uart_transaction_in_flight(&self));
+}
+
+TEST(buffered_uart, should_have_a_transaction_in_flight_while_a_frame_is_being_received)
+{
+  const uint8_t start[] = { tiny_gea_stx, 0x10 };
+  const uint8_t end[] = { 0x20, tiny_gea_etx };
+
+  the_uart_receives(start, sizeof(start));
+  buffered_uart_notify_rx_ready(&self);
+  after(0);
+  CHECK_TRUE(buffered_uart_transaction_in_flight(&self));
+
+  the_uart_receives(end, sizeof(end));
+  buffered_uart_notify_rx_ready(&self);
+  after(0);
+  CHECK_FALSE(buffered_uart_transaction_in_flight(&self));
+}
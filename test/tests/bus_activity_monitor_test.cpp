@@ -0,0 +1,97 @@
+/*!
+ * @file
+ * @brief Tests for the bus settle detection used to start autodiscovery
+ */
+
+extern "C" {
+#include "bus_activity_monitor.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(bus_activity_monitor)
+{
+  bus_activity_monitor_t self;
+  uint32_t bytes;
+  uint32_t frames;
+
+  void setup()
+  {
+    bytes = 0;
+    frames = 0;
+    bus_activity_monitor_init(&self);
+    bus_activity_monitor_sample(&self, bytes, frames);
+  }
+
+  void after_a_period_with(uint32_t new_bytes, uint32_t new_frames)
+  {
+    bytes += new_bytes;
+    frames += new_frames;
+    bus_activity_monitor_sample(&self, bytes, frames);
+  }
+
+  void after_periods_with(uint8_t periods, uint32_t new_bytes, uint32_t new_frames)
+  {
+    for(uint8_t i = 0; i < periods; i++) {
+      after_a_period_with(new_bytes, new_frames);
+    }
+  }
+};
+
+TEST(bus_activity_monitor, should_not_be_settled_before_enough_samples)
+{
+  after_periods_with(bus_activity_monitor_stable_samples - 1, 0, 0);
+  CHECK_FALSE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_be_settled_when_the_bus_is_quiet)
+{
+  after_periods_with(bus_activity_monitor_stable_samples, 0, 0);
+  CHECK_TRUE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_be_settled_when_traffic_is_steady)
+{
+  after_a_period_with(120, 10);
+  after_a_period_with(110, 9);
+  after_a_period_with(130, 11);
+  after_a_period_with(120, 10);
+  CHECK_TRUE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_not_be_settled_while_traffic_is_bursty)
+{
+  after_a_period_with(400, 30);
+  after_a_period_with(120, 10);
+  after_a_period_with(120, 10);
+  after_a_period_with(120, 10);
+  CHECK_FALSE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_not_be_settled_while_bytes_arrive_without_frames)
+{
+  after_periods_with(bus_activity_monitor_stable_samples - 1, 0, 0);
+  after_a_period_with(5, 0);
+  CHECK_FALSE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_settle_once_a_boot_burst_has_passed)
+{
+  after_a_period_with(800, 40);
+  after_a_period_with(300, 0);
+  CHECK_FALSE(bus_activity_monitor_is_settled(&self));
+
+  after_periods_with(bus_activity_monitor_stable_samples, 0, 0);
+  CHECK_TRUE(bus_activity_monitor_is_settled(&self));
+}
+
+TEST(bus_activity_monitor, should_handle_counters_that_wrap)
+{
+  bytes = UINT32_MAX - 50;
+  frames = UINT32_MAX - 3;
+  bus_activity_monitor_init(&self);
+  bus_activity_monitor_sample(&self, bytes, frames);
+
+  after_periods_with(bus_activity_monitor_stable_samples, 40, 4);
+  CHECK_TRUE(bus_activity_monitor_is_settled(&self));
+}
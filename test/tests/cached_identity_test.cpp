@@ -0,0 +1,237 @@
+/*!
+ * @file
+ * @brief Tests for restoring and verifying the cached identity
+ */
+
+extern "C" {
+#include "cached_identity.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_timer_group_double.hpp"
+
+// Stands in for the flash preference and the bus
+typedef struct {
+  identity_cache_record_t stored;
+  bool has_record;
+  uint8_t save_count;
+
+  bool accept_reads;
+  uint8_t read_count;
+  uint8_t read_address;
+
+  bool finished;
+  cached_identity_result_t result;
+  uint8_t serial_number[32];
+  bool record_was_saved_when_finished;
+} fake_platform_t;
+
+static const cached_identity_callbacks_t callbacks = {
+  +[](void* context, identity_cache_record_t* record) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    memcpy(record, &platform->stored, sizeof(*record));
+    return platform->has_record;
+  },
+  +[](void* context, const identity_cache_record_t* record) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    memcpy(&platform->stored, record, sizeof(*record));
+    platform->has_record = true;
+    platform->save_count++;
+    return true;
+  },
+  +[](void* context, uint8_t address) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    platform->read_count++;
+    platform->read_address = address;
+    return platform->accept_reads;
+  },
+  +[](void* context, cached_identity_result_t result, const void* serial_number, uint8_t serial_number_size) {
+    auto platform = static_cast<fake_platform_t*>(context);
+    platform->finished = true;
+    platform->result = result;
+    platform->record_was_saved_when_finished = platform->save_count > 0;
+    if(serial_number) {
+      memcpy(platform->serial_number, serial_number, serial_number_size);
+    }
+  }
+};
+
+TEST_GROUP(cached_identity)
+{
+  enum {
+    host_address = 0xC0,
+    other_address = 0xC1,
+    appliance_type = 6
+  };
+
+  cached_identity_t self;
+  tiny_timer_group_double_t timer_group;
+  fake_platform_t platform;
+
+  const uint8_t serial_number[32] = { 'S', 'N', '1', '2', '3', '4', '5', '6', '7', '8' };
+  const uint8_t other_serial_number[32] = { 'S', 'N', '8', '7', '6', '5', '4', '3', '2', '1' };
+
+  void setup()
+  {
+    memset(&platform, 0, sizeof(platform));
+    platform.accept_reads = true;
+
+    tiny_timer_group_double_init(&timer_group);
+    cached_identity_init(&self, &timer_group.timer_group, &callbacks, &platform);
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  void given_a_saved_record()
+  {
+    identity_cache_record_init(
+      &platform.stored,
+      identity_cache_protocol_gea3,
+      host_address,
+      appliance_type,
+      serial_number,
+      sizeof(serial_number),
+      "Dishwasher_ZL4200ABC_SN12345678");
+    identity_cache_record_seal(&platform.stored);
+    platform.has_record = true;
+  }
+
+  void given_the_record_is_being_verified()
+  {
+    given_a_saved_record();
+    CHECK_TRUE(cached_identity_restore(&self));
+    cached_identity_verify(&self);
+  }
+
+  bool the_host_answers(uint8_t address, const uint8_t* data)
+  {
+    return cached_identity_read_finished(&self, address, true, data, 32);
+  }
+};
+
+TEST(cached_identity, should_not_restore_without_a_saved_record)
+{
+  CHECK_FALSE(cached_identity_restore(&self));
+}
+
+TEST(cached_identity, should_not_restore_a_corrupted_record)
+{
+  given_a_saved_record();
+  platform.stored.device_id[0] ^= 1;
+
+  CHECK_FALSE(cached_identity_restore(&self));
+}
+
+TEST(cached_identity, should_restore_a_valid_record)
+{
+  given_a_saved_record();
+
+  CHECK_TRUE(cached_identity_restore(&self));
+  CHECK_EQUAL(host_address, cached_identity_record(&self)->host_address);
+  STRCMP_EQUAL("Dishwasher_ZL4200ABC_SN12345678", cached_identity_record(&self)->device_id);
+}
+
+TEST(cached_identity, should_read_the_serial_number_from_the_cached_host_to_verify_it)
+{
+  given_the_record_is_being_verified();
+
+  CHECK_EQUAL(1, platform.read_count);
+  CHECK_EQUAL(host_address, platform.read_address);
+}
+
+TEST(cached_identity, should_report_a_matching_serial_number_as_verified)
+{
+  given_the_record_is_being_verified();
+
+  CHECK_TRUE(the_host_answers(host_address, serial_number));
+  CHECK_TRUE(platform.finished);
+  CHECK_EQUAL(cached_identity_result_verified, platform.result);
+  CHECK_EQUAL(0, platform.save_count);
+}
+
+TEST(cached_identity, should_save_an_invalidated_record_before_reporting_a_mismatch)
+{
+  given_the_record_is_being_verified();
+
+  CHECK_TRUE(the_host_answers(host_address, other_serial_number));
+  CHECK_EQUAL(cached_identity_result_mismatched, platform.result);
+  CHECK_TRUE(platform.record_was_saved_when_finished);
+
+  // The next boot runs full autodiscovery
+  cached_identity_init(&self, &timer_group.timer_group, &callbacks, &platform);
+  CHECK_FALSE(cached_identity_restore(&self));
+}
+
+TEST(cached_identity, should_retry_a_read_that_could_not_be_queued_after_a_delay)
+{
+  given_a_saved_record();
+  CHECK_TRUE(cached_identity_restore(&self));
+
+  platform.accept_reads = false;
+  cached_identity_verify(&self);
+  CHECK_EQUAL(1, platform.read_count);
+
+  platform.accept_reads = true;
+  after(cached_identity_retry_delay - 1);
+  CHECK_EQUAL(1, platform.read_count);
+
+  after(1);
+  CHECK_EQUAL(2, platform.read_count);
+}
+
+TEST(cached_identity, should_keep_the_record_and_retry_after_a_failed_read)
+{
+  given_the_record_is_being_verified();
+
+  CHECK_TRUE(cached_identity_read_finished(&self, host_address, false, nullptr, 0));
+  CHECK_FALSE(platform.finished);
+
+  after(cached_identity_retry_delay - 1);
+  CHECK_EQUAL(1, platform.read_count);
+
+  after(1);
+  CHECK_EQUAL(2, platform.read_count);
+  CHECK_EQUAL(0, platform.save_count);
+}
+
+TEST(cached_identity, should_ignore_reads_it_is_not_waiting_for)
+{
+  CHECK_FALSE(the_host_answers(host_address, serial_number));
+
+  given_the_record_is_being_verified();
+  CHECK_FALSE(the_host_answers(other_address, serial_number));
+  CHECK_FALSE(platform.finished);
+
+  CHECK_TRUE(the_host_answers(host_address, serial_number));
+  CHECK_FALSE(the_host_answers(host_address, serial_number));
+}
+
+TEST(cached_identity, should_pass_along_a_captured_serial_number)
+{
+  cached_identity_capture(&self, other_address);
+  CHECK_EQUAL(other_address, platform.read_address);
+
+  CHECK_TRUE(the_host_answers(other_address, serial_number));
+  CHECK_EQUAL(cached_identity_result_captured, platform.result);
+  MEMCMP_EQUAL(serial_number, platform.serial_number, sizeof(serial_number));
+}
+
+TEST(cached_identity, should_save_a_sealed_record)
+{
+  identity_cache_record_init(
+    cached_identity_record(&self),
+    identity_cache_protocol_gea3,
+    host_address,
+    appliance_type,
+    serial_number,
+    sizeof(serial_number),
+    "Dishwasher_ZL4200ABC_SN12345678");
+
+  CHECK_TRUE(cached_identity_save(&self));
+  CHECK_TRUE(identity_cache_record_is_valid(&platform.stored));
+}
@@ -0,0 +1,180 @@
+/*!
+ * @file
+ * @brief Tests for the run-encoded ERD lists, the dense ERD index, ERD metadata and ERD bitsets
+ */
+
+extern "C" {
+#include "erd_bitset.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+// The index is usable at compile time
+static_assert(erdIndex(erdListAt(&commonErds, 0)) == 0, "first common ERD has index 0");
+static_assert(erdAtIndex(KNOWN_ERD_COUNT - 1) == erdListAt(&energyErds, energyErdCount - 1), "last energy ERD has the last index");
+
+static_assert(erdListContains(&probedCommonErds, 0x0033), "lists can be searched at compile time");
+static_assert(!erdListContains(&probedCommonErds, 0x0031), "gaps between runs are not in the list");
+
+static const erdList_t* const every_list[] = {
+  &commonErds, &refrigerationErds, &laundryErds, &dishWasherErds, &waterHeaterErds, &rangeErds,
+  &airConditioningErds, &waterFilterErds, &smallApplianceErds, &energyErds, &probedCommonErds
+};
+
+TEST_GROUP(erd_list)
+{
+};
+
+TEST(erd_list, should_iterate_over_each_position_in_ascending_order)
+{
+  for(const erdList_t* list : every_list) {
+    uint16_t position = 0;
+
+    for(erdListIterator_t erds = erdListBegin(list); !erdListIteratorDone(&erds); erdListIteratorNext(&erds)) {
+      CHECK_EQUAL(erdListAt(list, position), erdListIteratorErd(&erds));
+      CHECK_EQUAL(position, erdListPosition(list, erdListIteratorErd(&erds)));
+      if(position > 0) {
+        CHECK_TRUE(erdListIteratorErd(&erds) > erdListAt(list, position - 1));
+      }
+      position++;
+    }
+
+    CHECK_EQUAL(list->erdCount, position);
+  }
+}
+
+TEST(erd_list, should_only_contain_the_erds_in_its_runs)
+{
+  for(const erdList_t* list : every_list) {
+    for(uint16_t run = 0; run < list->runCount; run++) {
+      tiny_erd_t first = list->runs[run].first;
+      tiny_erd_t last = first + (erdRunEnd(list, run) - list->runs[run].offset) - 1;
+
+      CHECK_TRUE(erdListContains(list, first));
+      CHECK_TRUE(erdListContains(list, last));
+      CHECK_FALSE(erdListContains(list, first - 1));
+      CHECK_FALSE(erdListContains(list, last + 1));
+    }
+  }
+}
+
+TEST(erd_list, should_handle_empty_lists)
+{
+  erdListIterator_t erds = erdListBegin(&noErds);
+
+  CHECK_TRUE(erdListIteratorDone(&erds));
+  CHECK_FALSE(erdListContains(&noErds, 0x0001));
+  CHECK_EQUAL(0, erdListPosition(&noErds, 0x0001));
+}
+
+TEST_GROUP(erd_index)
+{
+};
+
+TEST(erd_index, should_number_every_known_erd_once_in_ascending_order)
+{
+  for(uint16_t index = 0; index < KNOWN_ERD_COUNT; index++) {
+    tiny_erd_t erd = erdAtIndex(index);
+    CHECK_EQUAL(index, erdIndex(erd));
+
+    if(index > 0) {
+      CHECK_TRUE(erd > erdAtIndex(index - 1));
+    }
+  }
+}
+
+TEST(erd_index, should_not_index_erds_missing_from_the_lists)
+{
+  CHECK_EQUAL(UNKNOWN_ERD_INDEX, erdIndex(0x0000));
+  CHECK_EQUAL(UNKNOWN_ERD_INDEX, erdIndex(0x6000));
+  CHECK_EQUAL(UNKNOWN_ERD_INDEX, erdIndex(0xFFFF));
+}
+
+TEST(erd_index, should_index_the_common_erds_the_polling_bridge_probes)
+{
+  // Polled on every appliance but not in the public documentation
+  CHECK_TRUE(erdIndex(0x0033) != UNKNOWN_ERD_INDEX);
+  CHECK_TRUE(erdIndex(0x0052) != UNKNOWN_ERD_INDEX);
+
+  for(uint16_t i = 0; i < probedCommonErdCount; i++) {
+    CHECK_TRUE(erdIndex(erdListAt(&probedCommonErds, i)) != UNKNOWN_ERD_INDEX);
+  }
+}
+
+static_assert(sizeof(erdMetadata_t) == 2, "metadata costs two bytes per known ERD");
+static_assert(erdWriteIsValid(0xABCD, 200), "writes to unknown ERDs are not checked");
+
+TEST_GROUP(erd_metadata)
+{
+};
+
+TEST(erd_metadata, should_have_no_metadata_for_erds_missing_from_the_lists)
+{
+  POINTERS_EQUAL(nullptr, erdMetadata(0xABCD));
+  CHECK_EQUAL(erdMetadataTable[0].size, erdMetadata(erdAtIndex(0))->size);
+}
+
+TEST(erd_metadata, should_reject_writes_to_read_only_erds)
+{
+  for(uint16_t index = 0; index < KNOWN_ERD_COUNT; index++) {
+    const erdMetadata_t& metadata = erdMetadataTable[index];
+    if(!(metadata.access & erdAccessWrite)) {
+      CHECK_FALSE(erdWriteIsValid(erdAtIndex(index), metadata.size));
+    }
+  }
+}
+
+TEST(erd_metadata, should_only_accept_writes_of_the_documented_size)
+{
+  for(uint16_t index = 0; index < KNOWN_ERD_COUNT; index++) {
+    const erdMetadata_t& metadata = erdMetadataTable[index];
+    if((metadata.access & erdAccessWrite) && (metadata.size > 0)) {
+      CHECK_TRUE(erdWriteIsValid(erdAtIndex(index), metadata.size));
+      CHECK_FALSE(erdWriteIsValid(erdAtIndex(index), metadata.size - 1));
+    }
+  }
+}
+
+TEST_GROUP(erd_bitset)
+{
+  erd_bitset_t self;
+
+  void setup()
+  {
+    erd_bitset_clear(&self);
+  }
+};
+
+TEST(erd_bitset, should_be_empty_after_clearing)
+{
+  CHECK_EQUAL(0, erd_bitset_count(&self));
+  CHECK_EQUAL(KNOWN_ERD_COUNT, erd_bitset_next(&self, 0));
+}
+
+TEST(erd_bitset, should_report_whether_an_insert_added_the_erd)
+{
+  CHECK_TRUE(erd_bitset_insert(&self, 42));
+  CHECK_FALSE(erd_bitset_insert(&self, 42));
+  CHECK_TRUE(erd_bitset_contains(&self, 42));
+  CHECK_FALSE(erd_bitset_contains(&self, 43));
+  CHECK_EQUAL(1, erd_bitset_count(&self));
+}
+
+TEST(erd_bitset, should_never_contain_unknown_erds)
+{
+  CHECK_FALSE(erd_bitset_contains(&self, UNKNOWN_ERD_INDEX));
+}
+
+TEST(erd_bitset, should_iterate_in_ascending_order_across_words)
+{
+  erd_bitset_insert(&self, KNOWN_ERD_COUNT - 1);
+  erd_bitset_insert(&self, 31);
+  erd_bitset_insert(&self, 0);
+  erd_bitset_insert(&self, 32);
+
+  CHECK_EQUAL(0, erd_bitset_next(&self, 0));
+  CHECK_EQUAL(31, erd_bitset_next(&self, 1));
+  CHECK_EQUAL(32, erd_bitset_next(&self, 32));
+  CHECK_EQUAL(KNOWN_ERD_COUNT - 1, erd_bitset_next(&self, 33));
+  CHECK_EQUAL(KNOWN_ERD_COUNT, erd_bitset_next(&self, KNOWN_ERD_COUNT));
+}
@@ -0,0 +1,398 @@
+/*!
+ * @file
+ * @brief Tests for sharing the GEA3 ERD client by priority
+ */
+
+extern "C" {
+#include "erd_request_arbiter.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/tiny_gea3_erd_client_double.hpp"
+#include "double/tiny_timer_group_double.hpp"
+
+static const erd_request_arbiter_configuration_t configuration = {
+  .limits = { 4, 2, 2, 1 },
+  .subscription_timeout = 1000
+};
+
+static uint8_t ready_count[erd_request_arbiter_priority_count];
+
+TEST_GROUP(erd_request_arbiter)
+{
+  enum {
+    address = 0xC0,
+    erd = 0x1234,
+    subscription_timeout = 1000
+  };
+
+  erd_request_arbiter_t self;
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  tiny_event_subscription_t ready_subscriptions[erd_request_arbiter_priority_count];
+  tiny_gea3_erd_client_request_id_t next_request_id;
+
+  void setup()
+  {
+    memset(ready_count, 0, sizeof(ready_count));
+    next_request_id = 0;
+
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    erd_request_arbiter_init(&self, &timer_group.timer_group, &erd_client.interface, &configuration);
+
+    for(uint8_t priority = 0; priority < erd_request_arbiter_priority_count; priority++) {
+      tiny_event_subscription_init(
+        &ready_subscriptions[priority], &ready_count[priority], +[](void* context, const void*) {
+          (*reinterpret_cast<uint8_t*>(context))++;
+        });
+      tiny_event_subscribe(erd_request_arbiter_on_ready(&self, priority), &ready_subscriptions[priority]);
+    }
+  }
+
+  void teardown()
+  {
+    mock().clear();
+  }
+
+  i_tiny_gea3_erd_client_t* client(erd_request_arbiter_priority_t priority)
+  {
+    return erd_request_arbiter_client(&self, priority);
+  }
+
+  void the_erd_client_accepts(const char* request)
+  {
+    static tiny_gea3_erd_client_request_id_t request_id;
+    request_id = next_request_id++;
+
+    mock()
+      .expectOneCall(request)
+      .onObject(&erd_client)
+      .withOutputParameterReturning("request_id", &request_id, sizeof(request_id))
+      .ignoreOtherParameters()
+      .andReturnValue(true);
+  }
+
+  void the_erd_client_refuses(const char* request)
+  {
+    mock()
+      .expectOneCall(request)
+      .onObject(&erd_client)
+      .ignoreOtherParameters()
+      .andReturnValue(false);
+  }
+
+  bool read(erd_request_arbiter_priority_t priority, tiny_gea3_erd_client_request_id_t* request_id = nullptr)
+  {
+    tiny_gea3_erd_client_request_id_t ignored;
+    return tiny_gea3_erd_client_read(client(priority), request_id ? request_id : &ignored, address, erd);
+  }
+
+  bool write(erd_request_arbiter_priority_t priority)
+  {
+    tiny_gea3_erd_client_request_id_t request_id;
+    uint8_t data = 0x42;
+    return tiny_gea3_erd_client_write(client(priority), &request_id, address, erd, &data, sizeof(data));
+  }
+
+  void a_read_completes(tiny_gea3_erd_client_request_id_t request_id)
+  {
+    uint8_t data = 0;
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_read_completed;
+    args.address = address;
+    args.read_completed.request_id = request_id;
+    args.read_completed.erd = erd;
+    args.read_completed.data = &data;
+    args.read_completed.data_size = sizeof(data);
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  void a_read_fails(tiny_gea3_erd_client_request_id_t request_id)
+  {
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_read_failed;
+    args.address = address;
+    args.read_failed.request_id = request_id;
+    args.read_failed.erd = erd;
+    args.read_failed.reason = tiny_gea3_erd_client_read_failure_reason_retries_exhausted;
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  void a_write_completes(tiny_gea3_erd_client_request_id_t request_id)
+  {
+    uint8_t data = 0x42;
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_write_completed;
+    args.address = address;
+    args.write_completed.request_id = request_id;
+    args.write_completed.erd = erd;
+    args.write_completed.data = &data;
+    args.write_completed.data_size = sizeof(data);
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  void a_subscription_is_added()
+  {
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_subscription_added_or_retained;
+    args.address = address;
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  bool subscribe()
+  {
+    return tiny_gea3_erd_client_subscribe(client(erd_request_arbiter_priority_poll), address);
+  }
+
+  bool retain_subscription()
+  {
+    return tiny_gea3_erd_client_retain_subscription(client(erd_request_arbiter_priority_poll), address);
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  const erd_request_arbiter_counters_t* counters(erd_request_arbiter_priority_t priority)
+  {
+    return erd_request_arbiter_counters(&self, priority);
+  }
+};
+
+TEST(erd_request_arbiter, should_forward_reads_and_return_the_erd_client_request_id)
+{
+  tiny_gea3_erd_client_request_id_t request_id = 0xFF;
+
+  next_request_id = 7;
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_identity, &request_id));
+  CHECK_EQUAL(7, request_id);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_identity)->accepted);
+}
+
+TEST(erd_request_arbiter, should_refuse_reads_over_the_class_limit_without_asking_the_erd_client)
+{
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_poll)->refused);
+}
+
+TEST(erd_request_arbiter, should_keep_room_for_writes_while_polling_is_at_its_limit)
+{
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+
+  the_erd_client_accepts("write");
+  CHECK_TRUE(write(erd_request_arbiter_priority_poll));
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_control)->accepted);
+  CHECK_EQUAL(0, counters(erd_request_arbiter_priority_poll)->refused);
+}
+
+TEST(erd_request_arbiter, should_publish_ready_once_a_refused_class_has_room_again)
+{
+  tiny_gea3_erd_client_request_id_t request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &request_id));
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+  CHECK_EQUAL(0, ready_count[erd_request_arbiter_priority_poll]);
+
+  a_read_completes(request_id);
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_poll]);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_poll)->completed);
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+}
+
+TEST(erd_request_arbiter, should_publish_ready_after_the_erd_client_itself_refused_once_any_request_finishes)
+{
+  tiny_gea3_erd_client_request_id_t request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &request_id));
+
+  the_erd_client_refuses("read");
+  CHECK_FALSE(read(erd_request_arbiter_priority_identity));
+
+  a_read_fails(request_id);
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_identity]);
+  CHECK_EQUAL(0, ready_count[erd_request_arbiter_priority_poll]);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_poll)->failed);
+}
+
+TEST(erd_request_arbiter, should_not_publish_ready_for_classes_that_were_never_refused)
+{
+  tiny_gea3_erd_client_request_id_t request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_identity, &request_id));
+  a_read_completes(request_id);
+
+  for(uint8_t priority = 0; priority < erd_request_arbiter_priority_count; priority++) {
+    CHECK_EQUAL(0, ready_count[priority]);
+  }
+}
+
+TEST(erd_request_arbiter, should_ignore_responses_to_requests_it_did_not_send)
+{
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+
+  a_read_completes(0x55);
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+  CHECK_EQUAL(0, counters(erd_request_arbiter_priority_poll)->completed);
+}
+
+TEST(erd_request_arbiter, should_charge_writes_to_the_control_class)
+{
+  tiny_gea3_erd_client_request_id_t request_id = next_request_id;
+
+  the_erd_client_accepts("write");
+  CHECK_TRUE(write(erd_request_arbiter_priority_identity));
+
+  a_write_completes(request_id);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_control)->completed);
+  CHECK_EQUAL(0, counters(erd_request_arbiter_priority_identity)->accepted);
+}
+
+TEST(erd_request_arbiter, should_limit_subscription_requests_until_the_erd_client_answers)
+{
+  the_erd_client_accepts("subscribe");
+  CHECK_TRUE(tiny_gea3_erd_client_subscribe(client(erd_request_arbiter_priority_poll), address));
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(tiny_gea3_erd_client_retain_subscription(client(erd_request_arbiter_priority_poll), address));
+
+  CHECK_FALSE(tiny_gea3_erd_client_subscribe(client(erd_request_arbiter_priority_poll), address));
+
+  a_subscription_is_added();
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_subscription]);
+
+  the_erd_client_accepts("subscribe");
+  CHECK_TRUE(tiny_gea3_erd_client_subscribe(client(erd_request_arbiter_priority_poll), address));
+}
+
+TEST(erd_request_arbiter, should_publish_the_erd_client_activity_to_its_callers)
+{
+  POINTERS_EQUAL(
+    tiny_gea3_erd_client_on_activity(&erd_client.interface),
+    tiny_gea3_erd_client_on_activity(client(erd_request_arbiter_priority_poll)));
+}
+
+TEST(erd_request_arbiter, should_take_the_next_read_while_a_slow_host_still_holds_an_abandoned_one)
+{
+  tiny_gea3_erd_client_request_id_t slow_request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &slow_request_id));
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+
+  erd_request_arbiter_abandon(&self, slow_request_id);
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_poll]);
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+}
+
+TEST(erd_request_arbiter, should_not_free_a_slot_again_when_an_abandoned_request_finishes)
+{
+  tiny_gea3_erd_client_request_id_t slow_request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &slow_request_id));
+  erd_request_arbiter_abandon(&self, slow_request_id);
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+
+  a_read_completes(slow_request_id);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_poll)->completed);
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+}
+
+TEST(erd_request_arbiter, should_keep_charging_requests_abandoned_past_the_class_limit)
+{
+  tiny_gea3_erd_client_request_id_t first_request_id;
+  tiny_gea3_erd_client_request_id_t second_request_id;
+
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &first_request_id));
+  erd_request_arbiter_abandon(&self, first_request_id);
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll, &second_request_id));
+
+  // The class already has its limit of abandoned requests waiting in the ERD client
+  erd_request_arbiter_abandon(&self, second_request_id);
+  CHECK_FALSE(read(erd_request_arbiter_priority_poll));
+
+  a_read_fails(first_request_id);
+  erd_request_arbiter_abandon(&self, second_request_id);
+  the_erd_client_accepts("read");
+  CHECK_TRUE(read(erd_request_arbiter_priority_poll));
+}
+
+TEST(erd_request_arbiter, should_give_back_the_slots_of_subscription_requests_the_erd_client_never_answers)
+{
+  the_erd_client_accepts("subscribe");
+  CHECK_TRUE(subscribe());
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+  CHECK_FALSE(subscribe());
+
+  after(subscription_timeout);
+  CHECK_EQUAL(0, ready_count[erd_request_arbiter_priority_subscription]);
+
+  after(subscription_timeout);
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_subscription]);
+  CHECK_EQUAL(2, counters(erd_request_arbiter_priority_subscription)->failed);
+
+  the_erd_client_accepts("subscribe");
+  CHECK_TRUE(subscribe());
+}
+
+TEST(erd_request_arbiter, should_only_give_back_the_slot_of_a_subscription_request_whose_answer_was_lost)
+{
+  // The first retain is dropped by the ERD client; only the second one is answered
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+  after(subscription_timeout);
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+  CHECK_FALSE(retain_subscription());
+
+  a_subscription_is_added();
+  CHECK_EQUAL(1, ready_count[erd_request_arbiter_priority_subscription]);
+
+  // Answers are taken to be for the oldest request, so the remaining slot is held a while longer
+  after(subscription_timeout * 2);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_subscription)->completed);
+  CHECK_EQUAL(1, counters(erd_request_arbiter_priority_subscription)->failed);
+
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+}
+
+TEST(erd_request_arbiter, should_not_time_out_subscription_requests_that_are_answered)
+{
+  the_erd_client_accepts("subscribe");
+  CHECK_TRUE(subscribe());
+  after(subscription_timeout);
+  a_subscription_is_added();
+
+  the_erd_client_accepts("retain_subscription");
+  CHECK_TRUE(retain_subscription());
+  after(subscription_timeout);
+  a_subscription_is_added();
+
+  after(subscription_timeout * 2);
+  CHECK_EQUAL(2, counters(erd_request_arbiter_priority_subscription)->completed);
+  CHECK_EQUAL(0, counters(erd_request_arbiter_priority_subscription)->failed);
+}
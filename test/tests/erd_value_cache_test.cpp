@@ -0,0 +1,243 @@
+/*!
+ * @file
+ * @brief Tests for the flat ERD value cache
+ */
+
+extern "C" {
+#include "erd_value_cache.h"
+}
+
+#include "allocation_counter.hpp"
+#include "erd_lists.h"
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(erd_value_cache)
+{
+  erd_value_cache_t self;
+
+  void setup()
+  {
+    erd_value_cache_init(&self, erd_value_cache_mode_full_copy);
+  }
+
+  void teardown()
+  {
+    erd_value_cache_destroy(&self);
+  }
+
+  template <typename T>
+  bool update(tiny_erd_t erd, T value)
+  {
+    return erd_value_cache_update(&self, erd, &value, sizeof(value));
+  }
+};
+
+TEST(erd_value_cache, should_treat_the_first_value_of_an_erd_as_a_change)
+{
+  CHECK_TRUE(update(0x0001, uint8_t(0x12)));
+}
+
+TEST(erd_value_cache, should_only_report_a_change_when_the_value_differs)
+{
+  update(0x0001, uint16_t(0x1234));
+
+  CHECK_FALSE(update(0x0001, uint16_t(0x1234)));
+  CHECK_TRUE(update(0x0001, uint16_t(0x4321)));
+  CHECK_FALSE(update(0x0001, uint16_t(0x4321)));
+}
+
+TEST(erd_value_cache, should_keep_values_of_different_erds_apart)
+{
+  update(0x0002, uint8_t(0x01));
+  update(0x0001, uint8_t(0x02));
+  update(0x0004, uint8_t(0x03));
+
+  CHECK_FALSE(update(0x0001, uint8_t(0x02)));
+  CHECK_FALSE(update(0x0002, uint8_t(0x01)));
+  CHECK_FALSE(update(0x0004, uint8_t(0x03)));
+}
+
+TEST(erd_value_cache, should_report_a_change_when_the_size_of_a_value_changes)
+{
+  update(0x0001, uint8_t(0x12));
+
+  CHECK_TRUE(update(0x0001, uint16_t(0x0012)));
+  CHECK_FALSE(update(0x0001, uint16_t(0x0012)));
+}
+
+TEST(erd_value_cache, should_always_report_erds_without_a_dense_index_as_changed)
+{
+  CHECK_TRUE(update(0xABCD, uint8_t(0x12)));
+  CHECK_TRUE(update(0xABCD, uint8_t(0x12)));
+  CHECK_FALSE(erd_value_cache_reserve(&self, 0xABCD, 1));
+}
+
+TEST(erd_value_cache, should_report_every_erd_as_changed_after_being_invalidated)
+{
+  update(0x0001, uint8_t(0x12));
+  erd_value_cache_invalidate(&self);
+
+  CHECK_TRUE(update(0x0001, uint8_t(0x12)));
+  CHECK_FALSE(update(0x0001, uint8_t(0x12)));
+}
+
+TEST(erd_value_cache, should_lay_out_reserved_erds_back_to_back_in_erd_order)
+{
+  erd_value_cache_reserve(&self, 0x0004, 4);
+  erd_value_cache_reserve(&self, 0x0001, 1);
+  erd_value_cache_reserve(&self, 0x0002, 2);
+
+  CHECK_EQUAL(3, self.entry_count);
+  CHECK_EQUAL(7, self.arena_used);
+  CHECK_EQUAL(erdIndex(0x0001), self.entries[0].erd_index);
+  CHECK_EQUAL(erdIndex(0x0002), self.entries[1].erd_index);
+  CHECK_EQUAL(erdIndex(0x0004), self.entries[2].erd_index);
+}
+
+TEST(erd_value_cache, should_not_allocate_once_every_erd_has_been_reserved)
+{
+  for(uint16_t i = 0; i < waterHeaterErdCount; i++) {
+    erd_value_cache_reserve(&self, erdListAt(&waterHeaterErds, i), 4);
+  }
+
+  const erd_value_cache_entry_t* entries = self.entries;
+  const uint8_t* arena = self.arena;
+  uint16_t entry_capacity = self.entry_capacity;
+  uint16_t arena_capacity = self.arena_capacity;
+
+  for(uint32_t cycle = 0; cycle < 1000; cycle++) {
+    for(uint16_t i = 0; i < waterHeaterErdCount; i++) {
+      update(erdListAt(&waterHeaterErds, i), cycle);
+    }
+  }
+
+  POINTERS_EQUAL(entries, self.entries);
+  POINTERS_EQUAL(arena, self.arena);
+  CHECK_EQUAL(entry_capacity, self.entry_capacity);
+  CHECK_EQUAL(arena_capacity, self.arena_capacity);
+  CHECK_EQUAL(waterHeaterErdCount * 4, self.arena_used);
+}
+
+TEST(erd_value_cache, should_reuse_its_memory_after_being_cleared)
+{
+  erd_value_cache_reserve(&self, 0x0001, 8);
+  const uint8_t* arena = self.arena;
+
+  erd_value_cache_clear(&self);
+  CHECK_EQUAL(0, self.entry_count);
+
+  CHECK_TRUE(update(0x0001, uint64_t(1)));
+  POINTERS_EQUAL(arena, self.arena);
+}
+
+TEST(erd_value_cache, should_move_the_index_and_the_values_into_one_block_when_sealed)
+{
+  erd_value_cache_reserve(&self, 0x0001, 1);
+  erd_value_cache_reserve(&self, 0x0002, 2);
+  update(0x0001, uint8_t(0x12));
+
+  erd_value_cache_seal(&self, 0, 0);
+
+  CHECK_EQUAL(2, self.entry_capacity);
+  CHECK_EQUAL(3, self.arena_capacity);
+  POINTERS_EQUAL(reinterpret_cast<uint8_t*>(self.entries) + 2 * sizeof(erd_value_cache_entry_t), self.arena);
+  CHECK_FALSE(update(0x0001, uint8_t(0x12)));
+}
+
+TEST(erd_value_cache, should_only_cache_new_erds_in_its_headroom_once_sealed)
+{
+  erd_value_cache_reserve(&self, 0x0001, 1);
+  erd_value_cache_seal(&self, 1, 1);
+
+  CHECK_TRUE(update(0x0002, uint8_t(0x34)));
+  CHECK_FALSE(update(0x0002, uint8_t(0x34)));
+
+  CHECK_TRUE(update(0x0004, uint8_t(0x56)));
+  CHECK_TRUE(update(0x0004, uint8_t(0x56)));
+}
+
+TEST(erd_value_cache, should_not_allocate_once_sealed)
+{
+  SKIP_UNLESS_ALLOCATIONS_ARE_COUNTED();
+
+  for(uint16_t i = 0; i < waterHeaterErdCount; i++) {
+    erd_value_cache_reserve(&self, erdListAt(&waterHeaterErds, i), 4);
+  }
+  erd_value_cache_seal(&self, 0, 0);
+  allocation_counter_begin();
+
+  for(uint32_t cycle = 0; cycle < 1000; cycle++) {
+    for(uint16_t i = 0; i < waterHeaterErdCount; i++) {
+      update(erdListAt(&waterHeaterErds, i), cycle);
+    }
+    update(0x0001, uint64_t(cycle));
+    update(erdListAt(&waterHeaterErds, 0), uint8_t(cycle));
+  }
+
+  allocation_counter_end();
+  CHECK_NO_ALLOCATIONS();
+}
+
+TEST(erd_value_cache, should_grow_again_after_being_cleared_once_sealed)
+{
+  erd_value_cache_reserve(&self, 0x0001, 1);
+  erd_value_cache_seal(&self, 0, 0);
+
+  erd_value_cache_clear(&self);
+  CHECK_FALSE(self.sealed);
+
+  update(0x0001, uint8_t(0x12));
+  update(0x0002, uint8_t(0x34));
+  CHECK_FALSE(update(0x0001, uint8_t(0x12)));
+  CHECK_FALSE(update(0x0002, uint8_t(0x34)));
+}
+
+TEST_GROUP(erd_value_cache_digest)
+{
+  erd_value_cache_t self;
+
+  void setup()
+  {
+    erd_value_cache_init(&self, erd_value_cache_mode_digest);
+  }
+
+  void teardown()
+  {
+    erd_value_cache_destroy(&self);
+  }
+
+  template <typename T>
+  bool update(tiny_erd_t erd, T value)
+  {
+    return erd_value_cache_update(&self, erd, &value, sizeof(value));
+  }
+};
+
+TEST(erd_value_cache_digest, should_only_report_a_change_when_the_value_differs)
+{
+  CHECK_TRUE(update(0x0001, uint64_t(0x1122334455667788)));
+  CHECK_FALSE(update(0x0001, uint64_t(0x1122334455667788)));
+  CHECK_TRUE(update(0x0001, uint64_t(0x1122334455667789)));
+}
+
+TEST(erd_value_cache_digest, should_report_a_change_when_the_size_of_a_value_changes)
+{
+  update(0x0001, uint8_t(0x00));
+
+  CHECK_TRUE(update(0x0001, uint16_t(0x0000)));
+  CHECK_FALSE(update(0x0001, uint16_t(0x0000)));
+}
+
+TEST(erd_value_cache_digest, should_keep_four_bytes_per_erd_whatever_the_size_of_its_value)
+{
+  uint8_t model_number[32] = { 'Z', 'L', '4', '2' };
+
+  erd_value_cache_reserve(&self, 0x0001, sizeof(model_number));
+  erd_value_cache_reserve(&self, 0x0002, 1);
+  CHECK_EQUAL(8, self.arena_used);
+
+  CHECK_TRUE(erd_value_cache_update(&self, 0x0001, model_number, sizeof(model_number)));
+  CHECK_TRUE(update(0x0001, uint8_t(1)));
+  CHECK_EQUAL(8, self.arena_used);
+}
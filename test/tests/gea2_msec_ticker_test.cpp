@@ -0,0 +1,138 @@
+/*!
+ * @file
+ * @brief Tests for the on-demand GEA2 msec interrupt
+ */
+
+extern "C" {
+#include "gea2_msec_ticker.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_timer_group_double.hpp"
+
+static void count_tick(void* context, const void*)
+{
+  (*static_cast<uint32_t*>(context))++;
+}
+
+TEST_GROUP(gea2_msec_ticker)
+{
+  gea2_msec_ticker_t self;
+  tiny_timer_group_double_t timer_group;
+  tiny_event_subscription_t tick_subscription;
+  uint32_t ticks;
+
+  void setup()
+  {
+    ticks = 0;
+    tiny_timer_group_double_init(&timer_group);
+    gea2_msec_ticker_init(&self, &timer_group.timer_group);
+
+    tiny_event_subscription_init(&tick_subscription, &ticks, count_tick);
+    tiny_event_subscribe(gea2_msec_ticker_on_msec_interrupt(&self), &tick_subscription);
+  }
+
+  void after(tiny_timer_ticks_t duration)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, duration);
+  }
+};
+
+TEST(gea2_msec_ticker, should_not_publish_or_schedule_anything_while_idle)
+{
+  after(1000);
+
+  CHECK_EQUAL(0, ticks);
+  CHECK_FALSE(gea2_msec_ticker_is_active(&self));
+  CHECK_FALSE(tiny_timer_ticks_until_next_ready(&timer_group.timer_group) < 1000);
+}
+
+TEST(gea2_msec_ticker, should_publish_every_millisecond_while_held)
+{
+  gea2_msec_ticker_hold(&self, 10);
+
+  after(5);
+  CHECK_EQUAL(5, ticks);
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_stop_when_the_hold_ends)
+{
+  gea2_msec_ticker_hold(&self, 10);
+
+  after(100);
+
+  CHECK_FALSE(gea2_msec_ticker_is_active(&self));
+  CHECK_TRUE(ticks <= 10);
+}
+
+TEST(gea2_msec_ticker, should_extend_a_hold)
+{
+  gea2_msec_ticker_hold(&self, 10);
+  after(5);
+  gea2_msec_ticker_hold(&self, 10);
+
+  after(9);
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+
+  after(2);
+  CHECK_FALSE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_not_shorten_a_longer_hold)
+{
+  gea2_msec_ticker_hold(&self, 100);
+  gea2_msec_ticker_hold(&self, 10);
+
+  after(50);
+
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_keep_publishing_while_requests_are_outstanding)
+{
+  gea2_msec_ticker_request_started(&self);
+  gea2_msec_ticker_request_started(&self);
+
+  after(5000);
+  CHECK_EQUAL(5000, ticks);
+
+  gea2_msec_ticker_request_finished(&self);
+  after(5000);
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_stop_when_the_last_request_finishes)
+{
+  gea2_msec_ticker_request_started(&self);
+  gea2_msec_ticker_request_started(&self);
+  after(10);
+
+  gea2_msec_ticker_request_finished(&self);
+  gea2_msec_ticker_request_finished(&self);
+
+  CHECK_FALSE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_keep_a_hold_after_the_last_request_finishes)
+{
+  gea2_msec_ticker_request_started(&self);
+  gea2_msec_ticker_hold(&self, 10);
+  gea2_msec_ticker_request_finished(&self);
+
+  after(9);
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+
+  after(2);
+  CHECK_FALSE(gea2_msec_ticker_is_active(&self));
+}
+
+TEST(gea2_msec_ticker, should_ignore_finished_requests_that_were_never_started)
+{
+  gea2_msec_ticker_request_finished(&self);
+  gea2_msec_ticker_request_started(&self);
+
+  after(100);
+
+  CHECK_TRUE(gea2_msec_ticker_is_active(&self));
+}
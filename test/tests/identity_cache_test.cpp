@@ -0,0 +1,144 @@
+/*!
+ * @file
+ * @brief Tests for the persisted bus topology and device identity record
+ */
+
+extern "C" {
+#include "identity_cache.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(identity_cache)
+{
+  enum {
+    host_address = 0xC0,
+    appliance_type = 6
+  };
+
+  identity_cache_record_t record;
+
+  const uint8_t serial_number[32] = { 'S', 'N', '1', '2', '3', '4', '5', '6', '7', '8' };
+
+  void given_a_sealed_record()
+  {
+    identity_cache_record_init(
+      &record,
+      identity_cache_protocol_gea3,
+      host_address,
+      appliance_type,
+      serial_number,
+      sizeof(serial_number),
+      "Dishwasher_ZL4200ABC_SN12345678");
+    identity_cache_record_seal(&record);
+  }
+};
+
+TEST(identity_cache, should_not_be_valid_before_it_is_sealed)
+{
+  identity_cache_record_init(
+    &record,
+    identity_cache_protocol_gea3,
+    host_address,
+    appliance_type,
+    serial_number,
+    sizeof(serial_number),
+    "Dishwasher_ZL4200ABC_SN12345678");
+
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+}
+
+TEST(identity_cache, should_not_treat_erased_storage_as_a_valid_record)
+{
+  memset(&record, 0, sizeof(record));
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+
+  memset(&record, 0xFF, sizeof(record));
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+}
+
+TEST(identity_cache, should_restore_the_identity_from_a_sealed_record)
+{
+  given_a_sealed_record();
+
+  CHECK_TRUE(identity_cache_record_is_valid(&record));
+  CHECK_EQUAL(identity_cache_protocol_gea3, record.protocol);
+  CHECK_EQUAL(host_address, record.host_address);
+  CHECK_EQUAL(appliance_type, record.appliance_type);
+  STRCMP_EQUAL("Dishwasher_ZL4200ABC_SN12345678", record.device_id);
+}
+
+TEST(identity_cache, should_detect_a_corrupted_record)
+{
+  given_a_sealed_record();
+  record.host_address = 0xC1;
+
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+}
+
+TEST(identity_cache, should_not_be_valid_after_it_is_invalidated)
+{
+  given_a_sealed_record();
+  identity_cache_record_invalidate(&record);
+
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+}
+
+TEST(identity_cache, should_not_be_valid_if_the_device_id_was_truncated)
+{
+  char device_id[identity_cache_device_id_size + 8];
+  memset(device_id, 'x', sizeof(device_id) - 1);
+  device_id[sizeof(device_id) - 1] = 0;
+
+  identity_cache_record_init(
+    &record,
+    identity_cache_protocol_gea2,
+    0xA0,
+    appliance_type,
+    serial_number,
+    sizeof(serial_number),
+    device_id);
+  identity_cache_record_seal(&record);
+
+  CHECK_FALSE(identity_cache_record_is_valid(&record));
+}
+
+TEST(identity_cache, should_match_the_serial_number_it_was_created_for)
+{
+  given_a_sealed_record();
+
+  CHECK_TRUE(identity_cache_record_matches_serial_number(&record, serial_number, sizeof(serial_number)));
+}
+
+TEST(identity_cache, should_ignore_padding_after_the_serial_number)
+{
+  given_a_sealed_record();
+
+  const uint8_t unpadded[] = { 'S', 'N', '1', '2', '3', '4', '5', '6', '7', '8' };
+  CHECK_TRUE(identity_cache_record_matches_serial_number(&record, unpadded, sizeof(unpadded)));
+}
+
+TEST(identity_cache, should_not_match_a_different_serial_number)
+{
+  given_a_sealed_record();
+
+  const uint8_t other[32] = { 'S', 'N', '8', '7', '6', '5', '4', '3', '2', '1' };
+  CHECK_FALSE(identity_cache_record_matches_serial_number(&record, other, sizeof(other)));
+}
+
+TEST(identity_cache, should_remember_secondary_hosts_until_full)
+{
+  given_a_sealed_record();
+
+  for(uint8_t i = 0; i < identity_cache_max_hosts - 1; i++) {
+    CHECK_TRUE(identity_cache_record_add_secondary_host(&record, 0xC1 + i));
+  }
+  CHECK_FALSE(identity_cache_record_add_secondary_host(&record, 0xD0));
+  identity_cache_record_seal(&record);
+
+  CHECK_TRUE(identity_cache_record_is_valid(&record));
+  CHECK_EQUAL(identity_cache_max_hosts - 1, record.secondary_host_count);
+  CHECK_EQUAL(0xC1, record.secondary_host_addresses[0]);
+}
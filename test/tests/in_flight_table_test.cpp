@@ -0,0 +1,104 @@
+/*!
+ * @file
+ * @brief Tests for matching ERD read responses to the reads in flight
+ */
+
+extern "C" {
+#include "in_flight_table.h"
+#include "tiny_gea_constants.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(in_flight_table)
+{
+  enum {
+    address = 0xC0,
+    erd = 0x1234
+  };
+
+  in_flight_table_t self;
+
+  void setup()
+  {
+    in_flight_table_init(&self);
+  }
+
+  in_flight_request_t* a_read_is_added(
+    tiny_gea3_erd_client_request_id_t request_id,
+    tiny_time_source_ticks_t issued_at = 0,
+    uint8_t read_address = address)
+  {
+    return in_flight_table_add(&self, request_id, read_address, erd, issued_at, 0);
+  }
+};
+
+TEST(in_flight_table, should_match_a_response_by_request_id_address_and_erd)
+{
+  a_read_is_added(1);
+  in_flight_request_t* request = a_read_is_added(2);
+
+  POINTERS_EQUAL(request, in_flight_table_match(&self, 2, address, erd));
+  CHECK_EQUAL(0, self.orphaned_count);
+}
+
+TEST(in_flight_table, should_count_responses_that_match_no_read_as_orphaned)
+{
+  a_read_is_added(1);
+
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 2, address, erd));
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 1, address + 1, erd));
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 1, address, erd + 1));
+  CHECK_EQUAL(3, self.orphaned_count);
+}
+
+TEST(in_flight_table, should_match_a_broadcast_read_to_a_response_from_any_address)
+{
+  in_flight_request_t* request = a_read_is_added(1, 0, tiny_gea_broadcast_address);
+
+  POINTERS_EQUAL(request, in_flight_table_match(&self, 1, address, erd));
+}
+
+TEST(in_flight_table, should_still_match_an_expired_read_until_it_is_removed)
+{
+  in_flight_request_t* request = a_read_is_added(1);
+  in_flight_table_expire(&self, request);
+
+  POINTERS_EQUAL(request, in_flight_table_match(&self, 1, address, erd));
+  CHECK_TRUE(request->expired);
+
+  in_flight_table_remove(&self, request);
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 1, address, erd));
+  CHECK_EQUAL(0, in_flight_table_count(&self));
+}
+
+TEST(in_flight_table, should_replace_the_oldest_expired_read_when_full)
+{
+  for(uint8_t i = 0; i < in_flight_table_size; i++) {
+    in_flight_request_t* request = a_read_is_added(i, 100 + i);
+    if(i >= 2) {
+      in_flight_table_expire(&self, request);
+    }
+  }
+
+  a_read_is_added(0x80, 200);
+
+  CHECK_EQUAL(in_flight_table_size, in_flight_table_count(&self));
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 2, address, erd));
+  CHECK_TRUE(in_flight_table_match(&self, 0, address, erd) != nullptr);
+  CHECK_TRUE(in_flight_table_match(&self, 0x80, address, erd) != nullptr);
+}
+
+TEST(in_flight_table, should_replace_the_oldest_read_across_a_tick_wrap_when_none_have_expired)
+{
+  tiny_time_source_ticks_t before_wrap = static_cast<tiny_time_source_ticks_t>(0) - 10;
+
+  for(uint8_t i = 0; i < in_flight_table_size; i++) {
+    a_read_is_added(i, before_wrap + i);
+  }
+
+  a_read_is_added(0x80, 5);
+
+  POINTERS_EQUAL(nullptr, in_flight_table_match(&self, 0, address, erd));
+  CHECK_TRUE(in_flight_table_match(&self, 1, address, erd) != nullptr);
+}
@@ -0,0 +1,83 @@
+/*!
+ * @file
+ * @brief Tests for loop pacing and duty cycle measurement
+ */
+
+extern "C" {
+#include "loop_pacing.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(loop_pacing)
+{
+  loop_pacing_t self;
+
+  void setup()
+  {
+    loop_pacing_init(&self);
+  }
+};
+
+TEST(loop_pacing, should_need_high_frequency_while_a_transaction_is_in_flight)
+{
+  CHECK_TRUE(loop_pacing_needs_high_frequency(1000, true));
+}
+
+TEST(loop_pacing, should_need_high_frequency_when_a_timer_is_due_before_the_next_regular_loop)
+{
+  CHECK_TRUE(loop_pacing_needs_high_frequency(loop_pacing_regular_interval - 1, false));
+}
+
+TEST(loop_pacing, should_yield_when_idle)
+{
+  CHECK_FALSE(loop_pacing_needs_high_frequency(loop_pacing_regular_interval, false));
+}
+
+TEST(loop_pacing, should_measure_the_share_of_time_spent_in_the_loop)
+{
+  for(uint32_t i = 0; i < 10; i++) {
+    loop_pacing_record(&self, i * 1000, i * 1000 + 50, false);
+  }
+
+  CHECK_EQUAL(50, loop_pacing_duty_cycle_permille(&self, 10000));
+  CHECK_EQUAL(10, self.loops);
+}
+
+TEST(loop_pacing, should_count_high_frequency_loops)
+{
+  loop_pacing_record(&self, 0, 10, true);
+  loop_pacing_record(&self, 100, 110, false);
+
+  CHECK_EQUAL(1, self.high_frequency_loops);
+}
+
+TEST(loop_pacing, should_report_once_the_window_is_complete)
+{
+  CHECK_FALSE(loop_pacing_record(&self, 0, 10, false));
+  CHECK_FALSE(loop_pacing_record(&self, loop_pacing_report_window_us - 100, loop_pacing_report_window_us - 1, false));
+  CHECK_TRUE(loop_pacing_record(&self, loop_pacing_report_window_us - 1, loop_pacing_report_window_us, false));
+}
+
+TEST(loop_pacing, should_start_a_new_window)
+{
+  loop_pacing_record(&self, 0, 500, true);
+  loop_pacing_start_window(&self, 1000);
+
+  loop_pacing_record(&self, 1000, 1100, false);
+
+  CHECK_EQUAL(100, loop_pacing_duty_cycle_permille(&self, 2000));
+  CHECK_EQUAL(1, self.loops);
+  CHECK_EQUAL(0, self.high_frequency_loops);
+}
+
+TEST(loop_pacing, should_handle_the_microsecond_clock_wrapping)
+{
+  uint32_t start = UINT32_MAX - 200;
+
+  loop_pacing_record(&self, start, start + 100, false);
+  loop_pacing_record(&self, start + 500, start + 600, false);
+
+  CHECK_EQUAL(200, self.busy_us);
+  CHECK_EQUAL(200, loop_pacing_duty_cycle_permille(&self, start + 1000));
+}
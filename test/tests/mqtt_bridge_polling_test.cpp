@@ -14,6 +14,12 @@ extern "C" {
 #include "double/mqtt_client_double.hpp"
 #include "double/tiny_gea3_erd_client_double.hpp"
 #include "double/tiny_timer_group_double.hpp"
+#include "fixed_read_timeout.hpp"
+
+static const rtt_estimator_configuration_t adaptive_read_timeout_configuration = { 100, 20, 500 };
+
+static uint8_t abandoned_read_count;
+static tiny_gea3_erd_client_request_id_t abandoned_request_id;
 
 TEST_GROUP(mqtt_bridge_polling)
 {
@@ -22,10 +28,10 @@ TEST_GROUP(mqtt_bridge_polling)
     polling_interval = 1000,
 
     // Number of timer expirations needed to skip discovery states.
-    // common_erds in mqtt_bridge_polling.cpp has 30 entries; after the first
-    // read_completed, 29 more timer expirations are needed to exit that state.
-    // energyErdCount and waterHeaterErdCount come from erd_lists.h.
-    common_erds_remaining = 29,
+    // After the first read_completed, one timer expiration is needed for each
+    // remaining entry of probedCommonErds to exit that state.
+    // The counts all come from erd_lists.h.
+    common_erds_remaining = probedCommonErdCount - 1,
     discovery_timer_expirations = common_erds_remaining + energyErdCount + waterHeaterErdCount,
 
     polled_erd = 0x0001
@@ -33,10 +39,16 @@ TEST_GROUP(mqtt_bridge_polling)
 
   mqtt_bridge_polling_t self;
 
+  // The last discovery read before polling starts goes unanswered; its response can arrive late
+  tiny_erd_t late_erd;
+  tiny_gea3_erd_client_request_id_t late_request_id;
+
   tiny_timer_group_double_t timer_group;
   tiny_gea3_erd_client_double_t erd_client;
   mqtt_client_double_t mqtt_client;
 
+  tiny_event_subscription_t read_abandoned_subscription;
+
   void setup()
   {
     mock().strictOrder();
@@ -53,7 +65,9 @@ TEST_GROUP(mqtt_bridge_polling)
     mock().enable();
   }
 
-  void when_the_bridge_is_initialized(bool only_publish_on_change = false)
+  void when_the_bridge_is_initialized(
+    bool only_publish_on_change = false,
+    const rtt_estimator_configuration_t* read_timeout = &fixed_read_timeout_configuration)
   {
     mqtt_bridge_polling_init(
       &self,
@@ -61,7 +75,9 @@ TEST_GROUP(mqtt_bridge_polling)
       &erd_client.interface,
       &mqtt_client.interface,
       polling_interval,
-      only_publish_on_change);
+      only_publish_on_change,
+      erd_value_cache_mode_full_copy,
+      read_timeout);
   }
 
   void after(tiny_timer_ticks_t ticks)
@@ -70,10 +86,16 @@ TEST_GROUP(mqtt_bridge_polling)
   }
 
   void trigger_read_completed(uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
+  {
+    trigger_read_completed(self.request_id, address, erd, data, data_size);
+  }
+
+  void trigger_read_completed(tiny_gea3_erd_client_request_id_t request_id, uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
   {
     tiny_gea3_erd_client_on_activity_args_t args;
     args.type = tiny_gea3_erd_client_activity_type_read_completed;
     args.address = address;
+    args.read_completed.request_id = request_id;
     args.read_completed.erd = erd;
     args.read_completed.data = data;
     args.read_completed.data_size = data_size;
@@ -94,7 +116,10 @@ TEST_GROUP(mqtt_bridge_polling)
     trigger_read_completed(0xC0, polled_erd, &initial_value, sizeof(initial_value));
 
     // Skip remaining discovery ERDs using timer expirations
-    after(retry_delay * discovery_timer_expirations);
+    after(retry_delay * (discovery_timer_expirations - 1));
+    late_erd = erdListAt(&waterHeaterErds, waterHeaterErdCount - 1);
+    late_request_id = self.request_id;
+    after(retry_delay);
 
     mock().enable();
   }
@@ -110,6 +135,17 @@ TEST_GROUP(mqtt_bridge_polling)
       .andReturnValue(true);
   }
 
+  void should_request_read_and_be_refused(uint8_t address, tiny_erd_t erd)
+  {
+    mock()
+      .expectOneCall("read")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .withParameter("erd", erd)
+      .ignoreOtherParameters()
+      .andReturnValue(false);
+  }
+
   void should_register_erd(tiny_erd_t erd)
   {
     mock()
@@ -139,6 +175,26 @@ TEST_GROUP(mqtt_bridge_polling)
     trigger_read_completed(address, erd, &_value, sizeof(_value));
   }
 
+  template <typename T>
+  void when_the_late_discovery_response_arrives(T value)
+  {
+    static T _value;
+    _value = value;
+    trigger_read_completed(late_request_id, 0xC0, late_erd, &_value, sizeof(_value));
+  }
+
+  void abandoned_reads_are_recorded()
+  {
+    abandoned_read_count = 0;
+    tiny_event_subscription_init(
+      &read_abandoned_subscription, nullptr, +[](void*, const void* _args) {
+        auto args = reinterpret_cast<const mqtt_bridge_polling_on_read_abandoned_args_t*>(_args);
+        abandoned_read_count++;
+        abandoned_request_id = args->request_id;
+      });
+    tiny_event_subscribe(mqtt_bridge_polling_on_read_abandoned(&self), &read_abandoned_subscription);
+  }
+
   void nothing_should_happen()
   {
   }
@@ -207,29 +263,30 @@ TEST(mqtt_bridge_polling, should_republish_mqtt_when_polled_erd_data_changes_and
 
 // A late response from a discovery-phase read that arrives after the state
 // machine has already transitioned to polling (device responded slower than
-// retry_delay). The ERD must be registered and added to the polling list.
+// retry_delay). The ERD must be registered and added to the polling list, but
+// the bridge keeps waiting for the read it is actually on.
 TEST(mqtt_bridge_polling, should_register_and_poll_erd_whose_discovery_response_arrives_late_in_polling_state)
 {
-  enum { late_erd = 0x7b00 };
-
   given_that_the_bridge_has_entered_polling_state();
 
   // Cycle 1: polling timer fires and begins reading polled_erd
   should_request_read(0xC0, polled_erd);
   after(polling_interval);
 
-  // Late discovery response for late_erd arrives before polled_erd responds.
-  // Bridge registers it, publishes its value, then immediately reads the
-  // newly-registered ERD (now at the next position in the polling list).
+  // Late discovery response arrives before polled_erd responds. Bridge
+  // registers it and publishes its value without sending another read.
   should_register_erd(late_erd);
   should_update_erd(late_erd, uint8_t(0xAB));
-  should_request_read(0xC0, late_erd);
-  when_a_poll_read_completes(0xC0, late_erd, uint8_t(0xAB));
+  when_the_late_discovery_response_arrives(uint8_t(0xAB));
 
-  // polled_erd arrives next; erd_index is now at the end so no further read
+  // polled_erd arrives next and the newly-registered ERD is read after it
   should_update_erd(polled_erd, uint8_t(0x01));
+  should_request_read(0xC0, late_erd);
   when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
 
+  should_update_erd(late_erd, uint8_t(0xAB));
+  when_a_poll_read_completes(0xC0, late_erd, uint8_t(0xAB));
+
   // Cycle 2: late_erd is now in the polling list alongside polled_erd
   should_request_read(0xC0, polled_erd);
   after(polling_interval);
@@ -246,31 +303,276 @@ TEST(mqtt_bridge_polling, should_register_and_poll_erd_whose_discovery_response_
 // Same late-response scenario with only_publish_on_change enabled.
 TEST(mqtt_bridge_polling, should_register_and_poll_late_erd_when_only_publish_on_change_is_enabled)
 {
-  enum { late_erd = 0x7b05 };
-
   given_that_the_bridge_has_entered_polling_state(true);
 
   should_request_read(0xC0, polled_erd);
   after(polling_interval);
 
-  // New ERD: always published on first read; bridge immediately reads the
-  // newly-registered ERD (appended to the polling list).
+  // New ERD: always published on first read
   should_register_erd(late_erd);
   should_update_erd(late_erd, uint8_t(0xCD));
-  should_request_read(0xC0, late_erd);
-  when_a_poll_read_completes(0xC0, late_erd, uint8_t(0xCD));
+  when_the_late_discovery_response_arrives(uint8_t(0xCD));
 
   should_update_erd(polled_erd, uint8_t(0x01));
+  should_request_read(0xC0, late_erd);
   when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
 
+  // late_erd same value as its late response → not republished
+  nothing_should_happen();
+  when_a_poll_read_completes(0xC0, late_erd, uint8_t(0xCD));
+
   // Cycle 2: both ERDs polled; values unchanged → neither is republished
   should_request_read(0xC0, polled_erd);
   after(polling_interval);
 
-  // polled_erd same value → not published; late_erd read is triggered inline
   should_request_read(0xC0, late_erd);
   when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
 
   nothing_should_happen();
   when_a_poll_read_completes(0xC0, late_erd, uint8_t(0xCD));
 }
+
+TEST(mqtt_bridge_polling, should_ignore_a_response_whose_request_id_does_not_match_a_read_in_flight)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  should_request_read(0xC0, polled_erd);
+  after(polling_interval);
+
+  uint8_t value = 0x01;
+  nothing_should_happen();
+  trigger_read_completed(static_cast<tiny_gea3_erd_client_request_id_t>(self.request_id + 1), 0xC0, polled_erd, &value, sizeof(value));
+  CHECK_EQUAL(1, self.in_flight.orphaned_count);
+
+  should_update_erd(polled_erd, uint8_t(0x01));
+  when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
+}
+
+TEST(mqtt_bridge_polling, should_ignore_a_response_for_a_different_erd_or_host_than_was_read)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  should_request_read(0xC0, polled_erd);
+  after(polling_interval);
+
+  nothing_should_happen();
+  when_a_poll_read_completes(0xC0, 0x0002, uint8_t(0x01));
+  when_a_poll_read_completes(0xC1, polled_erd, uint8_t(0x01));
+  CHECK_EQUAL(2, self.in_flight.orphaned_count);
+}
+
+TEST(mqtt_bridge_polling, should_measure_the_latency_of_each_read)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  should_request_read(0xC0, polled_erd);
+  after(polling_interval);
+
+  after(37);
+  should_update_erd(polled_erd, uint8_t(0x01));
+  when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
+  CHECK_EQUAL(37, self.last_read_latency);
+}
+
+TEST(mqtt_bridge_polling, should_retry_the_same_erd_when_a_poll_read_cannot_be_queued)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  should_request_read_and_be_refused(0xC0, polled_erd);
+  after(polling_interval);
+
+  should_request_read(0xC0, polled_erd);
+  after(retry_delay);
+
+  should_update_erd(polled_erd, uint8_t(0x01));
+  when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
+}
+
+TEST(mqtt_bridge_polling, should_retry_the_same_erd_when_a_discovery_read_cannot_be_queued)
+{
+  enum { first_common_erd = 0x0001, second_common_erd = 0x0002 };
+
+  should_request_read(0xFF, 0x0008);
+  when_the_bridge_is_initialized();
+
+  uint8_t appliance_type = 0x00;
+  should_request_read_and_be_refused(0xC0, first_common_erd);
+  trigger_read_completed(0xC0, 0x0008, &appliance_type, sizeof(appliance_type));
+
+  should_request_read(0xC0, first_common_erd);
+  after(retry_delay);
+
+  should_request_read(0xC0, second_common_erd);
+  after(retry_delay);
+}
+
+TEST(mqtt_bridge_polling, should_report_a_write_that_cannot_be_queued_as_failed)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  mock()
+    .expectOneCall("write")
+    .onObject(&erd_client)
+    .ignoreOtherParameters()
+    .andReturnValue(false);
+  mock()
+    .expectOneCall("update_erd_write_result")
+    .onObject(&mqtt_client)
+    .withParameter("erd", 0xABCD)
+    .withParameter("success", false)
+    .withParameter("failure_reason", tiny_gea3_erd_client_write_failure_reason_retries_exhausted);
+
+  uint8_t value = 0x12;
+  mqtt_client_double_trigger_write_request(&mqtt_client, 0xABCD, sizeof(value), &value);
+}
+
+TEST(mqtt_bridge_polling, should_still_match_the_read_in_flight_after_a_write)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  should_request_read(0xC0, polled_erd);
+  after(polling_interval);
+
+  tiny_gea3_erd_client_request_id_t write_request_id = self.request_id + 0x40;
+  mock()
+    .expectOneCall("write")
+    .onObject(&erd_client)
+    .withOutputParameterReturning("request_id", &write_request_id, sizeof(write_request_id))
+    .ignoreOtherParameters()
+    .andReturnValue(true);
+  uint8_t value = 0x12;
+  mqtt_client_double_trigger_write_request(&mqtt_client, 0xABCD, sizeof(value), &value);
+
+  should_update_erd(polled_erd, uint8_t(0x01));
+  when_a_poll_read_completes(0xC0, polled_erd, uint8_t(0x01));
+}
+
+TEST(mqtt_bridge_polling, should_reject_writes_to_read_only_erds_without_sending_them)
+{
+  given_that_the_bridge_has_entered_polling_state();
+
+  mock()
+    .expectOneCall("update_erd_write_result")
+    .onObject(&mqtt_client)
+    .withParameter("erd", 0x0001)
+    .withParameter("success", false)
+    .withParameter("failure_reason", tiny_gea3_erd_client_write_failure_reason_not_supported);
+
+  // The model number is read only
+  uint8_t value = 0x12;
+  mqtt_client_double_trigger_write_request(&mqtt_client, 0x0001, sizeof(value), &value);
+}
+
+TEST(mqtt_bridge_polling, should_give_up_on_reads_sooner_for_a_host_that_answers_quickly)
+{
+  uint8_t value = 0x00;
+
+  mock().disable();
+  when_the_bridge_is_initialized(false, &adaptive_read_timeout_configuration);
+  after(5);
+  trigger_read_completed(0xC0, 0x0008, &value, sizeof(value));
+
+  // Answered in 5 ms, so the next read only waits for the minimum timeout
+  after(5);
+  trigger_read_completed(0xC0, 0x0001, &value, sizeof(value));
+  mock().enable();
+
+  after(19);
+
+  should_request_read(0xC0, 0x0004);
+  after(1);
+}
+
+TEST(mqtt_bridge_polling, should_wait_longer_for_a_host_that_answers_slowly)
+{
+  uint8_t value = 0x00;
+
+  mock().disable();
+  when_the_bridge_is_initialized(false, &adaptive_read_timeout_configuration);
+  trigger_read_completed(0xC0, 0x0008, &value, sizeof(value));
+  tiny_gea3_erd_client_request_id_t slow_request_id = self.request_id;
+  mock().enable();
+
+  // The first read times out after the initial timeout and the next one waits twice as long
+  should_request_read(0xC0, 0x0002);
+  after(100);
+
+  // A late answer could belong to any attempt the ERD client made, so it is not measured
+  mock().disable();
+  after(80);
+  trigger_read_completed(slow_request_id, 0xC0, 0x0001, &value, sizeof(value));
+  mock().enable();
+
+  should_request_read(0xC0, 0x0004);
+  after(120);
+
+  // Answered within the backed off timeout: 150 ms plus four times a deviation of half that
+  mock().disable();
+  after(150);
+  trigger_read_completed(0xC0, 0x0004, &value, sizeof(value));
+  mock().enable();
+
+  after(449);
+
+  should_request_read(0xC0, 0x0006);
+  after(1);
+}
+
+TEST(mqtt_bridge_polling, should_not_measure_a_read_answered_after_it_timed_out)
+{
+  uint8_t value = 0x00;
+
+  mock().disable();
+  when_the_bridge_is_initialized(false, &adaptive_read_timeout_configuration);
+  trigger_read_completed(0xC0, 0x0008, &value, sizeof(value));
+  tiny_gea3_erd_client_request_id_t late_request_id = self.request_id;
+  after(100);
+  after(5);
+  trigger_read_completed(late_request_id, 0xC0, 0x0001, &value, sizeof(value));
+  mock().enable();
+
+  CHECK_EQUAL(105, self.last_read_latency);
+  CHECK_EQUAL(0, rtt_estimator_smoothed_rtt(&self.read_timeouts, 0xC0));
+}
+
+TEST(mqtt_bridge_polling, should_not_measure_a_read_that_was_sent_again)
+{
+  uint8_t value = 0x00;
+
+  mock().disable();
+  when_the_bridge_is_initialized(false, &adaptive_read_timeout_configuration);
+  after(100);
+  after(5);
+  trigger_read_completed(0xC0, 0x0008, &value, sizeof(value));
+  mock().enable();
+
+  CHECK_EQUAL(5, self.last_read_latency);
+  CHECK_EQUAL(0, rtt_estimator_smoothed_rtt(&self.read_timeouts, 0xFF));
+}
+
+TEST(mqtt_bridge_polling, should_publish_each_read_it_stops_waiting_for)
+{
+  mock().disable();
+  when_the_bridge_is_initialized();
+  mock().enable();
+  abandoned_reads_are_recorded();
+  tiny_gea3_erd_client_request_id_t unanswered_request_id = self.request_id;
+
+  should_request_read(0xFF, 0x0008);
+  after(retry_delay);
+  CHECK_EQUAL(1, abandoned_read_count);
+  CHECK_EQUAL(unanswered_request_id, abandoned_request_id);
+}
+
+TEST(mqtt_bridge_polling, should_not_publish_reads_that_were_answered)
+{
+  uint8_t appliance_type = 0x00;
+
+  mock().disable();
+  when_the_bridge_is_initialized();
+  abandoned_reads_are_recorded();
+  trigger_read_completed(0xC0, 0x0008, &appliance_type, sizeof(appliance_type));
+  mock().enable();
+
+  CHECK_EQUAL(0, abandoned_read_count);
+}
@@ -0,0 +1,174 @@
+/*!
+ * @file
+ * @brief Static RAM budget and lifetime of the storage shared by the MQTT bridges
+ */
+
+extern "C" {
+#include "mqtt_bridge_storage.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/mqtt_client_double.hpp"
+#include "double/tiny_gea3_erd_client_double.hpp"
+#include "double/tiny_timer_group_double.hpp"
+#include "fixed_read_timeout.hpp"
+
+TEST_GROUP(mqtt_bridge_storage)
+{
+  enum {
+    // Memory each bridge may use besides its ERD sets
+    subscription_host_budget = 144,
+    subscription_budget = 192,
+    polling_budget = 576
+  };
+};
+
+TEST(mqtt_bridge_storage, should_only_be_as_large_as_the_larger_bridge)
+{
+  size_t larger = sizeof(mqtt_bridge_t) > sizeof(mqtt_bridge_polling_t) ? sizeof(mqtt_bridge_t) : sizeof(mqtt_bridge_polling_t);
+
+  CHECK_TRUE(sizeof(mqtt_bridge_storage_t) <= larger + alignof(mqtt_bridge_storage_t));
+}
+
+TEST(mqtt_bridge_storage, subscription_bridge_should_stay_within_its_budget)
+{
+  CHECK_TRUE(sizeof(mqtt_bridge_host_t) <= sizeof(erd_bitset_t) + subscription_host_budget);
+  CHECK_TRUE(sizeof(mqtt_bridge_t) <= mqtt_bridge_max_hosts * sizeof(mqtt_bridge_host_t) + subscription_budget);
+}
+
+TEST(mqtt_bridge_storage, polling_bridge_should_stay_within_its_budget)
+{
+  CHECK_TRUE(sizeof(mqtt_bridge_polling_t) <= 2 * sizeof(erd_bitset_t) + polling_budget);
+}
+
+TEST_GROUP(mqtt_bridge_storage_lifetime)
+{
+  enum {
+    resubscribe_delay = 1000,
+    read_timeout = 100,
+    polling_interval = 1000
+  };
+
+  mqtt_bridge_storage_t storage;
+
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  mqtt_client_double_t mqtt_client;
+
+  void setup()
+  {
+    mock().strictOrder();
+
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    mqtt_client_double_init(&mqtt_client);
+    storage.kind = mqtt_bridge_storage_kind_none;
+  }
+
+  void teardown()
+  {
+    mock().disable();
+    if(storage.kind == mqtt_bridge_storage_kind_subscription) {
+      mqtt_bridge_destroy(&storage.subscription);
+    }
+    else if(storage.kind == mqtt_bridge_storage_kind_polling) {
+      mqtt_bridge_polling_destroy(&storage.polling);
+    }
+    mock().enable();
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  void should_request_read(uint8_t address, tiny_erd_t erd)
+  {
+    mock()
+      .expectOneCall("read")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .withParameter("erd", erd)
+      .ignoreOtherParameters()
+      .andReturnValue(true);
+  }
+
+  void given_a_subscription_bridge_that_is_waiting_to_resubscribe()
+  {
+    mock()
+      .expectOneCall("subscribe")
+      .onObject(&erd_client)
+      .withParameter("address", 0xC0)
+      .andReturnValue(false);
+
+    mqtt_bridge_init(
+      &storage.subscription,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      0xC0);
+    storage.kind = mqtt_bridge_storage_kind_subscription;
+    mock().checkExpectations();
+  }
+
+  void when_it_is_replaced_by_a_polling_bridge()
+  {
+    mqtt_bridge_destroy(&storage.subscription);
+    storage.kind = mqtt_bridge_storage_kind_none;
+
+    should_request_read(0xFF, 0x0008);
+    mqtt_bridge_polling_init(
+      &storage.polling,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      polling_interval,
+      false,
+      erd_value_cache_mode_full_copy,
+      &fixed_read_timeout_configuration);
+    storage.kind = mqtt_bridge_storage_kind_polling;
+    mock().checkExpectations();
+  }
+
+  void when_a_publication_is_received_from(uint8_t address)
+  {
+    uint8_t data = 0x42;
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_subscription_publication_received;
+    args.address = address;
+    args.subscription_publication_received.erd = 0x0001;
+    args.subscription_publication_received.data = &data;
+    args.subscription_publication_received.data_size = sizeof(data);
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+};
+
+TEST(mqtt_bridge_storage_lifetime, should_leave_only_the_polling_bridge_running_after_switching_in_place)
+{
+  given_a_subscription_bridge_that_is_waiting_to_resubscribe();
+  when_it_is_replaced_by_a_polling_bridge();
+
+  // The destroyed subscription bridge would publish this and resubscribe on the disconnect
+  when_a_publication_is_received_from(0xC0);
+  mqtt_client_double_trigger_mqtt_disconnect(&mqtt_client);
+
+  // Its resubscribe timer would also have expired by now
+  for(uint8_t i = 0; i < resubscribe_delay / read_timeout; i++) {
+    should_request_read(0xFF, 0x0008);
+    after(read_timeout);
+  }
+}
+
+TEST(mqtt_bridge_storage_lifetime, should_leave_nothing_running_after_the_polling_bridge_is_destroyed)
+{
+  given_a_subscription_bridge_that_is_waiting_to_resubscribe();
+  when_it_is_replaced_by_a_polling_bridge();
+
+  mqtt_bridge_polling_destroy(&storage.polling);
+  storage.kind = mqtt_bridge_storage_kind_none;
+
+  when_a_publication_is_received_from(0xC0);
+  mqtt_client_double_trigger_mqtt_disconnect(&mqtt_client);
+  after(resubscribe_delay);
+}
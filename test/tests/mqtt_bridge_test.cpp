@@ -13,6 +13,20 @@ extern "C" {
 #include "double/tiny_gea3_erd_client_double.hpp"
 #include "double/tiny_timer_group_double.hpp"
 
+// First ERD of a given kind in the generated metadata table
+static tiny_erd_t an_erd_with(bool writable, bool sized)
+{
+  for(uint16_t index = 0; index < KNOWN_ERD_COUNT; index++) {
+    const erdMetadata_t& metadata = erdMetadataTable[index];
+    if((bool(metadata.access & erdAccessWrite) == writable) && ((metadata.size > 0) == sized)) {
+      return erdAtIndex(index);
+    }
+  }
+
+  FAIL("erd_lists.h has no ERD of this kind");
+  return 0;
+}
+
 TEST_GROUP(mqtt_bridge)
 {
   enum {
@@ -108,6 +122,15 @@ TEST_GROUP(mqtt_bridge)
       .andReturnValue(true);
   }
 
+  void a_subscription_retention_should_be_requested_and_refused_for(uint8_t address)
+  {
+    mock()
+      .expectOneCall("retain_subscription")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .andReturnValue(false);
+  }
+
   void should_register_erd(tiny_erd_t erd)
   {
     mock()
@@ -190,6 +213,22 @@ TEST_GROUP(mqtt_bridge)
       .andReturnValue(true);
   }
 
+  template <typename T>
+  void should_request_erd_write_and_be_refused(uint8_t address, tiny_erd_t erd, T value)
+  {
+    static T _value;
+    _value = value;
+
+    mock()
+      .expectOneCall("write")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .withParameter("erd", erd)
+      .withMemoryBufferParameter("data", reinterpret_cast<const uint8_t*>(&_value), sizeof(_value))
+      .ignoreOtherParameters()
+      .andReturnValue(false);
+  }
+
   template <typename T>
   void when_a_write_request_is_received(tiny_erd_t erd, T value)
   {
@@ -321,6 +360,20 @@ TEST(mqtt_bridge, should_periodically_retain_an_active_subscription)
   after(1);
 }
 
+TEST(mqtt_bridge, should_retry_a_subscription_retention_that_cannot_be_queued)
+{
+  given_that_the_bridge_has_been_initialized_and_a_subscription_is_active_for(0xC0);
+
+  a_subscription_retention_should_be_requested_and_refused_for(0xC0);
+  after(subscription_retention_period);
+
+  nothing_should_happen();
+  after(resubscribe_delay - 1);
+
+  a_subscription_retention_should_be_requested_for(0xC0);
+  after(1);
+}
+
 TEST(mqtt_bridge, should_register_and_update_newly_discovered_erds_when_published_by_the_erd_client)
 {
   given_that_the_bridge_has_been_initialized_and_a_subscription_is_active_for(0xC0);
@@ -337,6 +390,51 @@ TEST(mqtt_bridge, should_update_known_erds_when_published_by_the_erd_client)
   when_an_erd_publication_is_received(0xC0, 0xABCD, uint32_t(0x87654321));
 }
 
+TEST(mqtt_bridge, should_register_documented_erds_only_once)
+{
+  given_that_the_bridge_has_been_initialized_and_a_subscription_is_active_for(0xC0);
+  given_that_an_erd_publication_has_been_received(0xC0, 0x0001, uint8_t(0x12));
+  should_update_erd(0x0001, uint8_t(0x34));
+  when_an_erd_publication_is_received(0xC0, 0x0001, uint8_t(0x34));
+}
+
+TEST(mqtt_bridge, should_drop_publications_of_undocumented_erds_once_too_many_have_been_seen)
+{
+  given_that_the_bridge_has_been_initialized_and_a_subscription_is_active_for(0xC0);
+  for(uint8_t i = 0; i < mqtt_bridge_max_unknown_erds; i++) {
+    given_that_an_erd_publication_has_been_received(0xC0, static_cast<tiny_erd_t>(0xA000 + i), uint8_t(0x12));
+  }
+
+  nothing_should_happen();
+  when_an_erd_publication_is_received(0xC0, 0xAFFF, uint8_t(0x34));
+  CHECK_EQUAL(1, self.dropped_publication_count);
+
+  should_update_erd(0xA000, uint8_t(0x34));
+  when_an_erd_publication_is_received(0xC0, 0xA000, uint8_t(0x34));
+}
+
+TEST(mqtt_bridge, should_register_each_undocumented_erd_at_most_once)
+{
+  given_that_the_bridge_has_been_initialized_and_a_subscription_is_active_for(0xC0);
+
+  for(uint8_t round = 0; round < 3; round++) {
+    for(uint8_t i = 0; i <= mqtt_bridge_max_unknown_erds; i++) {
+      tiny_erd_t erd = static_cast<tiny_erd_t>(0xA000 + i);
+
+      if(i < mqtt_bridge_max_unknown_erds) {
+        if(round == 0) {
+          should_register_erd(erd);
+        }
+        should_update_erd(erd, uint8_t(round));
+      }
+      when_an_erd_publication_is_received(0xC0, erd, uint8_t(round));
+    }
+    mock().checkExpectations();
+  }
+
+  CHECK_EQUAL(3, self.dropped_publication_count);
+}
+
 // This makes sure that if we miss the ERD subscription added message that we still handle ERD publications
 // Since the ERD client acknowledges publications even if a subscription isn't known to be active, this is
 // necessary to make sure that we don't miss any ERD publications
@@ -362,6 +460,33 @@ TEST(mqtt_bridge, should_forward_write_requests_from_the_mqtt_client)
   when_a_write_request_is_received(0xABCD, uint32_t(0x12345678));
 }
 
+TEST(mqtt_bridge, should_report_a_write_that_cannot_be_queued_as_failed)
+{
+  given_that_the_bridge_has_been_initialized();
+  should_request_erd_write_and_be_refused(0xC0, 0xABCD, uint32_t(0x12345678));
+  should_update_erd_write_result(0xABCD, false, tiny_gea3_erd_client_write_failure_reason_retries_exhausted);
+  when_a_write_request_is_received(0xABCD, uint32_t(0x12345678));
+}
+
+TEST(mqtt_bridge, should_reject_writes_to_read_only_erds_without_sending_them)
+{
+  tiny_erd_t erd = an_erd_with(false, true);
+
+  given_that_the_bridge_has_been_initialized();
+  should_update_erd_write_result(erd, false, tiny_gea3_erd_client_write_failure_reason_not_supported);
+  when_a_write_request_is_received(erd, uint8_t(0x12));
+}
+
+TEST(mqtt_bridge, should_reject_writes_of_the_wrong_size_without_sending_them)
+{
+  tiny_erd_t erd = an_erd_with(true, true);
+  uint8_t value[255] = {};
+
+  given_that_the_bridge_has_been_initialized();
+  should_update_erd_write_result(erd, false, tiny_gea3_erd_client_write_failure_reason_not_supported);
+  mqtt_client_double_trigger_write_request(&mqtt_client, erd, erdMetadata(erd)->size + 1, value);
+}
+
 TEST(mqtt_bridge, should_report_write_results_to_the_mqtt_client)
 {
   given_that_the_bridge_has_been_initialized();
@@ -599,3 +724,280 @@ TEST(mqtt_bridge_dual, resubscribing_one_bridge_does_not_affect_the_other)
   args.address = address_b;
   tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
 }
+
+// ---------------------------------------------------------------------------
+// Multi-host tests: one bridge instance managing subscriptions for several
+// boards, with each secondary board published in its own MQTT namespace.
+// ---------------------------------------------------------------------------
+
+TEST_GROUP(mqtt_bridge_multi_host)
+{
+  enum {
+    primary_address = 0xC0,
+    secondary_address = 0xC4,
+    tertiary_address = 0xC8,
+    resubscribe_delay = 1000,
+    subscription_retention_period = 30 * 1000
+  };
+
+  mqtt_bridge_t self;
+
+  tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_double_t erd_client;
+  mqtt_client_double_t mqtt_client;
+
+  void setup()
+  {
+    mock().strictOrder();
+
+    tiny_timer_group_double_init(&timer_group);
+    tiny_gea3_erd_client_double_init(&erd_client);
+    mqtt_client_double_init(&mqtt_client);
+  }
+
+  void teardown()
+  {
+    mqtt_bridge_destroy(&self);
+  }
+
+  void given_that_the_bridge_has_been_initialized_with_hosts(uint8_t secondary, uint8_t tertiary = 0)
+  {
+    mock().disable();
+    mqtt_bridge_init(
+      &self,
+      &timer_group.timer_group,
+      &erd_client.interface,
+      &mqtt_client.interface,
+      primary_address);
+    mqtt_bridge_add_host(&self, secondary);
+    if(tertiary) {
+      mqtt_bridge_add_host(&self, tertiary);
+    }
+    mock().enable();
+  }
+
+  i_mqtt_client_t* host_namespace(uint8_t address)
+  {
+    return mqtt_client_double_host(&mqtt_client, address);
+  }
+
+  void a_subscription_should_be_requested_for(uint8_t address, bool queued = true)
+  {
+    mock()
+      .expectOneCall("subscribe")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .andReturnValue(queued);
+  }
+
+  void a_subscription_retention_should_be_requested_for(uint8_t address)
+  {
+    mock()
+      .expectOneCall("retain_subscription")
+      .onObject(&erd_client)
+      .withParameter("address", address)
+      .andReturnValue(true);
+  }
+
+  void after_a_subscription_is_added_or_retained_for(uint8_t address)
+  {
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_subscription_added_or_retained;
+    args.address = address;
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  void given_that_a_subscription_is_active_for(uint8_t address)
+  {
+    mock().disable();
+    after_a_subscription_is_added_or_retained_for(address);
+    mock().enable();
+  }
+
+  void should_register_erd_on(const void* client, tiny_erd_t erd)
+  {
+    mock()
+      .expectOneCall("register_erd")
+      .onObject(client)
+      .withParameter("erd", erd);
+  }
+
+  template <typename T>
+  void should_update_erd_on(const void* client, tiny_erd_t erd, T value)
+  {
+    static T _value;
+    _value = value;
+
+    mock()
+      .expectOneCall("update_erd")
+      .onObject(client)
+      .withParameter("erd", erd)
+      .withMemoryBufferParameter("value", reinterpret_cast<const uint8_t*>(&_value), sizeof(_value));
+  }
+
+  template <typename T>
+  void when_an_erd_publication_is_received(uint8_t publisher_address, tiny_erd_t erd, T data)
+  {
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.type = tiny_gea3_erd_client_activity_type_subscription_publication_received;
+    args.address = publisher_address;
+    args.subscription_publication_received.erd = erd;
+    args.subscription_publication_received.data = &data;
+    args.subscription_publication_received.data_size = sizeof(data);
+    tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+  }
+
+  void after(tiny_timer_ticks_t ticks)
+  {
+    tiny_timer_group_double_elapse_time(&timer_group, ticks);
+  }
+
+  void nothing_should_happen()
+  {
+  }
+};
+
+TEST(mqtt_bridge_multi_host, should_subscribe_to_each_host_as_it_is_added)
+{
+  a_subscription_should_be_requested_for(primary_address);
+  mqtt_bridge_init(
+    &self,
+    &timer_group.timer_group,
+    &erd_client.interface,
+    &mqtt_client.interface,
+    primary_address);
+
+  a_subscription_should_be_requested_for(secondary_address);
+  CHECK_TRUE(mqtt_bridge_add_host(&self, secondary_address));
+}
+
+TEST(mqtt_bridge_multi_host, should_not_add_a_host_twice)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+
+  nothing_should_happen();
+  CHECK_FALSE(mqtt_bridge_add_host(&self, secondary_address));
+  CHECK_FALSE(mqtt_bridge_add_host(&self, primary_address));
+}
+
+TEST(mqtt_bridge_multi_host, should_publish_erds_from_each_host_in_its_own_namespace)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+
+  should_register_erd_on(&mqtt_client, 0x0001);
+  should_update_erd_on(&mqtt_client, 0x0001, uint32_t(0xAAAA0001));
+  when_an_erd_publication_is_received(primary_address, 0x0001, uint32_t(0xAAAA0001));
+
+  should_register_erd_on(host_namespace(secondary_address), 0x0001);
+  should_update_erd_on(host_namespace(secondary_address), 0x0001, uint32_t(0xBBBB0001));
+  when_an_erd_publication_is_received(secondary_address, 0x0001, uint32_t(0xBBBB0001));
+
+  should_update_erd_on(host_namespace(secondary_address), 0x0001, uint32_t(0xBBBB0002));
+  when_an_erd_publication_is_received(secondary_address, 0x0001, uint32_t(0xBBBB0002));
+}
+
+TEST(mqtt_bridge_multi_host, should_ignore_publications_from_hosts_that_have_not_been_added)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+
+  nothing_should_happen();
+  when_an_erd_publication_is_received(tertiary_address, 0x0001, uint32_t(0x12345678));
+}
+
+TEST(mqtt_bridge_multi_host, should_retain_each_host_on_its_own_schedule)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address, tertiary_address);
+  given_that_a_subscription_is_active_for(primary_address);
+  after(10 * 1000);
+  given_that_a_subscription_is_active_for(secondary_address);
+  after(5 * 1000);
+  given_that_a_subscription_is_active_for(tertiary_address);
+
+  nothing_should_happen();
+  after(subscription_retention_period - 15 * 1000 - 1);
+
+  a_subscription_retention_should_be_requested_for(primary_address);
+  after(1);
+
+  nothing_should_happen();
+  after(10 * 1000 - 1);
+
+  a_subscription_retention_should_be_requested_for(secondary_address);
+  after(1);
+
+  a_subscription_retention_should_be_requested_for(tertiary_address);
+  after(5 * 1000);
+
+  a_subscription_retention_should_be_requested_for(primary_address);
+  after(15 * 1000);
+}
+
+TEST(mqtt_bridge_multi_host, should_retry_a_failed_subscription_without_disturbing_other_hosts)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+  given_that_a_subscription_is_active_for(primary_address);
+
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.type = tiny_gea3_erd_client_activity_type_subscribe_failed;
+  args.address = secondary_address;
+
+  a_subscription_should_be_requested_for(secondary_address, false);
+  tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+
+  a_subscription_should_be_requested_for(secondary_address);
+  after(resubscribe_delay);
+
+  nothing_should_happen();
+  after(subscription_retention_period - resubscribe_delay - 1);
+
+  a_subscription_retention_should_be_requested_for(primary_address);
+  after(1);
+}
+
+TEST(mqtt_bridge_multi_host, should_forward_write_requests_from_a_host_namespace_to_that_host)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+
+  uint32_t value = 0x12345678;
+  mock()
+    .expectOneCall("write")
+    .onObject(&erd_client)
+    .withParameter("address", secondary_address)
+    .withParameter("erd", 0xABCD)
+    .withMemoryBufferParameter("data", reinterpret_cast<const uint8_t*>(&value), sizeof(value))
+    .ignoreOtherParameters()
+    .andReturnValue(true);
+  mqtt_client_double_trigger_host_write_request(&mqtt_client, secondary_address, 0xABCD, sizeof(value), &value);
+}
+
+TEST(mqtt_bridge_multi_host, should_report_write_results_in_the_namespace_of_the_host)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+
+  uint32_t value = 0x12345678;
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.type = tiny_gea3_erd_client_activity_type_write_completed;
+  args.address = secondary_address;
+  args.write_completed.erd = 0xABCD;
+  args.write_completed.data = &value;
+  args.write_completed.data_size = sizeof(value);
+
+  mock()
+    .expectOneCall("update_erd_write_result")
+    .onObject(host_namespace(secondary_address))
+    .withParameter("erd", 0xABCD)
+    .withParameter("success", true)
+    .withParameter("failure_reason", 0);
+  tiny_gea3_erd_client_double_trigger_activity_event(&erd_client, &args);
+}
+
+TEST(mqtt_bridge_multi_host, should_resubscribe_every_active_host_after_mqtt_disconnects)
+{
+  given_that_the_bridge_has_been_initialized_with_hosts(secondary_address);
+  given_that_a_subscription_is_active_for(primary_address);
+  given_that_a_subscription_is_active_for(secondary_address);
+
+  a_subscription_should_be_requested_for(primary_address);
+  a_subscription_should_be_requested_for(secondary_address);
+  mqtt_client_double_trigger_mqtt_disconnect(&mqtt_client);
+}
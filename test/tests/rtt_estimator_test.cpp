@@ -0,0 +1,132 @@
+/*!
+ * @file
+ * @brief Tests for estimating per-host response times and read timeouts
+ */
+
+extern "C" {
+#include "rtt_estimator.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+static const rtt_estimator_configuration_t configuration = {
+  .initial_timeout = 100,
+  .minimum_timeout = 20,
+  .maximum_timeout = 500
+};
+
+TEST_GROUP(rtt_estimator)
+{
+  enum {
+    fast_host = 0xC0,
+    slow_host = 0xC1
+  };
+
+  rtt_estimator_t self;
+
+  void setup()
+  {
+    rtt_estimator_init(&self, &configuration);
+  }
+
+  void the_host_answers_in(uint8_t address, tiny_timer_ticks_t rtt, uint8_t times = 1)
+  {
+    for(uint8_t i = 0; i < times; i++) {
+      rtt_estimator_add_sample(&self, address, rtt);
+    }
+  }
+
+  void the_timeout_should_be(uint8_t address, tiny_timer_ticks_t expected)
+  {
+    CHECK_EQUAL(expected, rtt_estimator_timeout(&self, address));
+  }
+};
+
+TEST(rtt_estimator, should_use_the_initial_timeout_for_hosts_that_have_not_answered)
+{
+  the_timeout_should_be(fast_host, 100);
+  CHECK_EQUAL(0, rtt_estimator_smoothed_rtt(&self, fast_host));
+}
+
+TEST(rtt_estimator, should_seed_the_estimate_from_the_first_sample)
+{
+  // 60 ms plus four times a deviation of half that
+  the_host_answers_in(slow_host, 60);
+  CHECK_EQUAL(60, rtt_estimator_smoothed_rtt(&self, slow_host));
+  the_timeout_should_be(slow_host, 180);
+}
+
+TEST(rtt_estimator, should_converge_on_a_steady_round_trip)
+{
+  the_host_answers_in(slow_host, 60);
+  the_host_answers_in(slow_host, 100, 40);
+
+  CHECK_EQUAL(100, rtt_estimator_smoothed_rtt(&self, slow_host));
+  CHECK_TRUE(rtt_estimator_timeout(&self, slow_host) < 105);
+}
+
+TEST(rtt_estimator, should_widen_the_timeout_when_round_trips_vary)
+{
+  the_host_answers_in(slow_host, 100, 40);
+
+  for(uint8_t i = 0; i < 10; i++) {
+    the_host_answers_in(slow_host, 60);
+    the_host_answers_in(slow_host, 140);
+  }
+
+  CHECK_TRUE(rtt_estimator_timeout(&self, slow_host) > 200);
+}
+
+TEST(rtt_estimator, should_clamp_the_timeout_to_the_configured_limits)
+{
+  the_host_answers_in(fast_host, 5, 10);
+  the_timeout_should_be(fast_host, 20);
+
+  the_host_answers_in(slow_host, 400);
+  the_timeout_should_be(slow_host, 500);
+}
+
+TEST(rtt_estimator, should_keep_separate_estimates_per_host)
+{
+  the_host_answers_in(fast_host, 5);
+  the_host_answers_in(slow_host, 180);
+
+  CHECK_EQUAL(5, rtt_estimator_smoothed_rtt(&self, fast_host));
+  CHECK_EQUAL(180, rtt_estimator_smoothed_rtt(&self, slow_host));
+}
+
+TEST(rtt_estimator, should_replace_hosts_in_turn_when_every_slot_is_taken)
+{
+  for(uint8_t i = 0; i < rtt_estimator_max_hosts; i++) {
+    the_host_answers_in(0x10 + i, 50);
+  }
+
+  the_host_answers_in(0x20, 50);
+
+  CHECK_EQUAL(0, rtt_estimator_smoothed_rtt(&self, 0x10));
+  CHECK_EQUAL(50, rtt_estimator_smoothed_rtt(&self, 0x11));
+  CHECK_EQUAL(50, rtt_estimator_smoothed_rtt(&self, 0x20));
+}
+
+TEST(rtt_estimator, should_double_the_timeout_each_time_a_read_times_out)
+{
+  rtt_estimator_back_off(&self, slow_host);
+  the_timeout_should_be(slow_host, 200);
+  CHECK_EQUAL(0, rtt_estimator_smoothed_rtt(&self, slow_host));
+
+  rtt_estimator_back_off(&self, slow_host);
+  the_timeout_should_be(slow_host, 400);
+
+  rtt_estimator_back_off(&self, slow_host);
+  the_timeout_should_be(slow_host, 500);
+}
+
+TEST(rtt_estimator, should_stop_backing_off_once_a_read_is_answered_in_time)
+{
+  the_host_answers_in(fast_host, 5, 10);
+  rtt_estimator_back_off(&self, fast_host);
+  the_timeout_should_be(fast_host, 40);
+
+  the_host_answers_in(fast_host, 5);
+  the_timeout_should_be(fast_host, 20);
+}
@@ -0,0 +1,124 @@
+/*!
+ * @file
+ * @brief Tests for the lock-free single-producer/single-consumer ring
+ */
+
+extern "C" {
+#include "spsc_ring.h"
+}
+
+#include <thread>
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(spsc_ring)
+{
+  enum {
+    size = 16
+  };
+
+  spsc_ring_t self;
+  uint8_t buffer[size];
+
+  void setup()
+  {
+    spsc_ring_init(&self, buffer, sizeof(buffer));
+  }
+};
+
+TEST(spsc_ring, should_read_back_what_was_written)
+{
+  const uint8_t data[] = { 1, 2, 3, 4, 5 };
+  uint8_t read[sizeof(data)];
+
+  CHECK_EQUAL(sizeof(data), spsc_ring_write(&self, data, sizeof(data)));
+  CHECK_EQUAL(sizeof(data), spsc_ring_count(&self));
+
+  CHECK_EQUAL(sizeof(data), spsc_ring_read(&self, read, sizeof(read)));
+  MEMCMP_EQUAL(data, read, sizeof(data));
+  CHECK_EQUAL(0, spsc_ring_count(&self));
+}
+
+TEST(spsc_ring, should_only_accept_what_fits)
+{
+  uint8_t data[size + 4] = { 0 };
+
+  CHECK_EQUAL(size, spsc_ring_write(&self, data, sizeof(data)));
+  CHECK_EQUAL(0, spsc_ring_write(&self, data, 1));
+}
+
+TEST(spsc_ring, should_read_nothing_when_empty)
+{
+  uint8_t data;
+
+  CHECK_EQUAL(0, spsc_ring_read(&self, &data, 1));
+}
+
+TEST(spsc_ring, should_wrap_around_the_end_of_the_buffer)
+{
+  uint8_t data[12];
+  uint8_t read[12];
+
+  for(uint8_t i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  for(uint8_t pass = 0; pass < 5; pass++) {
+    CHECK_EQUAL(sizeof(data), spsc_ring_write(&self, data, sizeof(data)));
+    CHECK_EQUAL(sizeof(read), spsc_ring_read(&self, read, sizeof(read)));
+    MEMCMP_EQUAL(data, read, sizeof(data));
+  }
+}
+
+TEST(spsc_ring, should_deliver_every_byte_in_order_between_threads)
+{
+  enum {
+    total = 200000
+  };
+
+  // The producer writes a running sequence in uneven chunks; the consumer checks it
+  std::thread producer([this] {
+    uint32_t sent = 0;
+    uint8_t chunk[7];
+
+    while(sent < total) {
+      uint16_t count = static_cast<uint16_t>((total - sent < sizeof(chunk)) ? (total - sent) : sizeof(chunk));
+      for(uint16_t i = 0; i < count; i++) {
+        chunk[i] = static_cast<uint8_t>(sent + i);
+      }
+
+      uint16_t written = 0;
+      while(written < count) {
+        uint16_t accepted = spsc_ring_write(&self, &chunk[written], count - written);
+        if(accepted == 0) {
+          std::this_thread::yield();
+        }
+        written += accepted;
+      }
+      sent += count;
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t out_of_order = 0;
+  uint8_t chunk[5];
+
+  while(received < total) {
+    uint16_t count = spsc_ring_read(&self, chunk, sizeof(chunk));
+    if(count == 0) {
+      std::this_thread::yield();
+    }
+    for(uint16_t i = 0; i < count; i++) {
+      if(chunk[i] != static_cast<uint8_t>(received + i)) {
+        out_of_order++;
+      }
+    }
+    received += count;
+  }
+
+  producer.join();
+
+  CHECK_EQUAL(total, received);
+  CHECK_EQUAL(0, out_of_order);
+  CHECK_EQUAL(0, spsc_ring_count(&self));
+}
@@ -0,0 +1,128 @@
+/*!
+ * @file
+ * @brief Tests for measuring elapsed time across tick wraparound
+ */
+
+extern "C" {
+#include "monotonic_time_source.h"
+#include "stopwatch.h"
+}
+
+#include <time.h>
+
+#include "CppUTest/TestHarness.h"
+
+typedef struct {
+  i_wide_time_source_t interface;
+  wide_time_source_ticks_t ticks;
+} fake_time_source_t;
+
+static wide_time_source_ticks_t fake_ticks(i_wide_time_source_t* self)
+{
+  return reinterpret_cast<fake_time_source_t*>(self)->ticks;
+}
+
+static const i_wide_time_source_api_t fake_api = { fake_ticks };
+
+TEST_GROUP(stopwatch)
+{
+  enum {
+    // 32-bit tick counters wrap after about 49.7 days in milliseconds and 71.6 minutes in microseconds
+    one_second_in_milliseconds = 1000,
+    one_second_in_microseconds = 1000000
+  };
+
+  fake_time_source_t time_source;
+  stopwatch_t self;
+
+  void setup()
+  {
+    time_source.interface.api = &fake_api;
+    time_source.ticks = 0;
+  }
+
+  void the_clock_is_at(wide_time_source_ticks_t ticks)
+  {
+    time_source.ticks = ticks;
+  }
+
+  void after(wide_time_source_ticks_t ticks)
+  {
+    time_source.ticks += ticks;
+  }
+};
+
+TEST(stopwatch, should_measure_elapsed_ticks)
+{
+  the_clock_is_at(1234);
+  stopwatch_init(&self, &time_source.interface);
+
+  after(250);
+
+  CHECK_EQUAL(250, stopwatch_elapsed(&self));
+}
+
+TEST(stopwatch, should_measure_across_a_millisecond_wrap)
+{
+  the_clock_is_at(static_cast<wide_time_source_ticks_t>(0) - one_second_in_milliseconds / 2);
+  stopwatch_init(&self, &time_source.interface);
+
+  after(one_second_in_milliseconds);
+
+  CHECK_EQUAL(one_second_in_milliseconds, stopwatch_elapsed(&self));
+}
+
+TEST(stopwatch, should_measure_across_a_microsecond_wrap)
+{
+  the_clock_is_at(static_cast<wide_time_source_ticks_t>(0) - 150);
+  stopwatch_init(&self, &time_source.interface);
+
+  after(400);
+  CHECK_EQUAL(400, stopwatch_elapsed(&self));
+
+  stopwatch_restart(&self);
+  after(one_second_in_microseconds);
+  CHECK_EQUAL(one_second_in_microseconds, stopwatch_elapsed(&self));
+}
+
+TEST(stopwatch, should_compute_ticks_between_two_timestamps_across_a_wrap)
+{
+  wide_time_source_ticks_t before_wrap = static_cast<wide_time_source_ticks_t>(0) - 10;
+
+  CHECK_EQUAL(25, stopwatch_ticks_between(before_wrap, 15));
+}
+
+TEST_GROUP(monotonic_time_source)
+{
+  monotonic_time_source_t milliseconds;
+  monotonic_time_source_t microseconds;
+
+  void setup()
+  {
+    monotonic_time_source_init(&milliseconds, monotonic_time_source_resolution_milliseconds);
+    monotonic_time_source_init(&microseconds, monotonic_time_source_resolution_microseconds);
+  }
+
+  void sleep_for_milliseconds(long duration)
+  {
+    struct timespec request = { 0, duration * 1000000 };
+    nanosleep(&request, NULL);
+  }
+};
+
+TEST(monotonic_time_source, should_tick_at_the_requested_resolution)
+{
+  stopwatch_t millisecond_stopwatch;
+  stopwatch_t microsecond_stopwatch;
+  stopwatch_init(&millisecond_stopwatch, &milliseconds.interface);
+  stopwatch_init(&microsecond_stopwatch, &microseconds.interface);
+
+  sleep_for_milliseconds(5);
+
+  wide_time_source_ticks_t elapsed_ms = stopwatch_elapsed(&millisecond_stopwatch);
+  wide_time_source_ticks_t elapsed_us = stopwatch_elapsed(&microsecond_stopwatch);
+
+  CHECK_TRUE(elapsed_ms >= 4);
+  CHECK_TRUE(elapsed_us >= 5000);
+  CHECK_TRUE(elapsed_us / 1000 + 1 >= elapsed_ms);
+}
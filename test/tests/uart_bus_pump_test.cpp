@@ -0,0 +1,153 @@
+/*!
+ * @file
+ * @brief Tests for moving UART bytes between the bus task and the loop
+ */
+
+extern "C" {
+#include "uart_bus_pump.h"
+}
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  stress_bytes = 100000
+};
+
+// UART driver owned by the bus task thread
+typedef struct {
+  uint32_t next_rx;
+  uint32_t rx_limit;
+  uint32_t next_tx;
+  uint32_t tx_out_of_order;
+} fake_driver_t;
+
+static uint16_t fake_driver_read(void* context, uint8_t* buffer, uint16_t size)
+{
+  auto driver = static_cast<fake_driver_t*>(context);
+  uint16_t count = 0;
+
+  while((count < size) && (driver->next_rx < driver->rx_limit)) {
+    buffer[count++] = static_cast<uint8_t>(driver->next_rx++);
+  }
+
+  return count;
+}
+
+static uint16_t fake_driver_write(void* context, const uint8_t* data, uint16_t size)
+{
+  auto driver = static_cast<fake_driver_t*>(context);
+
+  for(uint16_t i = 0; i < size; i++) {
+    if(data[i] != static_cast<uint8_t>(driver->next_tx++)) {
+      driver->tx_out_of_order++;
+    }
+  }
+
+  return size;
+}
+
+TEST_GROUP(uart_bus_pump)
+{
+  uart_bus_pump_t self;
+  fake_driver_t driver;
+
+  void setup()
+  {
+    memset(&driver, 0, sizeof(driver));
+    uart_bus_pump_init(&self);
+  }
+
+  void the_driver_receives(uint32_t count)
+  {
+    driver.rx_limit += count;
+  }
+
+  void the_bus_task_runs()
+  {
+    uart_bus_pump_run(&self, fake_driver_read, fake_driver_write, &driver);
+  }
+};
+
+TEST(uart_bus_pump, should_make_received_bytes_available_to_the_loop)
+{
+  uint8_t buffer[10];
+
+  the_driver_receives(10);
+  the_bus_task_runs();
+
+  CHECK_EQUAL(10, uart_bus_pump_received_count(&self));
+  CHECK_EQUAL(10, uart_bus_pump_read(&self, buffer, sizeof(buffer)));
+  CHECK_EQUAL(9, buffer[9]);
+}
+
+TEST(uart_bus_pump, should_leave_bytes_in_the_driver_when_the_loop_falls_behind)
+{
+  the_driver_receives(uart_bus_pump_rx_size + 100);
+  the_bus_task_runs();
+
+  CHECK_EQUAL(uart_bus_pump_rx_size, uart_bus_pump_received_count(&self));
+  CHECK_EQUAL(uart_bus_pump_rx_size, driver.next_rx);
+}
+
+TEST(uart_bus_pump, should_write_queued_bytes_to_the_driver)
+{
+  const uint8_t data[] = { 0, 1, 2, 3 };
+
+  CHECK_EQUAL(sizeof(data), uart_bus_pump_write(&self, data, sizeof(data)));
+  the_bus_task_runs();
+
+  CHECK_EQUAL(sizeof(data), driver.next_tx);
+  CHECK_EQUAL(0, driver.tx_out_of_order);
+}
+
+TEST(uart_bus_pump, should_not_lose_or_reorder_bytes_with_a_concurrent_bus_task)
+{
+  std::atomic<bool> done(false);
+  the_driver_receives(stress_bytes);
+
+  std::thread bus_task([this, &done] {
+    while(!done) {
+      the_bus_task_runs();
+      std::this_thread::yield();
+    }
+    the_bus_task_runs();
+  });
+
+  uint32_t received = 0;
+  uint32_t rx_out_of_order = 0;
+  uint32_t sent = 0;
+  uint8_t buffer[48];
+
+  while(received < stress_bytes || sent < stress_bytes) {
+    uint16_t count = uart_bus_pump_read(&self, buffer, sizeof(buffer));
+    for(uint16_t i = 0; i < count; i++) {
+      if(buffer[i] != static_cast<uint8_t>(received + i)) {
+        rx_out_of_order++;
+      }
+    }
+    received += count;
+
+    if(sent < stress_bytes) {
+      uint8_t data[31];
+      uint16_t size = static_cast<uint16_t>((stress_bytes - sent < sizeof(data)) ? (stress_bytes - sent) : sizeof(data));
+      for(uint16_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(sent + i);
+      }
+      sent += uart_bus_pump_write(&self, data, size);
+    }
+
+    std::this_thread::yield();
+  }
+
+  done = true;
+  bus_task.join();
+
+  CHECK_EQUAL(stress_bytes, received);
+  CHECK_EQUAL(0, rx_out_of_order);
+  CHECK_EQUAL(stress_bytes, driver.next_tx);
+  CHECK_EQUAL(0, driver.tx_out_of_order);
+}
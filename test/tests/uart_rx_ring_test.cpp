@@ -0,0 +1,148 @@
+/*!
+ * @file
+ * @brief Tests for the bulk UART receive ring
+ */
+
+extern "C" {
+#include "uart_rx_ring.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  max_bytes = 1024
+};
+
+typedef struct {
+  uint8_t data[max_bytes];
+  uint16_t available;
+  uint16_t offset;
+  uint16_t read_calls;
+} fake_uart_t;
+
+typedef struct {
+  uint8_t data[max_bytes];
+  uint16_t count;
+  uint16_t chunks;
+} received_t;
+
+static uint16_t fake_uart_read(void* context, uint8_t* buffer, uint16_t size)
+{
+  auto uart = static_cast<fake_uart_t*>(context);
+  uint16_t count = (uart->available < size) ? uart->available : size;
+
+  memcpy(buffer, &uart->data[uart->offset], count);
+  uart->offset += count;
+  uart->available -= count;
+  uart->read_calls++;
+
+  return count;
+}
+
+static void on_chunk(void* context, const uint8_t* data, uint16_t size)
+{
+  auto received = static_cast<received_t*>(context);
+  memcpy(&received->data[received->count], data, size);
+  received->count += size;
+  received->chunks++;
+}
+
+TEST_GROUP(uart_rx_ring)
+{
+  uart_rx_ring_t self;
+  fake_uart_t uart;
+  received_t received;
+
+  void setup()
+  {
+    memset(&uart, 0, sizeof(uart));
+    memset(&received, 0, sizeof(received));
+
+    for(uint16_t i = 0; i < max_bytes; i++) {
+      uart.data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    uart_rx_ring_init(&self, fake_uart_read, &uart);
+  }
+
+  void the_uart_receives(uint16_t count)
+  {
+    uart.available += count;
+  }
+
+  void the_ring_dispatches()
+  {
+    uart_rx_ring_dispatch(&self, on_chunk, &received);
+  }
+
+  void the_ring_runs()
+  {
+    uart_rx_ring_run(&self, on_chunk, &received);
+  }
+};
+
+TEST(uart_rx_ring, should_read_everything_available_in_one_call)
+{
+  the_uart_receives(100);
+
+  CHECK_EQUAL(100, uart_rx_ring_fill(&self));
+  CHECK_EQUAL(100, uart_rx_ring_count(&self));
+  CHECK_EQUAL(1, uart.read_calls);
+}
+
+TEST(uart_rx_ring, should_dispatch_buffered_bytes_as_one_chunk)
+{
+  the_uart_receives(100);
+  uart_rx_ring_fill(&self);
+
+  the_ring_dispatches();
+
+  CHECK_EQUAL(100, received.count);
+  CHECK_EQUAL(1, received.chunks);
+  CHECK_EQUAL(0, uart_rx_ring_count(&self));
+  MEMCMP_EQUAL(uart.data, received.data, 100);
+}
+
+TEST(uart_rx_ring, should_stop_filling_when_full)
+{
+  the_uart_receives(uart_rx_ring_size + 10);
+
+  CHECK_EQUAL(uart_rx_ring_size, uart_rx_ring_fill(&self));
+  CHECK_EQUAL(10, uart.available);
+}
+
+TEST(uart_rx_ring, should_split_chunks_where_the_ring_wraps)
+{
+  the_uart_receives(200);
+  uart_rx_ring_fill(&self);
+  the_ring_dispatches();
+
+  received.count = 0;
+  received.chunks = 0;
+  the_uart_receives(100);
+  uart_rx_ring_fill(&self);
+  the_ring_dispatches();
+
+  CHECK_EQUAL(100, received.count);
+  CHECK_EQUAL(2, received.chunks);
+  MEMCMP_EQUAL(&uart.data[200], received.data, 100);
+}
+
+TEST(uart_rx_ring, should_drain_more_than_a_full_ring_when_run)
+{
+  the_uart_receives(3 * uart_rx_ring_size + 5);
+
+  the_ring_runs();
+
+  CHECK_EQUAL(3 * uart_rx_ring_size + 5, received.count);
+  MEMCMP_EQUAL(uart.data, received.data, received.count);
+}
+
+TEST(uart_rx_ring, should_not_dispatch_when_nothing_was_received)
+{
+  the_ring_runs();
+
+  CHECK_EQUAL(0, received.chunks);
+}
@@ -0,0 +1,263 @@
+/*!
+ * @file
+ * @brief Tests for batching UART transmit bytes into bulk writes
+ */
+
+extern "C" {
+#include "uart_tx_batch.h"
+}
+
+#include <cstring>
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  frame_size = 20,
+  max_written = 512
+};
+
+typedef struct {
+  uint8_t written[max_written];
+  uint16_t written_count;
+  uint16_t write_calls;
+  uint16_t room;
+} fake_uart_t;
+
+// Sends a frame one byte per send complete, like the GEA interfaces
+typedef struct {
+  uart_tx_batch_t* batch;
+  uint8_t frame[frame_size];
+  uint8_t offset;
+  bool in_progress;
+} fake_sender_t;
+
+// Takes at most room bytes, like a driver whose transmit buffer is nearly full
+static uint16_t fake_uart_write(void* context, const uint8_t* data, uint16_t size)
+{
+  auto uart = static_cast<fake_uart_t*>(context);
+  uint16_t count = (size < uart->room) ? size : uart->room;
+  memcpy(&uart->written[uart->written_count], data, count);
+  uart->written_count += count;
+  uart->write_calls++;
+  return count;
+}
+
+static void fake_sender_send_next_byte(fake_sender_t* sender)
+{
+  if(sender->offset == frame_size) {
+    sender->in_progress = false;
+    return;
+  }
+  uart_tx_batch_send(sender->batch, sender->frame[sender->offset++]);
+}
+
+static void fake_sender_send_complete(void* context, const void*)
+{
+  fake_sender_send_next_byte(static_cast<fake_sender_t*>(context));
+}
+
+TEST_GROUP(uart_tx_batch)
+{
+  enum {
+    // 230400 baud with 10 bits per byte
+    wire_bytes_per_second = 23040,
+    loop_period_ms = 16
+  };
+
+  uart_tx_batch_t self;
+  tiny_event_t send_complete_event;
+  tiny_event_subscription_t send_complete_subscription;
+  fake_uart_t uart;
+  fake_sender_t sender;
+
+  void setup()
+  {
+    uart.written_count = 0;
+    uart.write_calls = 0;
+    uart.room = max_written;
+
+    sender.batch = &self;
+    sender.offset = frame_size;
+    sender.in_progress = false;
+    for(uint8_t i = 0; i < frame_size; i++) {
+      sender.frame[i] = i;
+    }
+
+    tiny_event_init(&send_complete_event);
+    tiny_event_subscription_init(&send_complete_subscription, &sender, fake_sender_send_complete);
+    tiny_event_subscribe(&send_complete_event.interface, &send_complete_subscription);
+  }
+
+  void given_batching_is(bool batch)
+  {
+    uart_tx_batch_init(&self, fake_uart_write, &uart, batch);
+  }
+
+  void a_frame_is_started()
+  {
+    sender.offset = 0;
+    sender.in_progress = true;
+    fake_sender_send_next_byte(&sender);
+  }
+
+  void the_batch_runs()
+  {
+    uart_tx_batch_run(&self, &send_complete_event);
+  }
+
+  uint32_t loop_iterations_to_send(uint16_t frames)
+  {
+    uint32_t iterations = 0;
+
+    for(uint16_t i = 0; i < frames; i++) {
+      a_frame_is_started();
+      while(sender.in_progress) {
+        the_batch_runs();
+        iterations++;
+      }
+      uart.written_count = 0;
+    }
+
+    return iterations;
+  }
+};
+
+TEST(uart_tx_batch, should_write_a_whole_frame_in_one_run)
+{
+  given_batching_is(true);
+
+  a_frame_is_started();
+  the_batch_runs();
+
+  CHECK_FALSE(sender.in_progress);
+  CHECK_EQUAL(frame_size, uart.written_count);
+  CHECK_EQUAL(1, uart.write_calls);
+  MEMCMP_EQUAL(sender.frame, uart.written, frame_size);
+}
+
+TEST(uart_tx_batch, should_not_write_anything_until_it_runs)
+{
+  given_batching_is(true);
+
+  a_frame_is_started();
+
+  CHECK_EQUAL(0, uart.written_count);
+}
+
+TEST(uart_tx_batch, should_split_frames_larger_than_the_buffer)
+{
+  given_batching_is(true);
+  uint8_t large_frame[uart_tx_batch_buffer_size * 2 + 10];
+
+  for(uint16_t i = 0; i < sizeof(large_frame); i++) {
+    large_frame[i] = static_cast<uint8_t>(i);
+    uart_tx_batch_send(&self, large_frame[i]);
+  }
+  the_batch_runs();
+
+  CHECK_EQUAL(sizeof(large_frame), uart.written_count);
+  CHECK_EQUAL(3, uart.write_calls);
+  MEMCMP_EQUAL(large_frame, uart.written, sizeof(large_frame));
+}
+
+TEST(uart_tx_batch, should_write_and_complete_one_byte_at_a_time_when_not_batching)
+{
+  given_batching_is(false);
+
+  a_frame_is_started();
+  CHECK_EQUAL(1, uart.written_count);
+
+  the_batch_runs();
+  CHECK_EQUAL(2, uart.written_count);
+  CHECK_TRUE(sender.in_progress);
+}
+
+TEST(uart_tx_batch, should_keep_what_the_driver_does_not_take_for_the_next_run)
+{
+  given_batching_is(true);
+  uart.room = 8;
+
+  a_frame_is_started();
+  the_batch_runs();
+  CHECK_EQUAL(8, uart.written_count);
+  CHECK_TRUE(uart_tx_batch_has_unwritten_bytes(&self));
+
+  uart.room = max_written;
+  the_batch_runs();
+  CHECK_EQUAL(frame_size, uart.written_count);
+  CHECK_FALSE(uart_tx_batch_has_unwritten_bytes(&self));
+  MEMCMP_EQUAL(sender.frame, uart.written, frame_size);
+}
+
+TEST(uart_tx_batch, should_hold_back_send_complete_while_the_buffer_is_full)
+{
+  given_batching_is(true);
+  uart.room = 0;
+  uint8_t large_frame[uart_tx_batch_buffer_size - 1];
+
+  for(uint16_t i = 0; i < sizeof(large_frame); i++) {
+    large_frame[i] = static_cast<uint8_t>(i);
+    uart_tx_batch_send(&self, large_frame[i]);
+  }
+  a_frame_is_started();
+  the_batch_runs();
+  CHECK_EQUAL(1, sender.offset);
+
+  uart.room = max_written;
+  the_batch_runs();
+  CHECK_FALSE(sender.in_progress);
+  CHECK_EQUAL(sizeof(large_frame) + frame_size, uart.written_count);
+  MEMCMP_EQUAL(large_frame, uart.written, sizeof(large_frame));
+  MEMCMP_EQUAL(sender.frame, &uart.written[sizeof(large_frame)], frame_size);
+}
+
+TEST(uart_tx_batch, should_not_complete_a_byte_the_driver_did_not_take_when_not_batching)
+{
+  given_batching_is(false);
+  uart.room = 0;
+
+  a_frame_is_started();
+  the_batch_runs();
+  CHECK_EQUAL(1, sender.offset);
+
+  uart.room = max_written;
+  the_batch_runs();
+  CHECK_EQUAL(2, uart.written_count);
+  CHECK_EQUAL(2, sender.offset);
+}
+
+TEST(uart_tx_batch, should_do_nothing_when_nothing_was_sent)
+{
+  given_batching_is(true);
+
+  the_batch_runs();
+
+  CHECK_EQUAL(0, uart.write_calls);
+}
+
+TEST(uart_tx_batch, should_send_frames_at_the_wire_rate_instead_of_the_loop_rate)
+{
+  enum { frames = 100 };
+
+  given_batching_is(false);
+  uint32_t byte_at_a_time_iterations = loop_iterations_to_send(frames);
+
+  given_batching_is(true);
+  uint32_t batched_iterations = loop_iterations_to_send(frames);
+
+  // Each frame waits for at most one loop iteration before it is on the wire
+  uint32_t wire_time_us = static_cast<uint32_t>(frames) * frame_size * 1000000UL / wire_bytes_per_second;
+  uint32_t byte_at_a_time_us = byte_at_a_time_iterations * loop_period_ms * 1000UL + wire_time_us;
+  uint32_t batched_us = batched_iterations * loop_period_ms * 1000UL + wire_time_us;
+
+  SimpleString report = StringFromFormat(
+    "%u-byte frames with a %u ms loop: byte at a time %lu frames/s, batched %lu frames/s",
+    frame_size,
+    loop_period_ms,
+    static_cast<unsigned long>(frames * 1000000UL / byte_at_a_time_us),
+    static_cast<unsigned long>(frames * 1000000UL / batched_us));
+  UT_PRINT(report.asCharString());
+
+  CHECK_EQUAL(frames, batched_iterations);
+  CHECK_EQUAL(frames * frame_size, byte_at_a_time_iterations);
+}